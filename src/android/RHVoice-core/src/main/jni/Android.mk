@@ -29,6 +29,7 @@ LOCAL_SRC_FILES += $(patsubst $(LOCAL_PATH)/%, %, $(wildcard $(LOCAL_PATH)/$(MY_
 LOCAL_CFLAGS := $(MY_CORE_DEFINES) $(MY_COMMON_DEFINES)
 LOCAL_EXPORT_C_INCLUDES := $(LOCAL_C_INCLUDES)
 LOCAL_STATIC_LIBRARIES := curl_static
+LOCAL_EXPORT_LDLIBS := -lz
 include $(BUILD_STATIC_LIBRARY)
 
 include $(CLEAR_VARS)
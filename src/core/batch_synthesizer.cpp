@@ -0,0 +1,307 @@
+/* Copyright (C) 2026  RHVoice contributors */
+
+/* This program is free software: you can redistribute it and/or modify */
+/* it under the terms of the GNU Lesser General Public License as published by */
+/* the Free Software Foundation, either version 2.1 of the License, or */
+/* (at your option) any later version. */
+
+/* This program is distributed in the hope that it will be useful, */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+/* GNU Lesser General Public License for more details. */
+
+/* You should have received a copy of the GNU Lesser General Public License */
+/* along with this program.  If not, see <https://www.gnu.org/licenses/>. */
+
+#include <thread>
+#include <stdexcept>
+#include "core/voice.hpp"
+#include "core/batch_synthesizer.hpp"
+
+namespace RHVoice
+{
+  void speech_recorder::add(record_type type,std::size_t start,std::size_t count,const std::string& name)
+  {
+    record r;
+    r.type=type;
+    r.start=start;
+    r.count=count;
+    r.name=name;
+    records.push_back(r);
+  }
+
+  bool speech_recorder::play_speech(const short* samples_,std::size_t count)
+  {
+    std::size_t start=samples.size();
+    samples.insert(samples.end(),samples_,samples_+count);
+    add(record_speech,start,count);
+    return true;
+  }
+
+  bool speech_recorder::skip_speech(std::size_t count)
+  {
+    add(record_skip,0,count);
+    return true;
+  }
+
+  bool speech_recorder::process_mark(const std::string& name)
+  {
+    add(record_mark,0,0,name);
+    return true;
+  }
+
+  bool speech_recorder::play_audio(const std::string& src)
+  {
+    add(record_audio,0,0,src);
+    return true;
+  }
+
+  bool speech_recorder::set_sample_rate(int sample_rate)
+  {
+    // All the speech in one recording comes from the same voice
+    recorded_sample_rate=sample_rate;
+    return true;
+  }
+
+  bool speech_recorder::sentence_starts(std::size_t position,std::size_t length)
+  {
+    add(record_sentence_starts,position,length);
+    return true;
+  }
+
+  bool speech_recorder::sentence_ends(std::size_t position,std::size_t length)
+  {
+    add(record_sentence_ends,position,length);
+    return true;
+  }
+
+  bool speech_recorder::word_starts(std::size_t position,std::size_t length)
+  {
+    add(record_word_starts,position,length);
+    return true;
+  }
+
+  bool speech_recorder::word_ends(std::size_t position,std::size_t length)
+  {
+    add(record_word_ends,position,length);
+    return true;
+  }
+
+  bool speech_recorder::phone_starts(const std::string& name)
+  {
+    add(record_phone_starts,0,0,name);
+    return true;
+  }
+
+  bool speech_recorder::replay(client& c) const
+  {
+    if((recorded_sample_rate!=0)&&!c.configure(recorded_sample_rate))
+      return false;
+    for(std::vector<record>::const_iterator it=records.begin();it!=records.end();++it)
+      {
+        bool should_continue=true;
+        switch(it->type)
+          {
+          case record_speech:
+            should_continue=c.play_speech(&samples[it->start],it->count);
+            break;
+          case record_skip:
+            should_continue=c.skip_speech(it->count);
+            break;
+          case record_mark:
+            should_continue=c.process_mark(it->name);
+            break;
+          case record_audio:
+            should_continue=c.play_audio(it->name);
+            break;
+          case record_sentence_starts:
+            should_continue=c.sentence_starts(it->start,it->count);
+            break;
+          case record_sentence_ends:
+            should_continue=c.sentence_ends(it->start,it->count);
+            break;
+          case record_word_starts:
+            should_continue=c.word_starts(it->start,it->count);
+            break;
+          case record_word_ends:
+            should_continue=c.word_ends(it->start,it->count);
+            break;
+          case record_phone_starts:
+            should_continue=c.phone_starts(it->name);
+            break;
+          }
+        if(!should_continue)
+          return false;
+      }
+    return true;
+  }
+
+  batch_synthesizer::batch_synthesizer(unsigned int num_threads_):
+    num_threads(num_threads_),
+    next_task(0),
+    next_delivery(0),
+    window(0),
+    aborted(false)
+  {
+    if(num_threads==0)
+      num_threads=std::thread::hardware_concurrency();
+    if(num_threads==0)
+      num_threads=1;
+  }
+
+  void batch_synthesizer::add(document& doc)
+  {
+    if(!doc.has_owner())
+      throw std::invalid_argument("The document has no owner");
+    if(doc.is_incremental())
+      throw std::invalid_argument("Incremental documents cannot be synthesized in a batch");
+    documents.push_back(&doc);
+  }
+
+  void batch_synthesizer::prepare_tasks()
+  {
+    tasks.clear();
+    stopped_documents.assign(documents.size(),false);
+    for(std::size_t i=0;i<documents.size();++i)
+      {
+        document& doc=*documents[i];
+        std::size_t first_task=tasks.size();
+        sentence_position pos=sentence_position_initial;
+        for(document::iterator it=doc.begin();it!=doc.end();++it)
+          {
+            task t;
+            t.doc_index=i;
+            t.sentence_iter=it;
+            t.last_in_document=false;
+            t.ready=false;
+            if(it->has_text())
+              {
+                document::iterator next_it=it;
+                ++next_it;
+                if(next_it==doc.end())
+                  pos=(pos==sentence_position_initial)?sentence_position_single:sentence_position_final;
+                t.pos=pos;
+                pos=sentence_position_middle;
+              }
+            else
+              t.pos=pos;
+            tasks.push_back(std::move(t));
+          }
+        if(tasks.size()>first_task)
+          tasks.back().last_in_document=true;
+        else if(doc.get_owner().get_supported_events()&event_done)
+          doc.get_owner().done();
+      }
+  }
+
+  void batch_synthesizer::work()
+  {
+    std::unique_lock<std::mutex> task_lock(task_mutex);
+    while(true)
+      {
+        // Don't run too far ahead of the delivery, the recordings take memory
+        delivery_done.wait(task_lock,[this]{return (aborted||(next_task>=tasks.size())||(next_task<next_delivery+window));});
+        if(aborted||(next_task>=tasks.size()))
+          return;
+        task& t=tasks[next_task];
+        ++next_task;
+        bool skip=(stopped_documents[t.doc_index]||documents[t.doc_index]->is_cancelled());
+        task_lock.unlock();
+        if(!skip&&t.sentence_iter->has_text())
+          {
+            try
+              {
+                document& doc=*documents[t.doc_index];
+                t.recorder.reset(new speech_recorder(doc.get_owner()));
+                engine::utterance_scope scope(doc.get_engine());
+                std::unique_ptr<utterance> u=t.sentence_iter->create_utterance(t.pos);
+                if((u.get()!=0)&&(u->has_voice()))
+                  u->get_voice().synthesize(*u,*t.recorder);
+              }
+            catch(...)
+              {
+                t.error=std::current_exception();
+              }
+          }
+        task_lock.lock();
+        t.ready=true;
+        task_done.notify_all();
+      }
+  }
+
+  void batch_synthesizer::deliver(task& t)
+  {
+    if(stopped_documents[t.doc_index])
+      return;
+    document& doc=*documents[t.doc_index];
+    if(doc.is_cancelled())
+      {
+        std::lock_guard<std::mutex> task_lock(task_mutex);
+        stopped_documents[t.doc_index]=true;
+        return;
+      }
+    bool should_continue=true;
+    if(!(t.sentence_iter->has_text()))
+      should_continue=t.sentence_iter->notify_client();
+    else if(t.recorder)
+      should_continue=t.recorder->replay(doc.get_owner());
+    if(!should_continue)
+      {
+        std::lock_guard<std::mutex> task_lock(task_mutex);
+        stopped_documents[t.doc_index]=true;
+        return;
+      }
+    if(t.last_in_document&&(doc.get_owner().get_supported_events()&event_done))
+      doc.get_owner().done();
+  }
+
+  void batch_synthesizer::run()
+  {
+    prepare_tasks();
+    next_task=0;
+    next_delivery=0;
+    window=4*num_threads;
+    aborted=false;
+    std::vector<std::thread> workers;
+    for(unsigned int i=0;i<num_threads;++i)
+      workers.emplace_back(&batch_synthesizer::work,this);
+    std::exception_ptr error;
+    for(std::size_t i=0;i<tasks.size();++i)
+      {
+        task& t=tasks[i];
+        {
+          std::unique_lock<std::mutex> task_lock(task_mutex);
+          task_done.wait(task_lock,[&t]{return t.ready;});
+        }
+        if(t.error)
+          error=t.error;
+        else
+          {
+            try
+              {
+                deliver(t);
+              }
+            catch(...)
+              {
+                error=std::current_exception();
+              }
+          }
+        t.recorder.reset();
+        {
+          std::lock_guard<std::mutex> task_lock(task_mutex);
+          if(error)
+            aborted=true;
+          ++next_delivery;
+        }
+        delivery_done.notify_all();
+        if(error)
+          break;
+      }
+    for(std::vector<std::thread>::iterator it=workers.begin();it!=workers.end();++it)
+      it->join();
+    tasks.clear();
+    documents.clear();
+    if(error)
+      std::rethrow_exception(error);
+  }
+}
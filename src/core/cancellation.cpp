@@ -0,0 +1,23 @@
+/* Copyright (C) 2026  RHVoice contributors */
+
+/* This program is free software: you can redistribute it and/or modify */
+/* it under the terms of the GNU Lesser General Public License as published by */
+/* the Free Software Foundation, either version 2.1 of the License, or */
+/* (at your option) any later version. */
+
+/* This program is distributed in the hope that it will be useful, */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+/* GNU Lesser General Public License for more details. */
+
+/* You should have received a copy of the GNU Lesser General Public License */
+/* along with this program.  If not, see <https://www.gnu.org/licenses/>. */
+
+#include "core/cancellation.hpp"
+
+int RHVoice_cancellation_requested(RHVoice_cancellation_token_t token)
+{
+  if(!token.impl)
+    return 0;
+  return static_cast<const RHVoice::cancellation_token*>(token.impl)->is_cancelled();
+}
@@ -25,13 +25,83 @@ namespace
 
 namespace RHVoice
 {
+  namespace
+  {
+    thread_local const setting_values* active_values=0;
+
+    // The latest snapshot of the configuration the thread has read
+    // last
+    struct latest_values
+    {
+      const shared_setting_values* source{0};
+      std::uint64_t version{0};
+      std::shared_ptr<const setting_values> values;
+    };
+
+    thread_local latest_values latest;
+
+    std::atomic<std::uint64_t> last_version{0};
+  }
+
+  const setting_values* setting_values::get_active()
+  {
+    return active_values;
+  }
+
+  const setting_values* setting_values::get_latest(const shared_setting_values& s,std::shared_ptr<const setting_values>& hold)
+  {
+    // The snapshot is stored before its version, so the one loaded
+    // here is at least as new as the version
+    const std::uint64_t version=s.version.load(std::memory_order_acquire);
+    if((latest.source!=&s)||(latest.version!=version))
+      {
+        hold=std::move(latest.values);
+        latest.values=std::atomic_load(&s.current);
+        latest.source=&s;
+        latest.version=version;
+      }
+    return latest.values.get();
+  }
+
+  setting_values::scope::scope(const std::shared_ptr<const setting_values>& v):
+    values(v),
+    previous(active_values)
+  {
+    active_values=values.get();
+  }
+
+  setting_values::scope::~scope()
+  {
+    active_values=previous;
+  }
+
+  std::shared_ptr<setting_values> config::copy_values() const
+  {
+    return std::make_shared<setting_values>(*get_values());
+  }
+
+  void config::store_values(const std::shared_ptr<const setting_values>& new_values)
+  {
+    std::atomic_store(&values.current,new_values);
+    values.version.store(++last_version,std::memory_order_release);
+  }
+
   bool config::set(const std::string& name,const std::string& value)
   {
     registration_map::iterator it=registered_settings.find(name);
                 if(it==registered_settings.end())
                   return false;
-                else
+                if(!shared)
                   return it->second->set_from_string(value);
+                std::shared_ptr<const void> v=it->second->parse(value);
+                if(!v)
+                  return false;
+                std::lock_guard<std::mutex> lock(update_mutex);
+                std::shared_ptr<setting_values> new_values=copy_values();
+                new_values->set(it->second->slot,v);
+                overrides[it->second->slot]=v;
+                store_values(new_values);
+                return true;
   }
 
   bool config::reset(const std::string& name)
@@ -39,22 +109,38 @@ namespace RHVoice
     registration_map::iterator it=registered_settings.find(name);
                 if(it==registered_settings.end())
                   return false;
-                else
+                else if(!shared)
                   {
                     it->second->reset();
                     return true;
                   }
+                else
+                  {
+                    std::lock_guard<std::mutex> lock(update_mutex);
+                    std::shared_ptr<setting_values> new_values=copy_values();
+                    new_values->set(it->second->slot,std::shared_ptr<const void>());
+                    overrides[it->second->slot]=std::shared_ptr<const void>();
+                    store_values(new_values);
+                    return true;
+                  }
   }
 
   void config::reset()
   {
+    if(shared)
+      {
+        std::lock_guard<std::mutex> lock(update_mutex);
+        overrides.clear();
+        store_values(std::make_shared<setting_values>(&values));
+        return;
+      }
     for(registration_map::iterator it=registered_settings.begin();it!=registered_settings.end();++it)
       {
         it->second->reset();
       }
   }
 
-  void config::load(const std::string& file_path)
+  void config::read_file(const std::string& file_path,const std::function<void(const std::string&,const std::string&)>& callback) const
   {
     try
       {
@@ -64,7 +150,7 @@ namespace RHVoice
             if(p.get_section().empty())
               {
                 logger->log(tag,RHVoice_log_level_trace,p.get_key()+"="+p.get_value());
-                set(p.get_key(),p.get_value());
+                callback(p.get_key(),p.get_value());
               }
           }
         logger->log(tag,RHVoice_log_level_info,"configuration file processed");
@@ -79,4 +165,39 @@ namespace RHVoice
         throw;
       }
   }
+
+  void config::load(const std::string& file_path)
+  {
+    if(shared)
+      {
+        publish(read(file_path));
+        return;
+      }
+    read_file(file_path,[this](const std::string& key,const std::string& value){set(key,value);});
+  }
+
+  std::shared_ptr<setting_values> config::read(const std::string& file_path) const
+  {
+    std::shared_ptr<setting_values> result=std::make_shared<setting_values>(&values);
+    read_file(file_path,[this,&result](const std::string& key,const std::string& value)
+              {
+                registration_map::const_iterator it=registered_settings.find(key);
+                if(it==registered_settings.end())
+                  return;
+                std::shared_ptr<const void> v=it->second->parse(value);
+                if(v)
+                  result->set(it->second->slot,v);
+              });
+    return result;
+  }
+
+  void config::publish(const std::shared_ptr<setting_values>& new_values)
+  {
+    std::lock_guard<std::mutex> lock(update_mutex);
+    for(std::map<std::size_t,std::shared_ptr<const void> >::const_iterator it=overrides.begin();it!=overrides.end();++it)
+      {
+        new_values->set(it->first,it->second);
+      }
+    store_values(new_values);
+  }
 }
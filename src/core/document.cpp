@@ -28,6 +28,13 @@ namespace RHVoice
     u.get_relation("Event",true).append(token);
   }
 
+  void sentence::append_token::print(std::ostream& out) const
+  {
+    out << get_type() << " " << name << " [" << whitespace << "] " << position << " " << length;
+    if(eos)
+      out << " eos";
+  }
+
   void sentence::append_chars::execute(utterance& u) const
   {
     u.get_language().on_token_break(u);
@@ -213,7 +220,7 @@ namespace RHVoice
     result.second=voices.end();
     if(!markup_info.language_criteria.empty())
       {
-        language_list::const_iterator requested_language=std::find_if(languages.begin(),languages.end(),markup_info.language_criteria);
+        language_list::const_iterator requested_language=languages.find(markup_info.language_criteria);
         if(requested_language!=languages.end())
           result.first=requested_language;
       }
@@ -222,7 +229,7 @@ namespace RHVoice
         voice_search_criteria voice_criteria=markup_info.voice_criteria;
         if(result.first!=languages.end())
           voice_criteria.set_language(*(result.first));
-        voice_list::const_iterator requested_voice=std::find_if(voices.begin(),voices.end(),voice_criteria);
+        voice_list::const_iterator requested_voice=voices.find(voice_criteria);
         if(requested_voice!=voices.end())
           {
             result.first=requested_voice->get_language();
@@ -303,18 +310,27 @@ namespace RHVoice
 
   void sentence::apply_language_processing(utterance& u) const
   {
+    typedef void (language::*pass_t)(utterance&) const;
+    static const pass_t passes[]={
+      &language::do_text_analysis,
+      &language::do_pos_tagging,
+      &language::phrasify,
+      &language::detect_utt_type,
+      &language::do_g2p,
+      &language::syllabify,
+      &language::insert_pauses,
+      &language::do_post_lexical_processing,
+      &language::do_syl_accents,
+      &language::set_pitch_modifications,
+      &language::set_duration_modifications,
+      &language::precompute_positional_features};
     const language& language_ref=u.get_language();
-    language_ref.do_text_analysis(u);
-    language_ref.do_pos_tagging(u);
-    language_ref.phrasify(u);
-    language_ref.detect_utt_type(u);
-    language_ref.do_g2p(u);
-    language_ref.syllabify(u);
-    language_ref.insert_pauses(u);
-    language_ref.do_post_lexical_processing(u);
-    language_ref.do_syl_accents(u);
-    language_ref.set_pitch_modifications(u);
-    language_ref.set_duration_modifications(u);
+    for(std::size_t i=0;i<sizeof(passes)/sizeof(passes[0]);++i)
+      {
+        if(u.is_cancelled())
+          return;
+        (language_ref.*passes[i])(u);
+      }
   }
 
   void sentence::apply_verbosity_settings(utterance& u) const
@@ -383,6 +399,7 @@ namespace RHVoice
   std::unique_ptr<utterance> sentence::create_utterance(sentence_position pos) const
   {
     std::unique_ptr<utterance> u=new_utterance();
+    u->set_cancellation_token(&parent->get_cancellation_token());
     u->set_bilingual_enabled(parent->enable_bilingual);
     apply_speech_settings(*u);
     execute_commands(*u);
@@ -406,6 +423,15 @@ namespace RHVoice
     return false;
   }
 
+  void sentence::print(std::ostream& out) const
+  {
+    for(std::list<command_ptr>::const_iterator it(commands.begin());it!=commands.end();++it)
+      {
+        (*it)->print(out);
+        out << std::endl;
+      }
+  }
+
   bool sentence::notify_client()
   {
     for(std::list<command_ptr>::const_iterator it(commands.begin());it!=commands.end();++it)
@@ -416,14 +442,141 @@ namespace RHVoice
     return true;
   }
 
+  std::unique_ptr<document> document::create_incremental(const std::shared_ptr<engine>& engine_ptr,content_type say_as,const voice_profile& profile)
+  {
+    if((say_as!=content_text)&&(say_as!=content_chars))
+      throw std::invalid_argument("Incremental input is only supported for plain text and characters");
+    std::unique_ptr<document> doc_ptr(new document(engine_ptr,profile));
+    doc_ptr->incremental=true;
+    doc_ptr->input_type=say_as;
+    return doc_ptr;
+  }
+
+  std::string::size_type document::get_complete_input_size() const
+  {
+    // Whitespace ends a token in both modes, so the text up to the
+    // last whitespace is parsed exactly as it would be as a part of
+    // the whole input. A token is never split, however long it grows.
+    std::string::size_type pos=input_buffer.find_last_of(" \t\n\v\f\r");
+    return ((pos==std::string::npos)?0:(pos+1));
+  }
+
+  void document::parse_input(std::string::size_type size)
+  {
+    if(size==0)
+      return;
+    typedef utf::text_iterator<std::string::const_iterator> char_iterator;
+    std::string::const_iterator start=input_buffer.begin();
+    std::string::const_iterator end=start+size;
+    tts_markup m;
+    m.say_as=input_type;
+    add_text(char_iterator(start,start,end),char_iterator(end,start,end),m);
+    input_offset+=size;
+    input_buffer.erase(0,size);
+  }
+
+  void document::append_text(const char* text,std::size_t size)
+  {
+    std::lock_guard<std::mutex> input_lock(input_mutex);
+    if(!incremental||input_finished)
+      throw std::logic_error("The document does not accept more text");
+    input_buffer.append(text,size);
+    std::size_t old_count=sentences.size();
+    parse_input(get_complete_input_size());
+    if(sentences.size()!=old_count)
+      input_available.notify_one();
+  }
+
+  void document::finish_input()
+  {
+    std::lock_guard<std::mutex> input_lock(input_mutex);
+    if(!incremental||input_finished)
+      return;
+    try
+      {
+        parse_input(input_buffer.size());
+      }
+    catch(...)
+      {
+        finish_sentence();
+        input_finished=true;
+        input_available.notify_one();
+        throw;
+      }
+    finish_sentence();
+    input_finished=true;
+    input_available.notify_one();
+  }
+
+  void document::cancel()
+  {
+    cancellation.cancel();
+    // Wakes up an incremental synthesis waiting for more text
+    std::lock_guard<std::mutex> input_lock(input_mutex);
+    input_available.notify_one();
+  }
+
+  bool document::synthesize_sentence(sentence& s,sentence_position pos)
+  {
+    engine::utterance_scope scope(get_engine());
+    std::unique_ptr<utterance> u=s.create_utterance(pos);
+    if(is_cancelled())
+      return false;
+    if((u.get()!=0)&&(u->has_voice()))
+      return u->get_voice().synthesize(*u,get_owner());
+    return true;
+  }
+
+  void document::synthesize_incrementally()
+  {
+    sentence_position pos=sentence_position_initial;
+    std::unique_lock<std::mutex> input_lock(input_mutex);
+    while(true)
+      {
+        // Only the sentences preceding the current one are complete
+        input_available.wait(input_lock,[this]{return (input_finished||is_cancelled()||(sentences.begin()!=current_sentence));});
+        if(is_cancelled())
+          return;
+        if(sentences.empty())
+          break;
+        iterator it=sentences.begin();
+        bool is_last=(input_finished&&(std::next(it)==sentences.end()));
+        input_lock.unlock();
+        if(!(it->has_text()))
+          {
+            if(!(it->notify_client()))
+              return;
+          }
+        else
+          {
+            if(is_last)
+              pos=(pos==sentence_position_initial)?sentence_position_single:sentence_position_final;
+            if(!synthesize_sentence(*it,pos))
+              return;
+            pos=sentence_position_middle;
+          }
+        input_lock.lock();
+        sentences.erase(it);
+      }
+    input_lock.unlock();
+    if(owner->get_supported_events()&event_done)
+      owner->done();
+  }
+
   void document::synthesize()
   {
     if(!has_owner())
       return;
-    std::unique_ptr<utterance> u;
+    if(incremental)
+      {
+        synthesize_incrementally();
+        return;
+      }
     sentence_position pos=sentence_position_initial;
     for(iterator it(begin());it!=end();++it)
       {
+        if(is_cancelled())
+          return;
         if(!(it->has_text()))
           {
             if(it->notify_client())
@@ -440,10 +593,8 @@ namespace RHVoice
             else
               pos=sentence_position_final;
           }
-        u=it->create_utterance(pos);
-        if((u.get()!=0)&&(u->has_voice()))
-          if(!(u->get_voice().synthesize(*u,get_owner())))
-            return;
+        if(!synthesize_sentence(*it,pos))
+          return;
         pos=sentence_position_middle;
       }
     if(owner->get_supported_events()&event_done)
@@ -69,9 +69,11 @@ namespace RHVoice
     data_path(p.data_path),
     config_path(p.config_path),
     version(VERSION),
+    engine_pools(new hts_engine_pool_manager(&engine_pool_settings)),
     languages(p.get_language_paths(),path::join(config_path,"dicts"),*p.logger),
     voices(p.get_voice_paths(),languages,*p.logger),
     logger(p.logger),
+    cfg(true),
     prefer_primary_language("prefer_primary_language",true),
     enable_bilingual("enable_bilingual", true)
   {
@@ -87,6 +89,7 @@ namespace RHVoice
     cfg.register_setting(enable_bilingual);
     cfg.register_setting(quality);
     stream_settings.register_self(cfg);
+    engine_pool_settings.register_self(cfg);
     languages.register_settings(cfg);
     voices.register_settings(cfg);
     for(language_list::iterator it(languages.begin());it!=languages.end();++it)
@@ -95,12 +98,11 @@ namespace RHVoice
         it->text_settings.default_to(text_settings);
       }
     for(auto& v: voices)
-      v.set_stream_settings(stream_settings);
-    #ifdef WIN32
-    cfg.load(path::join(config_path,"RHVoice.ini"));
-    #else
-    cfg.load(path::join(config_path,"RHVoice.conf"));
-    #endif
+      {
+        v.set_stream_settings(stream_settings);
+        v.set_engine_pool_manager(engine_pools);
+      }
+    cfg.load(get_config_file_path());
     if(p.has_data_paths() && languages.empty())
       throw no_languages();
     create_voice_profiles();
@@ -114,6 +116,44 @@ namespace RHVoice
     logger->log(tag,RHVoice_log_level_info,"engine created");
   }
 
+  std::string engine::get_config_file_path() const
+  {
+    #ifdef WIN32
+    return path::join(config_path,"RHVoice.ini");
+    #else
+    return path::join(config_path,"RHVoice.conf");
+    #endif
+  }
+
+  void engine::reload()
+  {
+    std::lock_guard<std::mutex> reload_lock(reload_mutex);
+    logger->log(tag,RHVoice_log_level_info,"reloading the user dictionaries and configuration");
+    std::shared_ptr<setting_values> values=cfg.read(get_config_file_path());
+    std::vector<std::pair<const language*,std::shared_ptr<const userdict::dict> > > udicts;
+    for(language_list::iterator it(languages.begin());it!=languages.end();++it)
+      {
+        if(it->has_instance())
+          {
+            const language& lang=it->get_instance();
+            std::shared_ptr<const userdict::dict> udict=lang.load_userdict();
+            values->set_object(&lang,udict);
+            udicts.push_back(std::make_pair(&lang,udict));
+          }
+      }
+    cfg.publish(values);
+    for(std::size_t i=0;i<udicts.size();++i)
+      {
+        udicts[i].first->set_userdict(udicts[i].second);
+      }
+    logger->log(tag,RHVoice_log_level_info,"reloaded");
+  }
+
+  engine::utterance_scope::utterance_scope(const engine& e):
+    scope(e.cfg.get_values())
+  {
+  }
+
   voice_profile engine::create_voice_profile(const std::string& spec) const
   {
     voice_profile profile;
@@ -56,48 +56,42 @@ namespace RHVoice
       throw file_format_error("Unsupported eq version");
     coefs_t cs;
     while(read_coefs(cs, f))
-      {
-        if(sections.empty())
-          sections.push_back(section_t(cs, x0, x1, x2));
-        else
-          {
-            const auto& s=sections.back();
-            sections.push_back(section_t(cs, s.y0, s.y1, s.y2));
-          }
-      }
+      sections.push_back(section_t(cs));
     if(sections.empty())
       throw file_format_error("0 eq sections read");
   }
 
   void equalizer::reset()
   {
-    x2=0;
-    x1=0;
-    x0=0;
     for(auto& s: sections)
       {
+        s.x2=0;
+        s.x1=0;
         s.y2=0;
         s.y1=0;
-        s.y0=0;
       }
   }
 
-  double equalizer::apply(double x) {
-    double y=x;
-    x0=x;
-    for(auto& s: sections)
-      {
-        s.y0=s.b0*s.x0+s.b1*s.x1+s.b2*s.x2-s.a1*s.y1-s.a2*s.y2;
-        y=s.y0;
-      }
-    x2=x1;
-    x1=x0;
+  void equalizer::apply(float* samples, std::size_t count)
+  {
     for(auto& s: sections)
       {
-        s.y2=s.y1;
-        s.y1=s.y0;
+        double x1=s.x1, x2=s.x2, y1=s.y1, y2=s.y2;
+        for(std::size_t i=0; i<count; ++i)
+          {
+            const double x0=samples[i];
+            const double y0=s.b0*x0+s.b1*x1+s.b2*x2-s.a1*y1-s.a2*y2;
+            x2=x1;
+            x1=x0;
+            y2=y1;
+            y1=y0;
+            samples[i]=y0;
+          }
+        s.x1=x1;
+        s.x2=x2;
+        s.y1=y1;
+        s.y2=y2;
       }
-    return y;
   }
 }
 
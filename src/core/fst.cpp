@@ -25,6 +25,8 @@ namespace RHVoice
     const std::string err_msg("Incorrect format of the fst file");
   }
 
+  const fst::symbol_id fst::copy_symbol;
+
   void fst::alphabet::load(std::istream& in)
   {
     fst::symbol_id num_symbols;
@@ -32,6 +34,9 @@ namespace RHVoice
       throw file_format_error(err_msg);
     ids_to_names.clear();
     names_to_ids.clear();
+    cps_to_ids.clear();
+    other_cps_to_ids.clear();
+    single_char_flags.assign(num_symbols,false);
     ids_to_names.reserve(num_symbols);
     std::string name;
     for(fst::symbol_id i=0;i<num_symbols;++i)
@@ -40,7 +45,31 @@ namespace RHVoice
           throw file_format_error(err_msg);
         ids_to_names.push_back(name);
         names_to_ids[name]=i+2;
+        if(name.empty()||!utf8::is_valid(name.begin(),name.end()))
+          continue;
+        std::string::const_iterator pos=name.begin();
+        std::string::const_iterator end=name.end();
+        utf8::uint32_t cp=utf8::next(pos,end);
+        if(pos!=end)
+          continue;
+        single_char_flags[i]=true;
+        if(cp<max_direct_cp)
+          {
+            if(cp>=cps_to_ids.size())
+              cps_to_ids.resize(cp+1,copy_symbol);
+            cps_to_ids[cp]=i+2;
+          }
+        else
+          other_cps_to_ids.push_back(std::pair<utf8::uint32_t,symbol_id>(cp,i+2));
       }
+    std::sort(other_cps_to_ids.begin(),other_cps_to_ids.end());
+  }
+
+  const std::string& fst::alphabet::name_ref(symbol_id id) const
+  {
+    if((id<2)||(id>=(ids_to_names.size()+2)))
+      throw symbol_not_found();
+    return ids_to_names[id-2];
   }
 
   fst::arc::arc(std::istream& in)
@@ -88,9 +117,7 @@ namespace RHVoice
 
   std::string fst::alphabet::name(symbol_id id) const
   {
-    if((id<2)||(id>=(ids_to_names.size()+2)))
-      throw symbol_not_found();
-    return ids_to_names[id-2];
+    return name_ref(id);
   }
 
   std::string fst::alphabet::name(symbol_id id,const std::string& default_name) const
@@ -141,4 +168,22 @@ namespace RHVoice
           }
       }
   }
+
+  bool fst::translate(id_translation& t) const
+  {
+    t.output.clear();
+    if(!find_path(t.input.begin(),t.input.end(),[](symbol_id id) {return id;},t.path))
+      return false;
+    id_translation::output_symbol o;
+    o.input_pos=0;
+    for(std::vector<arc_filter>::const_iterator it=t.path.begin();it!=t.path.end();++it)
+      {
+        o.id=it->get().osymbol;
+        if(o.id!=0)
+          t.output.push_back(o);
+        if(it->get().isymbol!=0)
+          ++o.input_pos;
+      }
+    return true;
+  }
 }
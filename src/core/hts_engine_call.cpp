@@ -24,6 +24,7 @@
 #if ENABLE_SONIC
 #include "sonic.h"
 #endif
+#include "RHVoice_common.h"
 #include "core/language.hpp"
 #include "core/voice.hpp"
 #include "core/tone.hpp"
@@ -34,10 +35,24 @@ namespace RHVoice
 {
   namespace
   {
+    // The last stage: limiting, volume and conversion to 16 bits,
+    // applied to whole blocks of the size the player wants.
     class sink: public speech_processor
     {
+    public:
+      sink(double volume_,bool limit):
+        scale(volume_*32768)
+      {
+        if(limit)
+          lim.reset(new limiter(std::max(volume_,1.0)));
+      }
+
     private:
+      void do_initialize();
       void on_input();
+      void on_end_of_input();
+      void play(const sample_type* block,std::size_t count);
+
       bool accepts_insertions() const
       {
         return true;
@@ -48,17 +63,49 @@ namespace RHVoice
         return (player->get_audio_buffer_size()/1000.0*sample_rate);
       }
 
+      const sample_type scale;
+      std::unique_ptr<limiter> lim;
+      buffer_type limited;
       std::vector<short> samples;
     };
 
+    void sink::do_initialize()
+    {
+      if(lim)
+        lim->initialize(sample_rate);
+    }
+
     void sink::on_input()
     {
-      samples.clear();
-      for(std::size_t i=0;i<input.size();++i)
+      if(!lim)
         {
-          sample_type s=input[i]*32768;
+          play(input.data(),input.size());
+          return;
+        }
+      if(limited.size()<input.size())
+        limited.resize(input.size());
+      play(limited.data(),lim->process(input.data(),input.size(),limited.data()));
+    }
+
+    void sink::on_end_of_input()
+    {
+      if(!lim)
+        return;
+      if(limited.size()<lim->get_window_size())
+        limited.resize(lim->get_window_size());
+      play(limited.data(),lim->flush(limited.data()));
+    }
+
+    void sink::play(const sample_type* block,std::size_t count)
+    {
+      if(count==0)
+        return;
+      samples.resize(count);
+      for(std::size_t i=0;i<count;++i)
+        {
+          sample_type s=block[i]*scale;
           s=std::max<sample_type>(-32768,std::min<sample_type>(32767,s));
-          samples.push_back(static_cast<short>(s));
+          samples[i]=static_cast<short>(s);
         }
       bool should_continue=player->play_speech(&samples[0],samples.size());
       if(!should_continue)
@@ -95,7 +142,7 @@ namespace RHVoice
           else
             ++enext;
         }
-      output=input;
+      output.swap(input);
       time+=output.size();
     }
 
@@ -142,31 +189,6 @@ namespace RHVoice
     output=input;
   }
 
-  class volume_controller: public speech_processor
-  {
-  public:
-    explicit volume_controller(double volume_):
-      volume(volume_)
-    {
-    }
-
-  private:
-    void on_input();
-
-    bool accepts_insertions() const
-    {
-      return true;
-    }
-
-    double volume;
-  };
-
-  void volume_controller::on_input()
-  {
-    for(std::size_t i=0;i<input.size();++i)
-      output.push_back(input[i]*volume);
-  }
-
 #if ENABLE_SONIC
   class rate_controller: public speech_processor
   {
@@ -191,7 +213,6 @@ namespace RHVoice
 
     double rate;
     sonicStream stream;
-    std::vector<float> samples;
   };
 
   void rate_controller::do_initialize()
@@ -204,8 +225,7 @@ namespace RHVoice
 
   void rate_controller::on_input()
   {
-    samples.assign(input.begin(),input.end());
-    if(sonicWriteFloatToStream(stream,&samples[0],samples.size())==0)
+    if(sonicWriteFloatToStream(stream,&input[0],input.size())==0)
       throw std::bad_alloc();
   }
 
@@ -219,10 +239,8 @@ namespace RHVoice
     int n=sonicSamplesAvailable(stream);
     if(n>0)
       {
-        if(n>samples.size())
-          samples.resize(n,0);
-        sonicReadFloatFromStream(stream,&samples[0],n);
-        output.assign(samples.begin(),samples.begin()+n);
+        output.resize(n);
+        sonicReadFloatFromStream(stream,&output[0],n);
       }
   }
 #endif
@@ -278,8 +296,8 @@ namespace RHVoice
             insertion=(*icon)();
           }
       }
-    output=input;
-    time+=input.size();
+    output.swap(input);
+    time+=output.size();
   }
 
   hts_engine_call::hts_engine_call(hts_engine_pool& pool,const utterance& u,client& player_):
@@ -298,10 +316,15 @@ namespace RHVoice
 
   bool hts_engine_call::execute()
   {
+    if(utt.is_cancelled())
+      return false;
+    engine_impl->set_cancellation_token(utt.get_cancellation_token());
     set_input();
+    if(utt.get_flags()&RHVoice_synth_flag_timing_only)
+      return report_timing();
     set_output();
     engine_impl->synthesize();
-    return !output.is_stopped();
+    return (!output.is_stopped()&&!utt.is_cancelled());
   }
 
   void hts_engine_call::set_input()
@@ -365,15 +388,56 @@ namespace RHVoice
 
   void hts_engine_call::add_label(const item& seg)
   {
+    // Added before the label, so that it follows the previous one
+    if(player.get_supported_events()&event_phone_starts)
+      input.add_event<phone_starts_event>(seg);
     hts_label& lab=input.add_label(seg);
   }
 
+  // Only the durations are predicted. The events are sent in the same
+  // order as during the synthesis, and the time between them is
+  // reported instead of the speech.
+  bool hts_engine_call::report_timing()
+  {
+    if(!player.configure(engine_impl->get_sample_rate()))
+      throw client_error("Cannot configure player");
+    if(input.lbegin()!=input.lend())
+      {
+        double rate=input.lbegin()->get_rate()*engine_impl->get_native_rate();
+        if(rate!=1)
+          engine_impl->set_rate(rate);
+        engine_impl->predict_timing();
+      }
+    int time=0;
+    for(event_sequence::const_iterator it=input.ebegin();it!=input.eend();++it)
+      {
+        int event_time=(*it)->get_time();
+        if(event_time>time)
+          {
+            if(!player.skip_speech(event_time-time))
+              return false;
+            time=event_time;
+          }
+        if(!(*it)->notify(player))
+          return false;
+      }
+    if(input.lbegin()==input.lend())
+      return true;
+    const hts_label& last_lab=input.get_label(input.label_count()-1);
+    int end_time=last_lab.get_time()+last_lab.get_duration();
+    if(end_time>time)
+      return player.skip_speech(end_time-time);
+    return true;
+  }
+
   void hts_engine_call::set_output()
   {
     if(!player.configure(engine_impl->get_sample_rate()))
       throw client_error("Cannot configure player");
     output.set_client(player);
     output.set_sample_rate(engine_impl->get_sample_rate());
+    engine_impl->set_audio_buffer_size(player.get_audio_buffer_size());
+    engine_impl->set_offline(utt.get_flags()&RHVoice_synth_flag_offline);
     if(input.ebegin()!=input.eend())
       {
         notifier* n=new notifier(input.ebegin(),input.eend());
@@ -404,17 +468,7 @@ namespace RHVoice
             #endif
           }
         double volume=input.lbegin()->get_volume()*engine_impl->get_gain();
-        if(volume>1 || engine_impl->uses_eq())
-          {
-            limiter* lm=new limiter(std::max(volume, 1.0));
-            output.append(lm);
-          }
-        if(volume!=1)
-          {
-            volume_controller* vc=new volume_controller(volume);
-            output.append(vc);
-          }
-        sink* s=new sink;
+        sink* s=new sink(volume,(volume>1 || engine_impl->uses_eq()));
         output.append(s);
       }
     engine_impl->set_output(output);
@@ -36,6 +36,9 @@ namespace RHVoice
     input(0),
     output(0),
     rate(1.0),
+    audio_buffer_size(0),
+    offline(false),
+    cancellation(0),
     pitch_shift(0),
     name(impl_name)
   {
@@ -46,10 +49,20 @@ namespace RHVoice
   {
     if(input->lbegin()!=input->lend())
       do_synthesize();
+    // Whatever is still buffered is dropped
+    if(is_cancelled())
+      output->stop();
+    flush_samples();
     if(!output->is_stopped())
       output->finish();
   }
 
+  void hts_engine_impl::predict_timing()
+  {
+    if(input->lbegin()!=input->lend())
+      do_predict_timing();
+  }
+
   void hts_engine_impl::reset()
   {
     if(input->lbegin()!=input->lend())
@@ -57,8 +70,12 @@ namespace RHVoice
     output=0;
     input=0;
     rate=1.0;
+    audio_buffer_size=0;
+    offline=false;
+    cancellation=0;
     pitch_shift=0;
     pitch_editor.reset();
+    samples.clear();
     if(eq)
       eq->reset();
   }
@@ -98,22 +115,39 @@ namespace RHVoice
 
   void hts_engine_impl::on_new_sample(short sample)
   {
+    if(is_cancelled())
+      output->stop();
     if(output->is_stopped())
       {
         do_stop();
         return;
       }
-    double s=(sample/32768.0);
-    if(eq)
-      s=eq->apply(s);
-    try
-      {
-        output->process(&s,1);
-      }
-    catch(...)
+    samples.push_back(sample/32768.0f);
+    // 5 ms, the resolution of the event timing: the notifier
+    // delivers an event at the start of the first block which begins
+    // at or after its time
+    if(samples.size()>=static_cast<std::size_t>(get_sample_rate()/200))
+      flush_samples();
+  }
+
+  void hts_engine_impl::flush_samples()
+  {
+    if(samples.empty())
+      return;
+    if(!output->is_stopped())
       {
-        output->stop();
+        if(eq)
+          eq->apply(samples.data(),samples.size());
+        try
+          {
+            output->process(samples.data(),samples.size());
+          }
+        catch(...)
+          {
+            output->stop();
+          }
       }
+    samples.clear();
     if(output->is_stopped())
       do_stop();
   }
@@ -0,0 +1,134 @@
+/* Copyright (C) 2026  RHVoice contributors */
+
+/* This program is free software: you can redistribute it and/or modify */
+/* it under the terms of the GNU Lesser General Public License as published by */
+/* the Free Software Foundation, either version 2.1 of the License, or */
+/* (at your option) any later version. */
+
+/* This program is distributed in the hope that it will be useful, */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+/* GNU Lesser General Public License for more details. */
+
+/* You should have received a copy of the GNU Lesser General Public License */
+/* along with this program.  If not, see <https://www.gnu.org/licenses/>. */
+
+#include <algorithm>
+#include "core/hts_engine_pool.hpp"
+
+namespace RHVoice
+{
+  hts_engine_impl::pointer hts_engine_pool_manager::take(hts_engine_pool& pool,quality_t quality)
+  {
+    hts_engine_impl::pointer result;
+    threading::lock l(mgr_mutex);
+    std::deque<idle_list::iterator>& free_list=pool.free_lists[quality];
+    if(free_list.empty())
+      return result;
+    idle_list::iterator it=free_list.back();
+    free_list.pop_back();
+    result=it->engine;
+    idle.erase(it);
+    --pool.idle_count;
+    ++stats.hits;
+    stats.idle_bytes-=result->get_memory_size();
+    --stats.idle_instances;
+    return result;
+  }
+
+  void hts_engine_pool_manager::add(const hts_engine_impl::pointer& engine)
+  {
+    engine_vector evicted;
+    threading::lock l(mgr_mutex);
+    ++stats.creations;
+    stats.bytes+=engine->get_memory_size();
+    // The evicted engines are destroyed after the mutex is unlocked
+    evict(evicted);
+  }
+
+  void hts_engine_pool_manager::put(hts_engine_pool& pool,const hts_engine_impl::pointer& engine)
+  {
+    engine_vector evicted;
+    threading::lock l(mgr_mutex);
+    idle_engine e;
+    e.pool=&pool;
+    e.engine=engine;
+    idle.push_back(e);
+    idle_list::iterator it=idle.end();
+    --it;
+    pool.free_lists[engine->get_quality()].push_back(it);
+    ++pool.idle_count;
+    stats.idle_bytes+=engine->get_memory_size();
+    ++stats.idle_instances;
+    evict(evicted);
+  }
+
+  void hts_engine_pool_manager::remove(idle_list::iterator it,engine_vector& evicted)
+  {
+    hts_engine_pool& pool=*(it->pool);
+    std::deque<idle_list::iterator>& free_list=pool.free_lists[it->engine->get_quality()];
+    // Both lists are in the order of release, so this is normally the
+    // front one
+    if(free_list.front()==it)
+      free_list.pop_front();
+    else
+      free_list.erase(std::find(free_list.begin(),free_list.end(),it));
+    --pool.idle_count;
+    const std::size_t size=it->engine->get_memory_size();
+    stats.bytes-=size;
+    stats.idle_bytes-=size;
+    --stats.idle_instances;
+    evicted.push_back(it->engine);
+    idle.erase(it);
+  }
+
+  void hts_engine_pool_manager::evict(engine_vector& evicted)
+  {
+    if(params==nullptr)
+      return;
+    const std::size_t limit=static_cast<std::size_t>(params->memory_limit)*1024*1024;
+    if(limit==0)
+      return;
+    const std::size_t min_idle=params->min_idle;
+    idle_list::iterator it=idle.begin();
+    while((stats.bytes>limit)&&(it!=idle.end()))
+      {
+        if(it->pool->idle_count>min_idle)
+          remove(it++,evicted);
+        else
+          ++it;
+      }
+    // Then whole voices, the ones used least recently first
+    while((stats.bytes>limit)&&!idle.empty())
+      remove(idle.begin(),evicted);
+    stats.evictions+=evicted.size();
+  }
+
+  void hts_engine_pool_manager::remove_pool(hts_engine_pool& pool)
+  {
+    engine_vector evicted;
+    threading::lock l(mgr_mutex);
+    for(idle_list::iterator it=idle.begin();it!=idle.end();)
+      {
+        if(it->pool==&pool)
+          remove(it++,evicted);
+        else
+          ++it;
+      }
+  }
+
+  hts_engine_pool::hts_engine_pool(const voice_info& info_,const std::shared_ptr<hts_engine_pool_manager>& mgr):
+    info(info_),
+    manager(mgr),
+    idle_count(0)
+  {
+    if(!manager)
+      manager.reset(new hts_engine_pool_manager);
+    prototypes.push_back(hts_engine_impl::pointer(new str_hts_engine_impl(info_)));
+  }
+
+  hts_engine_pool::~hts_engine_pool()
+  {
+    manager->remove_pool(*this);
+  }
+}
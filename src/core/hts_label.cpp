@@ -137,13 +137,9 @@ true);
     return false;
   }
 
-  const std::string& hts_label::get_name() const
+  std::string hts_label::eval_name() const
     {
-      if(name.empty())
-        {
-          const hts_labeller& labeller=segment->get_relation().get_utterance().get_language().get_hts_labeller();
-          name=labeller.eval_segment_label(*segment);
-        }
-      return name;
+      const hts_labeller& labeller=segment->get_relation().get_utterance().get_language().get_hts_labeller();
+      return labeller.eval_segment_label(*segment);
     }
 }
@@ -373,13 +373,7 @@ namespace RHVoice
 
       value eval(const item& seg) const
       {
-        if(is_silence(seg))
-          return x;
-        item::const_reverse_iterator syl_pos=seg.as("SylStructure").parent().as("Syllable").get_reverse_iterator();
-        item::const_reverse_iterator first_syl_in_phrase_pos=seg.as("SylStructure").parent().parent().as("Phrase").parent().first_child().as("SylStructure").first_child().as("Syllable").get_reverse_iterator();
-        item::const_reverse_iterator stressed_syl_pos=std::find_if(syl_pos,first_syl_in_phrase_pos,feature_equals<std::string>("stress","1"));
-        unsigned int result=(stressed_syl_pos==first_syl_in_phrase_pos)?0:(std::distance(syl_pos,stressed_syl_pos)+1);
-        return result;
+        return is_silence(seg)?x:seg.eval("R:SylStructure.parent.dist_to_prev_ssyl");
       }
     };
 
@@ -392,13 +386,7 @@ namespace RHVoice
 
       value eval(const item& seg) const
       {
-        if(is_silence(seg))
-          return x;
-        item::const_iterator syl_pos=seg.as("SylStructure").parent().as("Syllable").get_iterator();
-        item::const_iterator first_syl_in_next_phrase_pos=++(syl_pos->as("SylStructure").parent().as("Phrase").parent().last_child().as("SylStructure").last_child().as("Syllable").get_iterator());
-        item::const_iterator stressed_syl_pos=std::find_if(++item::const_iterator(syl_pos),first_syl_in_next_phrase_pos,feature_equals<std::string>("stress","1"));
-        unsigned int result=(stressed_syl_pos==first_syl_in_next_phrase_pos)?0:std::distance(syl_pos,stressed_syl_pos);
-        return result;
+        return is_silence(seg)?x:seg.eval("R:SylStructure.parent.dist_to_next_ssyl");
       }
     };
 
@@ -411,13 +399,7 @@ namespace RHVoice
 
       value eval(const item& seg) const
       {
-        if(is_silence(seg))
-          return x;
-        item::const_reverse_iterator syl_pos=seg.as("SylStructure").parent().as("Syllable").get_reverse_iterator();
-        item::const_reverse_iterator first_syl_in_phrase_pos=seg.as("SylStructure").parent().parent().as("Phrase").parent().first_child().as("SylStructure").first_child().as("Syllable").get_reverse_iterator();
-        item::const_reverse_iterator accented_syl_pos=std::find_if(syl_pos,first_syl_in_phrase_pos,feature_equals<std::string>("accented","1"));
-        unsigned int result=(accented_syl_pos==first_syl_in_phrase_pos)?0:(std::distance(syl_pos,accented_syl_pos)+1);
-        return result;
+        return is_silence(seg)?x:seg.eval("R:SylStructure.parent.dist_to_prev_asyl");
       }
     };
 
@@ -430,13 +412,7 @@ namespace RHVoice
 
       value eval(const item& seg) const
       {
-        if(is_silence(seg))
-          return x;
-        item::const_iterator syl_pos=seg.as("SylStructure").parent().as("Syllable").get_iterator();
-        item::const_iterator first_syl_in_next_phrase_pos=++(syl_pos->as("SylStructure").parent().as("Phrase").parent().last_child().as("SylStructure").last_child().as("Syllable").get_iterator());
-        item::const_iterator accented_syl_pos=std::find_if(++item::const_iterator(syl_pos),first_syl_in_next_phrase_pos,feature_equals<std::string>("accented","1"));
-        unsigned int result=(accented_syl_pos==first_syl_in_next_phrase_pos)?0:std::distance(syl_pos,accented_syl_pos);
-        return result;
+        return is_silence(seg)?x:seg.eval("R:SylStructure.parent.dist_to_next_asyl");
       }
     };
 
@@ -800,13 +776,7 @@ namespace RHVoice
 
       value eval(const item& seg) const
       {
-        if(is_silence(seg))
-          return x;
-        const item& word=seg.as("SylStructure").parent().parent().as("Phrase");
-        const item& phrase=word.parent();
-        item::const_reverse_iterator pos=std::find_if(word.get_reverse_iterator(),phrase.rend(),feature_equals<std::string>("gpos","content"));
-        unsigned int result=(pos==phrase.rend())?0:(std::distance(word.get_reverse_iterator(),pos)+1);
-        return result;
+        return is_silence(seg)?x:seg.eval("R:SylStructure.parent.parent.dist_to_prev_content_word");
       }
     };
 
@@ -819,13 +789,7 @@ namespace RHVoice
 
       value eval(const item& seg) const
       {
-        if(is_silence(seg))
-          return x;
-        const item& word=seg.as("SylStructure").parent().parent().as("Phrase");
-        const item& phrase=word.parent();
-        item::const_iterator pos=std::find_if(++(word.get_iterator()),phrase.end(),feature_equals<std::string>("gpos","content"));
-        unsigned int result=(pos==phrase.end())?0:std::distance(word.get_iterator(),pos);
-        return result;
+        return is_silence(seg)?x:seg.eval("R:SylStructure.parent.parent.dist_to_next_content_word");
       }
     };
 
@@ -942,11 +906,7 @@ namespace RHVoice
 
       value eval(const item& seg) const
       {
-        if(is_silence(seg))
-          return x;
-        const item& phrase=seg.as("SylStructure").parent().parent().as("Phrase").parent();
-        unsigned int result=std::distance(phrase.get_relation().begin(),phrase.get_iterator())+1;
-        return result;
+        return is_silence(seg)?x:(seg.eval("R:SylStructure.parent.parent.R:Phrase.parent.phrases_in").as<unsigned int>()+1);
       }
     };
 
@@ -959,11 +919,7 @@ namespace RHVoice
 
       value eval(const item& seg) const
       {
-        if(is_silence(seg))
-          return x;
-        const item& phrase=seg.as("SylStructure").parent().parent().as("Phrase").parent();
-        unsigned int result=std::distance(phrase.get_iterator(),phrase.get_relation().end());
-        return result;
+        return is_silence(seg)?x:(seg.eval("R:SylStructure.parent.parent.R:Phrase.parent.phrases_out").as<unsigned int>()+1);
       }
     };
 
@@ -1015,9 +971,7 @@ namespace RHVoice
 
       value eval(const item& seg) const
       {
-        const relation& syl_rel=seg.get_relation().get_utterance().get_relation("Syllable");
-        unsigned int result=std::distance(syl_rel.begin(),syl_rel.end());
-        return result;
+        return seg.eval("utt_numsyls");
       }
     };
 
@@ -1030,9 +984,7 @@ namespace RHVoice
 
       value eval(const item& seg) const
       {
-        const relation& word_rel=seg.get_relation().get_utterance().get_relation("Word");
-        unsigned int result=std::distance(word_rel.begin(),word_rel.end());
-        return result;
+        return seg.eval("utt_numwords");
       }
     };
 
@@ -1045,9 +997,7 @@ namespace RHVoice
 
       value eval(const item& seg) const
       {
-        const relation& phrase_rel=seg.get_relation().get_utterance().get_relation("Phrase");
-        unsigned int result=std::distance(phrase_rel.begin(),phrase_rel.end());
-        return result;
+        return seg.eval("utt_numphrases");
       }
     };
 
@@ -17,6 +17,7 @@
 #include <utility>
 #include <iostream>
 #include "core/hts_vocoder_wrapper.hpp"
+#include "core/worker_pool.hpp"
 #include "HTS_hidden.h"
 
 namespace RHVoice
@@ -40,6 +41,7 @@ namespace RHVoice
 
   void hts_vocoder_wrapper::clear()
   {
+    pauses.clear();
     if(vocoder==nullptr)
       return;
     HTS_Vocoder_clear(vocoder.get());
@@ -48,6 +50,7 @@ namespace RHVoice
     pitch_editor=nullptr;
     count=0;
     pitch_shift=0;
+    pool=nullptr;
     while(!fq.empty())
       fq.pop();
   }
@@ -57,6 +60,20 @@ namespace RHVoice
     clear();
   }
 
+  void hts_vocoder_wrapper::add_pause(std::size_t first, std::size_t length)
+  {
+    if(length<=2*pause_margin)
+      return;
+    pauses.emplace_back(first+pause_margin, first+length-pause_margin);
+  }
+
+  bool hts_vocoder_wrapper::is_silent(std::size_t index)
+  {
+    while(!pauses.empty() && pauses.front().second<=index)
+      pauses.pop_front();
+    return (!pauses.empty() && pauses.front().first<=index);
+  }
+
   void hts_vocoder_wrapper::synth(std::size_t i, std::size_t n)
   {
     auto* pss=&engine->pss;
@@ -82,6 +99,8 @@ namespace RHVoice
             f.lf0=HTS_PStreamSet_get_parameter(pss, 1, l, 0);
             ++l;
           }
+        else
+          f.silent=is_silent(f.index);
         if(pitch_editor->has_work())
           {
             if(f.voiced)
@@ -102,13 +121,114 @@ namespace RHVoice
         fq.push(std::move(f));
         ++count;
       }
-    do_synth();
+    if(pool==nullptr)
+      do_synth();
   }
 
   void hts_vocoder_wrapper::finish()
   {
     pitch_editor->finish();
-    do_synth();
+    if(pool==nullptr)
+      do_synth();
+    else
+      do_parallel_synth();
+  }
+
+  void hts_vocoder_wrapper::do_parallel_synth()
+  {
+    std::vector<frame_t> frames;
+    frames.reserve(fq.size());
+    while(!fq.empty())
+      {
+        auto& f=fq.front();
+        if(f.voiced)
+          {
+            if(pitch_editor->has_work())
+              f.lf0=pitch_editor->get_result(f.index);
+            f.lf0+=pitch_shift;
+          }
+        frames.push_back(std::move(f));
+        fq.pop();
+      }
+    // The filters do not ring across the inner frames of a pause, so
+    // each part starts with one of them. The pulse ring and the noise
+    // history still would: the serial path keeps them through
+    // HTS_Vocoder_synthesize_silence, while here every part starts
+    // with empty ones.
+    std::vector<std::size_t> starts{0};
+    for(std::size_t i=1; i<frames.size(); ++i)
+      {
+        if(frames[i].silent && !frames[i-1].silent)
+          starts.push_back(i);
+      }
+    starts.push_back(frames.size());
+    std::vector<std::vector<short>> samples(starts.size()-1);
+    pool->run(samples.size(), [&](std::size_t s) {
+                                synth_segment(frames, starts[s], starts[s+1], samples[s]);
+                              });
+    for(const auto& part: samples)
+      {
+        for(auto sample: part)
+          {
+            if(HTS_Engine_is_cancelled(engine))
+              return;
+            HTS_Audio_write(&engine->audio, sample);
+          }
+      }
+  }
+
+  void hts_vocoder_wrapper::synth_segment(std::vector<frame_t>& frames, std::size_t first, std::size_t last, std::vector<short>& samples)
+  {
+    const auto nspec=HTS_PStreamSet_get_vector_length(&engine->pss, 0);
+    const auto fperiod=HTS_Engine_get_fperiod(engine);
+    _HTS_Vocoder v;
+    HTS_Vocoder_initialize(&v,
+                           HTS_ModelSet_get_vector_length(&engine->ms, 0) - 1,
+                           0,
+                           0,
+                           HTS_Engine_get_sampling_frequency(engine),
+                           fperiod);
+    std::vector<double> raw(fperiod);
+    samples.reserve((last-first)*fperiod);
+    for(auto i=first; i<last; ++i)
+      {
+        if(HTS_Engine_is_cancelled(engine))
+          break;
+        auto& f=frames[i];
+        if(f.silent)
+          {
+            HTS_Vocoder_synthesize_silence(&v,
+                                           nspec - 1,
+                                           f.spec.data(),
+                                           &engine->bpf,
+                                           engine->condition.alpha,
+                                           nullptr);
+            samples.insert(samples.end(), fperiod, 0);
+            continue;
+          }
+        HTS_Vocoder_synthesize(&v,
+                               nspec - 1,
+                               f.lf0,
+                               f.spec.data(),
+                               f.bap.data(),
+                               &engine->bpf,
+                               engine->condition.alpha,
+                               engine->condition.beta,
+                               engine->condition.volume,
+                               raw.data(),
+                               nullptr);
+        // The same conversion as in HTS_Vocoder_synthesize
+        for(auto x: raw)
+          {
+            if(x>32767.0)
+              samples.push_back(32767);
+            else if(x<-32768.0)
+              samples.push_back(-32768);
+            else
+              samples.push_back(static_cast<short>(x));
+          }
+      }
+    HTS_Vocoder_clear(&v);
   }
 
   void hts_vocoder_wrapper::do_synth()
@@ -116,7 +236,7 @@ namespace RHVoice
     const auto nspec=HTS_PStreamSet_get_vector_length(&engine->pss, 0);
     while(!fq.empty())
       {
-        if(engine->condition.stop)
+        if(HTS_Engine_is_cancelled(engine))
           return;
         auto& f=fq.front();
         auto lf0=f.lf0;
@@ -126,6 +246,17 @@ namespace RHVoice
               return;
             lf0=pitch_editor->get_result(f.index);
           }
+        if(f.silent)
+          {
+            HTS_Vocoder_synthesize_silence(vocoder.get(),
+                                           nspec - 1,
+                                           f.spec.data(),
+                                           &engine->bpf,
+                                           engine->condition.alpha,
+                                           &engine->audio);
+            fq.pop();
+            continue;
+          }
         if(f.voiced)
           lf0+=pitch_shift;
         HTS_Vocoder_synthesize(vocoder.get(),
@@ -18,6 +18,7 @@
 #include <functional>
 #include <iterator>
 #include <sstream>
+#include <vector>
 #include "core/str.hpp"
 #include "core/engine.hpp"
 #include "core/item.hpp"
@@ -43,6 +44,47 @@ namespace RHVoice
   {
     const value zero(std::string("0"));
 
+    // Stores the counts of the marked items before and after each
+    // item of a sequence, and the distances to the nearest ones. Not
+    // every language sets the marking feature, the feature functions
+    // will report that if these features are ever needed.
+    void set_sequence_features(const std::vector<item*>& items,const std::string& name,const std::string& marked_value,const std::string& in_name,const std::string& out_name,const std::string& dist_in_name,const std::string& dist_out_name)
+    {
+      const std::size_t n=items.size();
+      std::vector<bool> marked(n);
+      for(std::size_t i=0;i<n;++i)
+        {
+          const value v=items[i]->eval(name,value());
+          if(v.empty())
+            return;
+          marked[i]=(v.as<std::string>()==marked_value);
+        }
+      unsigned int count=0;
+      std::size_t last=n;
+      for(std::size_t i=0;i<n;++i)
+        {
+          items[i]->set(in_name,count);
+          items[i]->set(dist_in_name,static_cast<unsigned int>((last==n)?0:(i-last)));
+          if(marked[i])
+            {
+              ++count;
+              last=i;
+            }
+        }
+      count=0;
+      last=n;
+      for(std::size_t i=n;i>0;--i)
+        {
+          items[i-1]->set(out_name,count);
+          items[i-1]->set(dist_out_name,static_cast<unsigned int>((last==n)?0:(last-(i-1))));
+          if(marked[i-1])
+            {
+              ++count;
+              last=i-1;
+            }
+        }
+    }
+
     struct feat_pos_in_syl: public feature_function
     {
       feat_pos_in_syl():
@@ -258,6 +300,48 @@ namespace RHVoice
       }
     };
 
+    struct feat_dist_to_prev_syl: public feature_function
+    {
+      feat_dist_to_prev_syl(const std::string& name,const std::string& syl_feature_name):
+        feature_function(name),
+        is_marked(syl_feature_name,"1")
+      {
+      }
+
+      value eval(const item& syl) const
+      {
+        item::const_reverse_iterator syl_pos=syl.as("Syllable").get_reverse_iterator();
+        item::const_reverse_iterator first_syl_in_phrase_pos=syl.as("SylStructure").parent().as("Phrase").parent().first_child().as("SylStructure").first_child().as("Syllable").get_reverse_iterator();
+        item::const_reverse_iterator marked_syl_pos=std::find_if(syl_pos,first_syl_in_phrase_pos,is_marked);
+        unsigned int result=(marked_syl_pos==first_syl_in_phrase_pos)?0:(std::distance(syl_pos,marked_syl_pos)+1);
+        return result;
+      }
+
+    private:
+      const feature_equals<std::string> is_marked;
+    };
+
+    struct feat_dist_to_next_syl: public feature_function
+    {
+      feat_dist_to_next_syl(const std::string& name,const std::string& syl_feature_name):
+        feature_function(name),
+        is_marked(syl_feature_name,"1")
+      {
+      }
+
+      value eval(const item& syl) const
+      {
+        item::const_iterator syl_pos=syl.as("Syllable").get_iterator();
+        item::const_iterator first_syl_in_next_phrase_pos=++(syl.as("SylStructure").parent().as("Phrase").parent().last_child().as("SylStructure").last_child().as("Syllable").get_iterator());
+        item::const_iterator marked_syl_pos=std::find_if(++item::const_iterator(syl_pos),first_syl_in_next_phrase_pos,is_marked);
+        unsigned int result=(marked_syl_pos==first_syl_in_next_phrase_pos)?0:std::distance(syl_pos,marked_syl_pos);
+        return result;
+      }
+
+    private:
+      const feature_equals<std::string> is_marked;
+    };
+
     struct feat_syl_vowel: public feature_function
     {
       feat_syl_vowel():
@@ -333,6 +417,40 @@ namespace RHVoice
       }
     };
 
+    struct feat_dist_to_prev_content_word: public feature_function
+    {
+      feat_dist_to_prev_content_word():
+        feature_function("dist_to_prev_content_word")
+      {
+      }
+
+      value eval(const item& word) const
+      {
+        const item& word_in_phrase=word.as("Word").as("Phrase");
+        const item& phrase=word_in_phrase.parent();
+        item::const_reverse_iterator pos=std::find_if(word_in_phrase.get_reverse_iterator(),phrase.rend(),feature_equals<std::string>("gpos","content"));
+        unsigned int result=(pos==phrase.rend())?0:(std::distance(word_in_phrase.get_reverse_iterator(),pos)+1);
+        return result;
+      }
+    };
+
+    struct feat_dist_to_next_content_word: public feature_function
+    {
+      feat_dist_to_next_content_word():
+        feature_function("dist_to_next_content_word")
+      {
+      }
+
+      value eval(const item& word) const
+      {
+        const item& word_in_phrase=word.as("Word").as("Phrase");
+        const item& phrase=word_in_phrase.parent();
+        item::const_iterator pos=std::find_if(++(word_in_phrase.get_iterator()),phrase.end(),feature_equals<std::string>("gpos","content"));
+        unsigned int result=(pos==phrase.end())?0:std::distance(word_in_phrase.get_iterator(),pos);
+        return result;
+      }
+    };
+
     struct feat_phrase_numsyls: public feature_function
     {
       feat_phrase_numsyls():
@@ -445,6 +563,25 @@ namespace RHVoice
       }
     };
 
+    struct feat_utt_relation_size: public feature_function
+    {
+      feat_utt_relation_size(const std::string& name,const std::string& relation_name_):
+        feature_function(name),
+        relation_name(relation_name_)
+      {
+      }
+
+      value eval(const item& i) const
+      {
+        const relation& rel=i.get_relation().get_utterance().get_relation(relation_name);
+        unsigned int result=std::distance(rel.begin(),rel.end());
+        return result;
+      }
+
+    private:
+      const std::string relation_name;
+    };
+
     struct feat_syl_coda_size: public feature_function
     {
       feat_syl_coda_size():
@@ -575,10 +712,14 @@ else
     gpos_fst(path::join(info_.get_data_path(),"gpos.fst")),
     phrasing_dtree(path::join(info_.get_data_path(),"phrasing.dt")),
     syl_fst(path::join(info_.get_data_path(),"syl.fst")),
-    udict(info_),
+    udict(std::make_shared<userdict::dict>(info_)),
     spell_fst(path::join(info_.get_data_path(),"spell.fst")),
     downcase_fst(path::join(info_.get_data_path(),"downcase.fst"))
   {
+    tok_sb=tok_fst.get_symbol_id("sb");
+    tok_eb=tok_fst.get_symbol_id("eb");
+    tok_br=tok_fst.get_symbol_id("br");
+    tok_eos=tok_fst.get_symbol_id("eos");
     config cfg;
     cfg.register_setting(lcfg.tok_eos);
 cfg.register_setting(lcfg.tok_sent);
@@ -692,11 +833,17 @@ cfg.register_setting(lcfg.tok_sent);
     register_feature(std::shared_ptr<feature_function>(new feat_ssyl_out));
     register_feature(std::shared_ptr<feature_function>(new feat_asyl_in));
     register_feature(std::shared_ptr<feature_function>(new feat_asyl_out));
+    register_feature(std::shared_ptr<feature_function>(new feat_dist_to_prev_syl("dist_to_prev_ssyl","stress")));
+    register_feature(std::shared_ptr<feature_function>(new feat_dist_to_next_syl("dist_to_next_ssyl","stress")));
+    register_feature(std::shared_ptr<feature_function>(new feat_dist_to_prev_syl("dist_to_prev_asyl","accented")));
+    register_feature(std::shared_ptr<feature_function>(new feat_dist_to_next_syl("dist_to_next_asyl","accented")));
     register_feature(std::shared_ptr<feature_function>(new feat_syl_vowel));
     register_feature(std::shared_ptr<feature_function>(new feat_pos_in_phrase));
     register_feature(std::shared_ptr<feature_function>(new feat_words_out));
     register_feature(std::shared_ptr<feature_function>(new feat_content_words_in));
     register_feature(std::shared_ptr<feature_function>(new feat_content_words_out));
+    register_feature(std::shared_ptr<feature_function>(new feat_dist_to_prev_content_word));
+    register_feature(std::shared_ptr<feature_function>(new feat_dist_to_next_content_word));
     register_feature(std::shared_ptr<feature_function>(new feat_phrase_numsyls));
     register_feature(std::shared_ptr<feature_function>(new feat_phrase_numwords));
     register_feature(std::shared_ptr<feature_function>(new feat_syl_break));
@@ -704,6 +851,9 @@ cfg.register_setting(lcfg.tok_sent);
     register_feature(std::shared_ptr<feature_function>(new feat_word_stress_pattern));
     register_feature(std::shared_ptr<feature_function>(new feat_phrases_in));
     register_feature(std::shared_ptr<feature_function>(new feat_phrases_out));
+    register_feature(std::shared_ptr<feature_function>(new feat_utt_relation_size("utt_numsyls","Syllable")));
+    register_feature(std::shared_ptr<feature_function>(new feat_utt_relation_size("utt_numwords","Word")));
+    register_feature(std::shared_ptr<feature_function>(new feat_utt_relation_size("utt_numphrases","Phrase")));
     register_feature(std::shared_ptr<feature_function>(new feat_syl_coda_size));
     register_feature(std::shared_ptr<feature_function>(new feat_syl_onset_size));
     register_feature(std::shared_ptr<feature_function>(new feat_utt_type));
@@ -790,12 +940,12 @@ cfg.register_setting(lcfg.tok_sent);
     const language_info& lang_info=get_info();
     utf8::uint32_t stress_marker=lang_info.text_settings.stress_marker;
     bool process_stress_marks=lang_info.supports_stress_marks()&&lang_info.text_settings.stress_marker.is_set(true);
-    std::vector<utf8::uint32_t> chars;
-    std::vector<std::string> syms;
-    std::vector<bool> stress_mask;
+    tok_workspace_lease ws(*this);
+    std::vector<utf8::uint32_t>& chars=ws->chars;
+    std::vector<bool>& stress_mask=ws->stress_mask;
+    std::vector<fst::symbol_id>& syms=ws->translation.input;
     utf8::uint32_t cp;
     std::string::const_iterator it(text.begin());
-    auto pit=it;
     while(it!=text.end())
       {
         cp=utf8::next(it,text.end());
@@ -805,39 +955,36 @@ cfg.register_setting(lcfg.tok_sent);
            (lang_info.is_vowel_letter(cp)))
           {
             chars.back()=cp;
-            syms.back()=std::string(pit, it);
+            syms.back()=tok_fst.get_symbol_id(cp);
             stress_mask.back()=true;
           }
         else
           {
-            chars.push_back(cp);
-            syms.push_back(std::string(pit, it));
+            append_tok_input(*ws,cp,tok_fst.get_symbol_id(cp));
             stress_mask.push_back(false);
           }
-        pit=it;
       }
+    std::size_t num_chars=chars.size();
     if(eos && lcfg.tok_eos)
-      {
-        syms.push_back("eos");
-      }
-    std::vector<std::string> tokens;
-    if(!tok_fst.translate(syms.begin(),syms.end(),std::back_inserter(tokens)))
+      append_tok_input(*ws,tok_eos_char,tok_eos);
+    if(!tok_fst.translate(ws->translation))
       throw tokenization_error(text);
-    if(eos && lcfg.tok_eos && !tokens.empty() && tokens.back()=="eos")
+    std::vector<fst::id_translation::output_symbol>& tokens=ws->translation.output;
+    if(eos && lcfg.tok_eos && !tokens.empty() && (get_tok_output_name(*ws,tokens.back())=="eos"))
       {
         tokens.pop_back();
       }
-    std::string name,pos;
-    std::vector<utf8::uint32_t>::const_iterator token_start=chars.begin();
-    std::vector<utf8::uint32_t>::const_iterator token_end=token_start;
+    std::string& name=ws->name;
+    std::size_t token_start=0;
+    std::size_t token_end=0;
     stress_pattern stress;
-    for(std::vector<std::string>::const_iterator it(tokens.begin());it!=tokens.end();++it)
+    for(std::vector<fst::id_translation::output_symbol>::const_iterator it(tokens.begin());it!=tokens.end();++it)
       {
-        if(utf8::distance(it->begin(),it->end())>1)
+        if(!is_tok_output_char(*ws,*it))
           {
             if(token_start==token_end)
               throw tokenization_error(text);
-            pos=*it;
+            const std::string& pos=get_tok_output_name(*ws,*it);
             item& token=append_subtoken(parent_token, name, pos);
             if((pos=="word")&&(stress.get_state()!=stress_pattern::undefined))
               token.set("stress_pattern",stress);
@@ -847,11 +994,11 @@ cfg.register_setting(lcfg.tok_sent);
           }
         else
           {
-            if(token_end==chars.end())
+            if(token_end==num_chars)
               throw tokenization_error(text);
-            if(stress_mask[token_end-chars.begin()])
-              stress.stress_syllable(1+std::count_if(token_start,token_end,is_vowel_letter(lang_info)));
-            utf8::append(*token_end,std::back_inserter(name));
+            if(stress_mask[token_end])
+              stress.stress_syllable(1+std::count_if(chars.begin()+token_start,chars.begin()+token_end,is_vowel_letter(lang_info)));
+            utf8::append(chars[token_end],std::back_inserter(name));
             ++token_end;
           }
       }
@@ -1100,10 +1247,11 @@ else
     std::string name=word.get("name").as<std::string>();
     std::string cname=word.has_feature("cname")?word.get("cname").as<std::string>():"";
     std::string repl;
+    std::shared_ptr<const userdict::dict> current_udict=get_userdict();
     if(!cname.empty())
-      repl=udict.simple_search(cname);
+      repl=current_udict->simple_search(cname);
     if(repl.empty())
-      repl=udict.simple_search(name);
+      repl=current_udict->simple_search(name);
     if(repl.empty())
       return;
     word.set("name", repl);
@@ -1207,57 +1355,53 @@ else
     if(!u.has_relation("TokIn"))
       return;
     relation& in_rel=u.get_relation("TokIn");
-    const std::string sb{"sb"};
-    const std::string eb{"eb"};
-    const std::string br{"br"};
-    std::vector<std::string> input;
+    tok_workspace_lease ws(*this);
     for(auto it=in_rel.begin(); it!=in_rel.end(); ++it)
       {
-        input.push_back(sb);
-        const std::string& name=it->get("name").as<std::string>();
-        str::utf8explode(name, std::back_inserter(input));
-        input.push_back(eb);
+        append_tok_input(*ws,tok_sb_char,tok_sb);
+        append_tok_input(*ws,it->get("name").as<std::string>());
+        append_tok_input(*ws,tok_eb_char,tok_eb);
         if(!it->has_next())
           break;
         if(it->has_feature("break"))
           {
-            input.push_back(br);
+            append_tok_input(*ws,tok_br_char,tok_br);
             continue;
           }
-        const std::string& whitespace=it->next().get("whitespace").as<std::string>();
-        str::utf8explode(whitespace, std::back_inserter(input));
+        append_tok_input(*ws,it->next().get("whitespace").as<std::string>());
       }
-    std::vector<std::string> output;
-    if(!tok_fst.translate(input.begin(), input.end(), std::back_inserter(output)))
+    if(!tok_fst.translate(ws->translation))
       throw tokenization_error("");
-    auto in_it=input.cbegin();
+    const std::vector<utf8::uint32_t>& chars=ws->chars;
+    std::size_t in_pos=0;
     auto in_tok_it=in_rel.begin();
     auto out_tok_it=in_tok_it;
-    std::string name;
+    std::string& name=ws->name;
     bool in_whitespace=false;
     bool first_sb=true;
-    for(const auto& out_sym: output)
+    for(const auto& out_sym: ws->translation.output)
       {
-        if(in_it==input.end() || out_sym!=*in_it)
+        if(in_pos==chars.size() || !tok_output_matches_input(*ws,out_sym,in_pos))
           {
             if(name.empty())
               throw tokenization_error("");
             if(out_tok_it==in_rel.end())
               throw tokenization_error(name);
-            append_subtoken(*out_tok_it, name, out_sym);
+            append_subtoken(*out_tok_it, name, get_tok_output_name(*ws,out_sym));
             name.clear();
             out_tok_it=in_tok_it;
             continue;
           }
-        ++in_it;
-        if(out_sym==eb)
+        utf8::uint32_t c=chars[in_pos];
+        ++in_pos;
+        if(c==tok_eb_char)
           {
             in_whitespace=true;
             continue;
               }
-        if(out_sym==br)
+        if(c==tok_br_char)
           continue;
-        if(out_sym==sb)
+        if(c==tok_sb_char)
           {
             in_whitespace=false;
             if(first_sb)
@@ -1272,15 +1416,113 @@ else
           }
         if(in_whitespace && name.empty())
           continue;
-        name.append(out_sym);
+        utf8::append(c,std::back_inserter(name));
   }
     if(!name.empty())
       throw tokenization_error(name);
   }
 
+  language::tok_workspace_lease::tok_workspace_lease(const language& lang_):
+    lang(lang_)
+  {
+    {
+      threading::lock l(lang.tok_workspace_mutex);
+      if(!lang.free_tok_workspaces.empty())
+        {
+          workspace=std::move(lang.free_tok_workspaces.back());
+          lang.free_tok_workspaces.pop_back();
+        }
+    }
+    if(workspace)
+      workspace->clear();
+    else
+      workspace.reset(new tok_workspace);
+  }
+
+  language::tok_workspace_lease::~tok_workspace_lease()
+  {
+    threading::lock l(lang.tok_workspace_mutex);
+    lang.free_tok_workspaces.push_back(std::move(workspace));
+  }
+
+  void language::append_tok_input(tok_workspace& ws,utf8::uint32_t c,fst::symbol_id id) const
+  {
+    ws.chars.push_back(c);
+    ws.translation.input.push_back(id);
+  }
+
+  void language::append_tok_input(tok_workspace& ws,const std::string& text) const
+  {
+    std::string::const_iterator it=text.begin();
+    while(it!=text.end())
+      {
+        utf8::uint32_t c=utf8::next(it,text.end());
+        append_tok_input(ws,c,tok_fst.get_symbol_id(c));
+      }
+  }
+
+  bool language::tok_output_matches_input(const tok_workspace& ws,const fst::id_translation::output_symbol& o,std::size_t input_pos) const
+  {
+    if(o.id==fst::copy_symbol)
+      return (ws.chars[o.input_pos]==ws.chars[input_pos]);
+    fst::symbol_id input_id=ws.translation.input[input_pos];
+    return ((input_id!=fst::copy_symbol)&&(input_id==o.id));
+  }
+
+  bool language::is_tok_output_char(const tok_workspace& ws,const fst::id_translation::output_symbol& o) const
+  {
+    if(o.id==fst::copy_symbol)
+      return (ws.chars[o.input_pos]<tok_sb_char);
+    return tok_fst.is_single_char_symbol(o.id);
+  }
+
+  const std::string& language::get_tok_output_name(tok_workspace& ws,const fst::id_translation::output_symbol& o) const
+  {
+    static const std::string sb("sb"),eb("eb"),br("br"),eos("eos");
+    if(o.id!=fst::copy_symbol)
+      return tok_fst.get_symbol_name(o.id);
+    utf8::uint32_t c=ws.chars[o.input_pos];
+    switch(c)
+      {
+      case tok_sb_char:
+        return sb;
+      case tok_eb_char:
+        return eb;
+      case tok_br_char:
+        return br;
+      case tok_eos_char:
+        return eos;
+      default:
+        ws.output_name.clear();
+        utf8::append(c,std::back_inserter(ws.output_name));
+        return ws.output_name;
+      }
+  }
+
+  std::shared_ptr<const userdict::dict> language::load_userdict() const
+  {
+    return std::make_shared<userdict::dict>(get_info());
+  }
+
+  std::shared_ptr<const userdict::dict> language::get_userdict() const
+  {
+    if(const setting_values* values=setting_values::get_active())
+      {
+        std::shared_ptr<const void> obj=values->get_object(this);
+        if(obj)
+          return std::static_pointer_cast<const userdict::dict>(obj);
+      }
+    return std::atomic_load(&udict);
+  }
+
+  void language::set_userdict(const std::shared_ptr<const userdict::dict>& new_udict) const
+  {
+    std::atomic_store(&udict,new_udict);
+  }
+
   void language::do_text_analysis(utterance& u) const
   {
-    udict.apply_rules(u);
+    get_userdict()->apply_rules(u);
     relation& tokstruct_rel=u.get_relation("TokStructure",true);
     relation& word_rel=u.add_relation("Word");
     for(relation::iterator parent_token_iter=tokstruct_rel.begin();parent_token_iter!=tokstruct_rel.end();++parent_token_iter)
@@ -1734,6 +1976,77 @@ if(!pg2p_fst->translate(in_syms.begin(), in_syms.end(), std::back_inserter(out_s
     post_lex(u);
   }
 
+  void language::precompute_positional_features(utterance& u) const
+  {
+    relation& phrase_rel=u.get_relation("Phrase");
+    const unsigned int num_phrases=std::distance(phrase_rel.begin(),phrase_rel.end());
+    std::vector<item*> words,syls,segs;
+    unsigned int phrase_index=0;
+    for(relation::iterator phrase_iter=phrase_rel.begin();phrase_iter!=phrase_rel.end();++phrase_iter,++phrase_index)
+      {
+        item& phrase=*phrase_iter;
+        phrase.set("phrases_in",phrase_index);
+        phrase.set("phrases_out",num_phrases-phrase_index-1);
+        words.clear();
+        syls.clear();
+        for(item::iterator word_iter=phrase.begin();word_iter!=phrase.end();++word_iter)
+          {
+            words.push_back(&*word_iter);
+            item& word_with_syls=word_iter->as("SylStructure");
+            const std::size_t first_syl=syls.size();
+            for(item::iterator syl_iter=word_with_syls.begin();syl_iter!=word_with_syls.end();++syl_iter)
+              {
+                syls.push_back(&*syl_iter);
+                segs.clear();
+                for(item::iterator seg_iter=syl_iter->begin();seg_iter!=syl_iter->end();++seg_iter)
+                  segs.push_back(&*seg_iter);
+                const unsigned int num_phones=segs.size();
+                for(unsigned int i=0;i<num_phones;++i)
+                  {
+                    segs[i]->set("pos_in_syl",i);
+                    segs[i]->set("pos_in_syl_bw",num_phones-i-1);
+                  }
+                syl_iter->set("syl_numphones",num_phones);
+              }
+            const unsigned int num_syls=syls.size()-first_syl;
+            for(unsigned int i=0;i<num_syls;++i)
+              {
+                syls[first_syl+i]->set("pos_in_word",i);
+                syls[first_syl+i]->set("pos_in_word_bw",num_syls-i-1);
+              }
+            word_iter->set("word_numsyls",num_syls);
+          }
+        phrase.set("phrase_numwords",static_cast<unsigned int>(words.size()));
+        phrase.set("phrase_numsyls",static_cast<unsigned int>(syls.size()));
+        const unsigned int num_words=words.size();
+        for(unsigned int i=0;i<num_words;++i)
+          {
+            words[i]->set("pos_in_phrase",i);
+            words[i]->set("words_out",num_words-i-1);
+          }
+        set_sequence_features(words,"gpos","content","content_words_in","content_words_out","dist_to_prev_content_word","dist_to_next_content_word");
+        const unsigned int num_syls=syls.size();
+        for(unsigned int i=0;i<num_syls;++i)
+          {
+            syls[i]->set("syl_in",i);
+            syls[i]->set("syl_out",num_syls-i-1);
+          }
+        set_sequence_features(syls,"stress","1","ssyl_in","ssyl_out","dist_to_prev_ssyl","dist_to_next_ssyl");
+        set_sequence_features(syls,"accented","1","asyl_in","asyl_out","dist_to_prev_asyl","dist_to_next_asyl");
+      }
+    const relation& syl_rel=u.get_relation("Syllable");
+    const unsigned int num_syls=std::distance(syl_rel.begin(),syl_rel.end());
+    const relation& word_rel=u.get_relation("Word");
+    const unsigned int num_words=std::distance(word_rel.begin(),word_rel.end());
+    relation& seg_rel=u.get_relation("Segment");
+    for(relation::iterator seg_iter=seg_rel.begin();seg_iter!=seg_rel.end();++seg_iter)
+      {
+        seg_iter->set("utt_numsyls",num_syls);
+        seg_iter->set("utt_numwords",num_words);
+        seg_iter->set("utt_numphrases",num_phrases);
+      }
+  }
+
   void language::stress_monosyllabic_words(utterance& u) const
   {
     relation& rel=u.get_relation("SylStructure");
@@ -1868,7 +2181,37 @@ const language* language::get_item_second_language(const item& i) const
         std::shared_ptr<language_info> lang=(it2->second)->create(*it1,path::join(userdict_path,desc.name));
         lang->all_languages=this;
         add(lang,ver);
+        index_codes(*lang);
+      }
+  }
+
+  void language_list::index_codes(const language_info& lang)
+  {
+    if(!lang.get_alpha2_code().empty())
+      names_by_code[lang.get_alpha2_code()].insert(lang.get_name());
+    if(!lang.get_alpha3_code().empty())
+      names_by_code[lang.get_alpha3_code()].insert(lang.get_name());
+  }
+
+  language_list::const_iterator language_list::find(const language_search_criteria& criteria) const
+  {
+    if(!criteria.get_name().empty())
+      {
+        const_iterator it=find(criteria.get_name());
+        return ((it!=end())&&criteria(*it))?it:end();
+      }
+    if(criteria.get_code().empty())
+      return begin();
+    std::map<std::string,std::set<std::string,str::less>,str::less>::const_iterator pos=names_by_code.find(criteria.get_code());
+    if(pos==names_by_code.end())
+      return end();
+    for(std::set<std::string,str::less>::const_iterator it=pos->second.begin();it!=pos->second.end();++it)
+      {
+        const_iterator lang=find(*it);
+        if(lang!=end())
+          return lang;
       }
+    return end();
   }
 
   bool language_search_criteria::operator()(const language_info& info) const
@@ -13,6 +13,7 @@
 /* You should have received a copy of the GNU Lesser General Public License */
 /* along with this program.  If not, see <https://www.gnu.org/licenses/>. */
 
+#include <algorithm>
 #include "core/limiter.hpp"
 
 namespace RHVoice
@@ -20,44 +21,62 @@ namespace RHVoice
   limiter::limiter(double volume):
     threshold(-amp2db(volume)-1),
     ratio(-threshold),
-    slope(1.0-(1.0/ratio))
+    slope(1.0-(1.0/ratio)),
+    threshold_amp(std::pow(10.0,threshold/20.0)),
+    window_size(1),
+    in_pos(0),
+    out_pos(0)
   {
   }
 
-  void limiter::process_sample()
+  void limiter::initialize(sample_rate_t sr)
   {
-    sample_type s=window.front();
-    sample_type v=*(ordering.rbegin());
-    window.pop();
-    ordering.erase(ordering.find(std::abs(s)));
-    output.push_back(s*compute_gain(env_comp(v)));
+    window_size=std::max<std::size_t>(1,static_cast<std::size_t>(0.005*sr));
+    window.assign(window_size,0);
+    peaks.clear();
+    in_pos=0;
+    out_pos=0;
+    env_comp.init(sr);
 }
 
-  void limiter::do_initialize()
+  float limiter::release_sample()
   {
-    window_size=static_cast<std::size_t>(0.005*sample_rate);
-    env_comp.init(sample_rate);
+    const float s=window[out_pos%window_size];
+    const float v=std::abs(window[peaks.front()%window_size]);
+    if(peaks.front()==out_pos)
+      peaks.pop_front();
+    ++out_pos;
+    return s*compute_gain(env_comp(v));
 }
 
-  void limiter::on_input()
+  std::size_t limiter::process(const float* in,std::size_t count,float* out)
   {
-    sample_type s;
-    for(buffer_type::const_iterator it=input.begin();it!=input.end();++it)
+    std::size_t n=0;
+    for(std::size_t i=0;i<count;++i)
       {
-        s=*it;
-        window.push(s);
-        ordering.insert(std::abs(s));
-        if(window.size()<window_size)
+        const float s=in[i];
+        const float a=std::abs(s);
+        while(!peaks.empty()&&(std::abs(window[peaks.back()%window_size])<=a))
+          peaks.pop_back();
+        window[in_pos%window_size]=s;
+        peaks.push_back(in_pos);
+        ++in_pos;
+        if(in_pos-out_pos<window_size)
           continue;
-        process_sample();
+        out[n]=release_sample();
+        ++n;
 }
+    return n;
 }
 
-  void limiter::on_end_of_input()
+  std::size_t limiter::flush(float* out)
   {
-    while(!window.empty())
+    std::size_t n=0;
+    while(out_pos!=in_pos)
       {
-        process_sample();
+        out[n]=release_sample();
+        ++n;
 }
+    return n;
   }
 }
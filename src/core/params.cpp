@@ -163,5 +163,20 @@ namespace RHVoice
   {
     cfg.register_setting(fixed_size);
     cfg.register_setting(view_size);
+    cfg.register_setting(first_view_size);
+    cfg.register_setting(max_fixed_size);
+    cfg.register_setting(gv_iterations_min);
+    cfg.register_setting(gv_iterations_std);
+    cfg.register_setting(gv_iterations_max);
+    cfg.register_setting(gv_tolerance_min);
+    cfg.register_setting(gv_tolerance_std);
+    cfg.register_setting(pitch_look_ahead);
+    cfg.register_setting(parallel_generation);
+  }
+
+  void engine_pool_params::register_self(config& cfg)
+  {
+    cfg.register_setting(memory_limit);
+    cfg.register_setting(min_idle);
   }
 }
@@ -49,31 +49,66 @@ namespace RHVoice
       return res;
 }
 
+  void stylizer::sift_up(stylizer::state_t& s,std::size_t k) const
+  {
+    while(k>0)
+      {
+        const std::size_t parent=(k-1)/2;
+        if(!heap_less(s,k,parent))
+          break;
+        heap_swap(s,k,parent);
+        k=parent;
+}
+}
+
+  void stylizer::sift_down(stylizer::state_t& s,std::size_t k) const
+  {
+    const std::size_t n=s.heap.size();
+    while(true)
+      {
+        std::size_t smallest=k;
+        const std::size_t left=2*k+1;
+        const std::size_t right=left+1;
+        if(left<n&&heap_less(s,left,smallest))
+          smallest=left;
+        if(right<n&&heap_less(s,right,smallest))
+          smallest=right;
+        if(smallest==k)
+          break;
+        heap_swap(s,k,smallest);
+        k=smallest;
+}
+}
+
+  void stylizer::update_distance(stylizer::state_t& s,std::size_t i) const
+  {
+    point_t& p=s.points[i];
+    set_distance(s,i,p.prev_index,p.next_index);
+    sift_up(s,p.heap_pos);
+    sift_down(s,p.heap_pos);
+}
+
   void stylizer::remove_point(stylizer::state_t& s) const
   {
-    const std::size_t i=s.dists.begin()->index;
-    s.dists.erase(s.dists.begin());
+    const std::size_t i=s.heap.front();
+    heap_swap(s,0,s.heap.size()-1);
+    s.heap.pop_back();
+    if(!s.heap.empty())
+      sift_down(s,0);
     const point_t& p=s.points[i];
     point_t& pl=s.points[p.prev_index];
     point_t& pr=s.points[p.next_index];
     pl.next_index=pr.index;
     pr.prev_index=pl.index;
     if(pl.index>0)
-      {
-        s.dists.erase(dist_t(pl));
-        set_distance(s,pl.index,pl.prev_index,pl.next_index);
-        s.dists.insert(dist_t(pl));
-          }
+      update_distance(s,pl.index);
     if(pr.index<(s.points.size()-1))
-      {
-        s.dists.erase(dist_t(pr));
-        set_distance(s,pr.index,pr.prev_index,pr.next_index);
-        s.dists.insert(dist_t(pr));
-          }
+      update_distance(s,pr.index);
 }
 
     target_list_t targets_spec_parser::parse(const std::string& spec) const
     {
+      std::lock_guard<std::mutex> cache_lock(cache_mutex);
       cache_t::const_iterator it=cache.find(spec);
       if(it!=cache.end())
         return it->second;
@@ -121,7 +156,8 @@ namespace RHVoice
     editor::editor():
       ling_spec(0),
       base_extractor(threshold),
-      key(lzero)
+      key(lzero),
+      look_ahead(0)
     {
 }
 
@@ -173,6 +209,28 @@ namespace RHVoice
         on_end_of_segment();
       if(can_return_orig_value())
         res_values.push_back(orig_values.back());
+      if(look_ahead==0)
+        return;
+      while((orig_values.size()-res_values.size())>look_ahead)
+        release_next_value();
+}
+
+    void editor::release_next_value()
+    {
+      const std::size_t i=res_values.size();
+      if(!is_voiced(i)||i>=base_values.size()||base_values[i]==lzero)
+        {
+          res_values.push_back(orig_values[i]);
+          return;
+}
+      // The target contour is known here, but the rest of the voiced
+      // interval is not, so follow the contour without the original
+      // micro-variation
+      const double b=get_orig_base_value(i);
+      if(b==lzero)
+        res_values.push_back(base_values[i]);
+      else
+        res_values.push_back(base_values[i]+(orig_values[i]-b));
 }
 
     void editor::on_end_of_voiced_interval()
@@ -359,7 +417,12 @@ namespace RHVoice
     {
       std::size_t i=res_values.size();
       if(i>=base_values.size())
-        return;
+        {
+          // Frames released early may already have passed the end of
+          // the base values
+          if(look_ahead==0||mod_flag)
+            return;
+}
       double b;
       for(;i<base_values.size();++i)
         {
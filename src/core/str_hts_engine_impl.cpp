@@ -16,11 +16,14 @@
 #include <cmath>
 #include <cstdlib>
 #include <iterator>
+#include <algorithm>
+#include <fstream>
 #include "core/io.hpp"
 #include "core/str_hts_engine_impl.hpp"
 #include "core/voice.hpp"
 #include "core/pitch.hpp"
 #include "core/model_answer_cache.hpp"
+#include "core/worker_pool.hpp"
 #include "HTS_engine.h"
 
 extern "C"
@@ -55,6 +58,18 @@ HTS_Boolean HTS_PStreamSet_get_msd_flag(HTS_PStreamSet * pss, size_t stream_inde
 
 namespace RHVoice
 {
+  namespace
+  {
+    std::size_t get_file_size(const std::string& file_path)
+    {
+      std::ifstream f;
+      io::open_ifstream(f,file_path,true);
+      f.seekg(0,std::ios::end);
+      const std::streamoff size=f.tellg();
+      return (size>0)?static_cast<std::size_t>(size):0;
+    }
+  }
+
   str_hts_engine_impl::str_hts_engine_impl(const voice_info& info):
     hts_engine_impl("stream",info)
   {
@@ -88,6 +103,7 @@ namespace RHVoice
     HTS_Engine_set_msd_threshold(engine.get(), 1, voicing);
     HTS_Engine_set_audio_buff_size(engine.get(),HTS_Engine_get_fperiod(engine.get()));
     base_frame_shift=HTS_Engine_get_fperiod(engine.get());
+    memory_size=get_file_size(voice_path);
   }
 
   str_hts_engine_impl::~str_hts_engine_impl()
@@ -100,55 +116,106 @@ namespace RHVoice
   {
     const auto& stream_settings=info.get_stream_settings();
     fixed_size=stream_settings.fixed_size;
-    view_size=stream_settings.view_size;
+    view_size=std::max<std::size_t>(stream_settings.view_size,fixed_size);
+    base_fixed_size=fixed_size;
+    max_fixed_size=std::max<std::size_t>(stream_settings.max_fixed_size,fixed_size);
+    // The labels finished in the first view must fit in it
+    first_view_size=std::max<std::size_t>(std::min<std::size_t>(stream_settings.first_view_size,view_size),fixed_size);
+    start_time=std::chrono::steady_clock::now();
+    set_gv_iteration(stream_settings);
+    RHVoice_worker_pool_t pool={0};
+    if(stream_settings.parallel_generation)
+      pool=worker_pool::get_shared().get_c_pool();
+    HTS_Engine_set_worker_pool(engine.get(),pool);
+    pitch_editor.set_look_ahead(stream_settings.pitch_look_ahead);
     model_answer_cache answer_cache{&engine->ms};
+    if(cancellation)
+      HTS_Engine_set_cancellation_token(engine.get(),cancellation->get_c_token());
     set_speed();
     queue_labels();
     vocoder.init(engine.get(), &pitch_editor, pitch_shift);
+    if(offline)
+      vocoder.set_worker_pool(&worker_pool::get_shared());
     while(fill_lab_view())
       {
         HTS_Engine_refresh(engine.get());
-        if(!HTS_Engine_generate_state_sequence_from_strings(engine.get(),lab_view.data(), lab_view.size(), dur_mods.data()))
+        if(!HTS_Engine_generate_state_sequence_from_strings(engine.get(),lab_names.data()+view_start, view_end-view_start, dur_mods.data()+view_start))
+          {
+            if(is_cancelled())
+              return;
       throw synthesis_error();
-if(output->is_stopped())
+          }
+if(should_stop())
       return;
     restore_params();
 
     if(!HTS_Engine_generate_parameter_sequence(engine.get()))
+      {
+        if(is_cancelled())
+          return;
       throw synthesis_error();
-if(output->is_stopped())
+      }
+if(should_stop())
       return;
     set_frame_ranges();
     set_label_timing();
         save_params();
     vocoder.synth(first_frame, num_frames);
-    if(output->is_stopped())
+    if(should_stop())
       return;
     const auto drop_size=first_iter?(fixed_size-1):fixed_size;
-        if(lab_view.size() <= drop_size)
+        if(view_end-view_start <= drop_size)
           break;
-        if(drop_size>0)
-          {
-            lab_view.erase(lab_view.cbegin(), lab_view.cbegin()+drop_size);
-            dur_mods.erase(dur_mods.cbegin(), dur_mods.cbegin()+drop_size);
-            engine->extra.view_pos_in_utt+=drop_size;
-          }
+        view_start+=drop_size;
+        engine->extra.view_pos_in_utt+=drop_size;
         first_iter=false;
         first_frame_in_utt+=num_frames;
+        resize_views();
       }
     vocoder.finish();
   }
 
+  void str_hts_engine_impl::do_predict_timing()
+  {
+    set_speed();
+    queue_labels();
+    // The durations do not depend on the neighbouring views, so the
+    // whole utterance is processed at once, and neither the
+    // parameters nor the speech are generated
+    const auto n=lab_names.size();
+    for(std::size_t i=0;i<n;++i)
+      input->get_label_name(i);
+    for(std::size_t i=0;i<n;++i)
+      lab_names[i]=const_cast<char*>(input->get_label_name(i));
+    view_end=n;
+    HTS_Engine_refresh(engine.get());
+    if(cancellation)
+      HTS_Engine_set_cancellation_token(engine.get(),cancellation->get_c_token());
+    if(!HTS_Engine_generate_state_sequence_from_strings(engine.get(),lab_names.data(),n,dur_mods.data()))
+      {
+        if(is_cancelled())
+          return;
+      throw synthesis_error();
+      }
+    const auto total_states=HTS_Engine_get_total_state(engine.get());
+    num_frames=0;
+    for(std::size_t i=0;i<total_states;++i)
+      num_frames+=HTS_Engine_get_state_duration(engine.get(),i);
+    set_label_timing();
+  }
+
   void str_hts_engine_impl::do_reset()
   {
     HTS_Engine_set_stop_flag(engine.get(),false);
+    RHVoice_cancellation_token_t no_token={0};
+    HTS_Engine_set_cancellation_token(engine.get(),no_token);
     HTS_Engine_set_fperiod(engine.get(), base_frame_shift);
     HTS_Engine_refresh(engine.get());
     HTS_Engine_add_half_tone(engine.get(),0);
-    while(!lab_queue.empty())
-      lab_queue.pop();
-    lab_view.clear();
+    lab_names.clear();
     dur_mods.clear();
+    view_start=0;
+    view_end=0;
     vocoder.clear();
     for(auto& v: par_mem)
       {
@@ -167,29 +234,36 @@ if(output->is_stopped())
 
   void str_hts_engine_impl::queue_labels()
   {
-    if(input->lbegin()==input->lend())
+    const std::size_t n=input->label_count();
+    if(n==0)
       throw synthesis_error();
-    for(label_sequence::const_iterator it=input->lbegin();it!=input->lend();++it)
+    lab_names.assign(n,0);
+    dur_mods.assign(n,1);
+    for(std::size_t i=0;i<n;++i)
       {
-        auto& lab=*it;
-        lab_queue.push(&lab);
+        const item& seg=input->get_label(i).get_segment();
+        if(seg.has_feature("dur_mod"))
+          dur_mods[i]=seg.get("dur_mod").as<double>();
       }
+    view_start=0;
+    view_end=0;
   }
 
   bool str_hts_engine_impl::fill_lab_view()
   {
-    if(lab_queue.empty())
+    if(all_labels_in_view())
       return false;
-    const auto target_size=(quality==quality_max)?lab_queue.size():(first_iter?view_size:(view_size+1));
-    while(!lab_queue.empty() && lab_view.size() < target_size)
-      {
-        auto& lab=*(lab_queue.front());
-        lab_view.push_back(const_cast<char*>(lab.get_name().c_str()));
-        dur_mods.push_back(1);
-        if(lab.get_segment().has_feature("dur_mod"))
-          dur_mods.back()=lab.get_segment().get("dur_mod").as<double>();
-        lab_queue.pop();        
-      }
+    const auto n=lab_names.size();
+    std::size_t new_end=n;
+    if(quality!=quality_max)
+      new_end=std::min(n,std::max(view_end,view_start+(first_iter?first_view_size:(view_size+1))));
+    // Adding names may move the buffer, so only take the pointers
+    // when all of them are there
+    for(auto i=view_end;i<new_end;++i)
+      input->get_label_name(i);
+    view_end=new_end;
+    for(auto i=view_start;i<view_end;++i)
+      lab_names[i]=const_cast<char*>(input->get_label_name(i));
     return true;
   }
 
@@ -201,7 +275,7 @@ if(output->is_stopped())
     num_voiced_frames=0;
     num_voiced_mem_frames=0;
     const auto total_frames=HTS_PStreamSet_get_total_frame(&engine->pss);
-    if(first_iter && lab_queue.empty())
+    if(first_iter && all_labels_in_view())
       {
         num_frames=total_frames;
         return;
@@ -210,7 +284,7 @@ if(output->is_stopped())
     const auto total_states=HTS_Engine_get_total_state(engine.get());
     const std::size_t skip_states=first_iter?0:ns;
     const auto view_states=total_states-skip_states;
-    const auto fixed_states=lab_queue.empty()?view_states:std::min(fixed_size*ns, view_states);
+    const auto fixed_states=all_labels_in_view()?view_states:std::min(fixed_size*ns, view_states);
     for(auto i=0;i<skip_states;++i)
       {
         const auto d=HTS_Engine_get_state_duration(engine.get(), i);
@@ -222,7 +296,7 @@ if(output->is_stopped())
         num_frames+=d;
         
       }
-    if(lab_queue.empty())
+    if(all_labels_in_view())
       return;
     const auto last_frame=first_frame+num_frames-1;
     for(auto i=1; i<=ns; ++i)
@@ -263,6 +337,8 @@ if(output->is_stopped())
              len+=HTS_Engine_get_state_duration(engine.get(), fs+i);
            lab->set_length(len);
            lab->set_duration(len*fp);
+           if(lab->get_segment().get("name").as<std::string>()=="pau")
+             vocoder.add_pause(pos, len);
            pos+=len;
            ++lab;
            fs+=ns;
@@ -271,7 +347,7 @@ if(output->is_stopped())
 
   void str_hts_engine_impl::save_params()
   {
-    if(lab_queue.empty())
+    if(all_labels_in_view())
       return;
     const auto nstr=HTS_Engine_get_nstream(engine.get());
   for(auto i=0; i<nstr; ++i)
@@ -307,6 +383,25 @@ if(output->is_stopped())
           }
   }
 
+  // While the speech is not ahead of the client by at least one
+  // buffer, each view finishes as few labels as possible. Otherwise
+  // the views grow: the generation has more context and costs less
+  // per label.
+  void str_hts_engine_impl::resize_views()
+  {
+    if(audio_buffer_size==0)
+      return;
+    const double frame_length=static_cast<double>(HTS_Engine_get_fperiod(engine.get()))/HTS_Engine_get_sampling_frequency(engine.get());
+    const std::chrono::duration<double> elapsed=std::chrono::steady_clock::now()-start_time;
+    const double lead=first_frame_in_utt*frame_length-elapsed.count();
+    const auto look_ahead=view_size-fixed_size;
+    if(lead>audio_buffer_size/1000.0)
+      fixed_size=std::min(max_fixed_size,2*fixed_size);
+    else
+      fixed_size=base_fixed_size;
+    view_size=fixed_size+look_ahead;
+  }
+
   void str_hts_engine_impl::set_speed()
   {
     if(rate==1)
@@ -315,6 +410,22 @@ if(output->is_stopped())
     HTS_Engine_set_fperiod(engine.get(),frame_shift);
   }
 
+  void str_hts_engine_impl::set_gv_iteration(const stream_params& stream_settings)
+  {
+    switch(quality)
+      {
+      case quality_min:
+        HTS_Engine_set_gv_iteration(engine.get(),stream_settings.gv_iterations_min,stream_settings.gv_tolerance_min);
+        break;
+      case quality_max:
+        HTS_Engine_set_gv_iteration(engine.get(),stream_settings.gv_iterations_max,0);
+        break;
+      default:
+        HTS_Engine_set_gv_iteration(engine.get(),stream_settings.gv_iterations_std,stream_settings.gv_tolerance_std);
+        break;
+      }
+  }
+
   void str_hts_engine_impl::do_stop()
   {
     HTS_Engine_set_stop_flag(engine.get(),TRUE);
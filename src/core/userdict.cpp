@@ -514,11 +514,211 @@ struct result_t
       utf8::utf8to32(text.begin(),text.end(),std::back_inserter(source));
     }
 
+    rule_matcher::rule_matcher():
+      compiled(false)
+    {
+    }
+
+    void rule_matcher::add(const rule& r)
+    {
+      if(compiled)
+        throw std::logic_error("Rules cannot be added after the matcher has been compiled");
+      entry e;
+      e.key=r.get_key();
+      if(e.key.empty())
+        return;
+      e.value=r;
+      e.caseless=true;
+      for(chars32::const_iterator it=e.key.begin();it!=e.key.end();++it)
+        {
+          if(fold(*it)!=*it)
+            {
+              e.caseless=false;
+              break;
+            }
+        }
+      entries.push_back(e);
+    }
+
+    void rule_matcher::compile()
+    {
+      std::vector<chars32> folded_keys(entries.size());
+      std::vector<std::size_t> order(entries.size());
+      for(std::size_t i=0;i<entries.size();++i)
+        {
+          order[i]=i;
+          folded_keys[i].reserve(entries[i].key.size());
+          std::transform(entries[i].key.begin(),entries[i].key.end(),std::back_inserter(folded_keys[i]),fold);
+        }
+      std::sort(order.begin(),order.end(),
+                [this,&folded_keys](std::size_t i1,std::size_t i2)
+                {
+                  if(folded_keys[i1]!=folded_keys[i2])
+                    return (folded_keys[i1]<folded_keys[i2]);
+                  if(entries[i1].key!=entries[i2].key)
+                    return (entries[i1].key<entries[i2].key);
+                  return (i1<i2);
+                });
+      std::vector<entry> sorted_entries;
+      sorted_entries.reserve(entries.size());
+      std::vector<std::size_t> entry_states;
+      entry_states.reserve(entries.size());
+      typedef std::vector<std::pair<utf8::uint32_t,std::size_t> > child_list;
+      std::vector<child_list> children(1);
+      std::vector<std::size_t> path(1,0);
+      const chars32* prev_key=0;
+      for(std::size_t i=0;i<order.size();++i)
+        {
+          const entry& e=entries[order[i]];
+          if((i+1<order.size())&&(entries[order[i+1]].key==e.key))
+            continue;
+          const chars32& key=folded_keys[order[i]];
+          std::size_t common=0;
+          if(prev_key!=0)
+            for(;(common<key.size())&&(common<prev_key->size())&&(key[common]==(*prev_key)[common]);++common);
+          path.resize(common+1);
+          for(std::size_t j=common;j<key.size();++j)
+            {
+              children[path.back()].push_back(std::make_pair(key[j],children.size()));
+              path.push_back(children.size());
+              children.push_back(child_list());
+            }
+          sorted_entries.push_back(e);
+          entry_states.push_back(path.back());
+          prev_key=&key;
+        }
+      entries.swap(sorted_entries);
+      states.assign(children.size(),state());
+      transitions.clear();
+      for(std::size_t s=0;s<children.size();++s)
+        {
+          state& st=states[s];
+          st.first_transition=transitions.size();
+          for(child_list::const_iterator it=children[s].begin();it!=children[s].end();++it)
+            {
+              transition t;
+              t.label=it->first;
+              t.target=it->second;
+              transitions.push_back(t);
+            }
+          st.last_transition=transitions.size();
+          st.first_entry=st.last_entry=0;
+          st.failure=0;
+          st.output=0;
+        }
+      for(std::size_t i=0;i<entry_states.size();++i)
+        {
+          state& st=states[entry_states[i]];
+          if(st.first_entry==st.last_entry)
+            st.first_entry=i;
+          st.last_entry=i+1;
+        }
+      // The breadth-first order guarantees that the failure targets
+      // are complete before they are used
+      std::vector<std::size_t> queue;
+      queue.reserve(states.size());
+      for(std::size_t i=states[0].first_transition;i<states[0].last_transition;++i)
+        queue.push_back(transitions[i].target);
+      for(std::size_t q=0;q<queue.size();++q)
+        {
+          const state& parent=states[queue[q]];
+          for(std::size_t i=parent.first_transition;i<parent.last_transition;++i)
+            {
+              state& child=states[transitions[i].target];
+              child.failure=get_next_state(parent.failure,transitions[i].label);
+              const state& failure=states[child.failure];
+              child.output=(failure.first_entry!=failure.last_entry)?child.failure:failure.output;
+              queue.push_back(transitions[i].target);
+            }
+        }
+      compiled=true;
+    }
+
+    std::size_t rule_matcher::get_next_state(std::size_t s,utf8::uint32_t c) const
+    {
+      while(true)
+        {
+          const state& st=states[s];
+          std::vector<transition>::const_iterator first=transitions.begin()+st.first_transition;
+          std::vector<transition>::const_iterator last=transitions.begin()+st.last_transition;
+          std::vector<transition>::const_iterator it=std::lower_bound(first,last,c,[](const transition& t,utf8::uint32_t l){return (t.label<l);});
+          if((it!=last)&&(it->label==c))
+            return it->target;
+          if(s==0)
+            return 0;
+          s=st.failure;
+        }
+    }
+
+    bool rule_matcher::matches(const entry& e,const chars32& text,std::size_t start) const
+    {
+      if(e.caseless)
+        return true;
+      for(std::size_t i=0;i<e.key.size();++i)
+        {
+          utf8::uint32_t c=text[start+i];
+          if((e.key[i]!=c)&&(e.key[i]!=fold(c)))
+            return false;
+        }
+      return true;
+    }
+
+    bool rule_matcher::is_better(const entry& e1,const entry& e2,const chars32& text,std::size_t start) const
+    {
+      std::size_t n=std::min(e1.key.size(),e2.key.size());
+      std::size_t i=0;
+      for(;(i<n)&&(e1.key[i]==e2.key[i]);++i);
+      // Both keys match here, so only one of them has the case of the text
+      if(i<n)
+        return (e1.key[i]==text[start+i]);
+      if(e1.key.size()>n)
+        return (e1.key[n]==text[start+n]);
+      else
+        return (e2.key[n]!=text[start+n]);
+    }
+
+    void rule_matcher::find(const chars32& text,std::vector<match>& result) const
+    {
+      if(!compiled)
+        throw std::logic_error("The matcher must be compiled before searching");
+      match no_match;
+      no_match.matched_rule=0;
+      no_match.length=0;
+      result.assign(text.size(),no_match);
+      std::vector<const entry*> best(text.size(),0);
+      std::size_t s=0;
+      for(std::size_t i=0;i<text.size();++i)
+        {
+          s=get_next_state(s,fold(text[i]));
+          std::size_t t=(states[s].first_entry!=states[s].last_entry)?s:states[s].output;
+          for(;t!=0;t=states[t].output)
+            {
+              const state& st=states[t];
+              for(std::size_t j=st.first_entry;j<st.last_entry;++j)
+                {
+                  const entry& e=entries[j];
+                  std::size_t start=i+1-e.key.size();
+                  if(!matches(e,text,start))
+                    continue;
+                  if((best[start]==0)||is_better(e,*best[start],text,start))
+                    best[start]=&e;
+                }
+            }
+        }
+      for(std::size_t i=0;i<text.size();++i)
+        {
+          if(best[i]==0)
+            continue;
+          result[i].matched_rule=&(best[i]->value);
+          result[i].length=best[i]->key.size();
+        }
+    }
+
     dict::dict(const language_info& lng):
       lang(lng)
     {
       load_all();
-      rules.sort();
+      rules.compile();
     }
 
     void userdict::dict::load_all()
@@ -557,8 +757,7 @@ struct result_t
 	  simple.insert(result.simple.begin(), result.simple.end());
           for(ruleset::iterator it=result.rules->begin();it!=result.rules->end();++it)
             {
-              chars32 key=it->get_key();
-              rules.insert(key.begin(),key.end(),*it);
+              rules.add(*it);
             }
         }
       catch(const std::exception& e)
@@ -570,6 +769,8 @@ struct result_t
     {
       word_editor ed(utt);
       position mark,end;
+      chars32 text;
+      std::vector<rule_matcher::match> matches;
       while(ed.get_cursor()!=end)
         {
           if(should_ignore_token(ed.get_cursor()))
@@ -580,13 +781,23 @@ struct result_t
           mark=ed.get_cursor();
           mark.forward_token();
           for(;(mark!=end)&&(!should_ignore_token(mark));mark.forward_token());
-          while(ed.get_cursor()!=mark)
+          text.clear();
+          for(position pos=ed.get_cursor();pos!=mark;++pos)
+            text.push_back(*pos);
+          rules.find(text,matches);
+          // Every rule moves the cursor over exactly its key
+          for(std::size_t i=0;i<text.size();)
             {
-              std::pair<position,rule*> result=rules.search(ed.get_cursor(),mark);
-              if(result.second==0)
-                ed.forward_char();
+              if(matches[i].matched_rule==0)
+                {
+                  ed.forward_char();
+                  ++i;
+                }
               else
-                result.second->apply(ed);
+                {
+                  matches[i].matched_rule->apply(ed);
+                  i+=matches[i].length;
+                }
             }
         }
     }
@@ -26,7 +26,7 @@ namespace RHVoice
 {
   voice::voice(const voice_info& info_):
     info(info_),
-    engine_pool(info_)
+    engine_pool(info_,info_.get_engine_pool_manager())
   {
   }
 
@@ -126,6 +126,20 @@ namespace RHVoice
       }
   }
 
+  voice_list::const_iterator voice_list::find(const voice_search_criteria& criteria) const
+  {
+    const std::set<std::string,str::less>& names=criteria.get_names();
+    if(names.empty())
+      return std::find_if(begin(),end(),criteria);
+    for(std::set<std::string,str::less>::const_iterator it=names.begin();it!=names.end();++it)
+      {
+        const_iterator v=find(*it);
+        if((v!=end())&&criteria(*v))
+          return v;
+      }
+    return end();
+  }
+
   bool voice_search_criteria::operator()(const voice_info& info) const
   {
     const language_info& lang=*(info.get_language());
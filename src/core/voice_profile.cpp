@@ -0,0 +1,74 @@
+/* Copyright (C) 2026  RHVoice contributors */
+
+/* This program is free software: you can redistribute it and/or modify */
+/* it under the terms of the GNU Lesser General Public License as published by */
+/* the Free Software Foundation, either version 2.1 of the License, or */
+/* (at your option) any later version. */
+
+/* This program is distributed in the hope that it will be useful, */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+/* GNU Lesser General Public License for more details. */
+
+/* You should have received a copy of the GNU Lesser General Public License */
+/* along with this program.  If not, see <https://www.gnu.org/licenses/>. */
+
+#include <algorithm>
+#include "core/voice_profile.hpp"
+
+namespace RHVoice
+{
+  const std::size_t voice_profile::letter_index::max_voices;
+  const utf8::uint32_t voice_profile::letter_index::direct_limit;
+
+  voice_profile::letter_index::letter_index(const list& voices):
+    overlaps(voices.size(),0)
+  {
+    utf8::uint32_t direct_size=0;
+    for(list::const_iterator it=voices.begin();it!=voices.end();++it)
+      {
+        const std::set<utf8::uint32_t>& lang_letters=(*it)->get_language()->get_letters();
+        if(!lang_letters.empty())
+          {
+            utf8::uint32_t last=*(lang_letters.rbegin());
+            if(last<direct_limit)
+              direct_size=std::max(direct_size,last+1);
+            else
+              {
+                std::set<utf8::uint32_t>::const_iterator first_other=lang_letters.lower_bound(direct_limit);
+                if(first_other!=lang_letters.begin())
+                  direct_size=std::max(direct_size,*(--first_other)+1);
+              }
+          }
+      }
+    direct.assign(direct_size,0);
+    for(std::size_t i=0;i<voices.size();++i)
+      {
+        const mask bit=static_cast<mask>(1)<<i;
+        const std::set<utf8::uint32_t>& lang_letters=voices[i]->get_language()->get_letters();
+        for(std::set<utf8::uint32_t>::const_iterator it=lang_letters.begin();it!=lang_letters.end();++it)
+          {
+            if(*it<direct_size)
+              direct[*it]|=bit;
+            else
+              others[*it]|=bit;
+          }
+      }
+    for(std::vector<mask>::const_iterator it=direct.begin();it!=direct.end();++it)
+      {
+        for(std::size_t i=0;i<voices.size();++i)
+          {
+            if((*it>>i)&1)
+              overlaps[i]|=*it;
+          }
+      }
+    for(std::unordered_map<utf8::uint32_t,mask>::const_iterator it=others.begin();it!=others.end();++it)
+      {
+        for(std::size_t i=0;i<voices.size();++i)
+          {
+            if((it->second>>i)&1)
+              overlaps[i]|=it->second;
+          }
+      }
+  }
+}
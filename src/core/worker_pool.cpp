@@ -0,0 +1,114 @@
+/* Copyright (C) 2026  RHVoice contributors */
+
+/* This program is free software: you can redistribute it and/or modify */
+/* it under the terms of the GNU Lesser General Public License as published by */
+/* the Free Software Foundation, either version 2.1 of the License, or */
+/* (at your option) any later version. */
+
+/* This program is distributed in the hope that it will be useful, */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+/* GNU Lesser General Public License for more details. */
+
+/* You should have received a copy of the GNU Lesser General Public License */
+/* along with this program.  If not, see <https://www.gnu.org/licenses/>. */
+
+#include <algorithm>
+#include "core/worker_pool.hpp"
+
+namespace RHVoice
+{
+  worker_pool::worker_pool(unsigned int num_threads):
+    stopping(false)
+  {
+    for(unsigned int i=0;i<num_threads;++i)
+      threads.emplace_back(&worker_pool::work,this);
+  }
+
+  worker_pool::~worker_pool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(pool_mutex);
+      stopping=true;
+    }
+    job_available.notify_all();
+    for(std::vector<std::thread>::iterator it=threads.begin();it!=threads.end();++it)
+      it->join();
+  }
+
+  worker_pool& worker_pool::get_shared()
+  {
+    static worker_pool pool(std::max(1u,std::thread::hardware_concurrency())-1);
+    return pool;
+  }
+
+  std::size_t worker_pool::take_index(job& j)
+  {
+    std::size_t index=j.next;
+    ++j.next;
+    // Nobody must touch the job after its last part has been taken,
+    // except to report that part done
+    if(j.next==j.count)
+      jobs.erase(std::find(jobs.begin(),jobs.end(),&j));
+    return index;
+  }
+
+  void worker_pool::run(std::size_t count,const std::function<void(std::size_t)>& task)
+  {
+    if(count==0)
+      return;
+    if(threads.empty()||count==1)
+      {
+        for(std::size_t i=0;i<count;++i)
+          task(i);
+        return;
+      }
+    job j;
+    j.task=&task;
+    j.count=count;
+    j.next=0;
+    j.done=0;
+    std::unique_lock<std::mutex> lock(pool_mutex);
+    jobs.push_back(&j);
+    job_available.notify_all();
+    while(j.next<j.count)
+      {
+        std::size_t index=take_index(j);
+        lock.unlock();
+        task(index);
+        lock.lock();
+        ++j.done;
+      }
+    j.finished.wait(lock,[&j]{return (j.done==j.count);});
+  }
+
+  void worker_pool::work()
+  {
+    std::unique_lock<std::mutex> lock(pool_mutex);
+    while(true)
+      {
+        job_available.wait(lock,[this]{return (stopping||!jobs.empty());});
+        if(stopping)
+          return;
+        job& j=*jobs.front();
+        std::size_t index=take_index(j);
+        lock.unlock();
+        (*j.task)(index);
+        lock.lock();
+        ++j.done;
+        if(j.done==j.count)
+          j.finished.notify_one();
+      }
+  }
+}
+
+void RHVoice_worker_pool_run(RHVoice_worker_pool_t pool,size_t count,void (*task)(void* data,size_t index),void* data)
+{
+  if(!pool.impl)
+    {
+      for(size_t i=0;i<count;++i)
+        task(data,i);
+      return;
+    }
+  static_cast<RHVoice::worker_pool*>(pool.impl)->run(count,[task,data](std::size_t index){task(data,index);});
+}
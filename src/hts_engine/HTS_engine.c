@@ -89,9 +89,13 @@ void HTS_Engine_initialize(HTS_Engine * engine)
    engine->condition.fperiod = 0;
    engine->condition.audio_buff_size = 0;
    engine->condition.stop = FALSE;
+   engine->condition.cancel.impl = NULL;
+   engine->condition.pool.impl = NULL;
    engine->condition.volume = 1.0;
    engine->condition.msd_threshold = NULL;
    engine->condition.gv_weight = NULL;
+   engine->condition.gv_max_iteration = GV_MAX_ITERATION;
+   engine->condition.gv_tolerance = 0.0;
 
    /* duration */
    engine->condition.speed = 1.0;
@@ -242,6 +246,26 @@ HTS_Boolean HTS_Engine_get_stop_flag(HTS_Engine * engine)
    return engine->condition.stop;
 }
 
+/* HTS_Engine_set_cancellation_token: set the token which can interrupt the generation from another thread */
+void HTS_Engine_set_cancellation_token(HTS_Engine * engine, RHVoice_cancellation_token_t token)
+{
+   engine->condition.cancel = token;
+}
+
+/* HTS_Engine_set_worker_pool: set the threads which generate the streams and the blocks of their dimensions in parallel */
+void HTS_Engine_set_worker_pool(HTS_Engine * engine, RHVoice_worker_pool_t pool)
+{
+   engine->condition.pool = pool;
+}
+
+/* HTS_Engine_is_cancelled: check the stop flag and the cancellation token */
+HTS_Boolean HTS_Engine_is_cancelled(HTS_Engine * engine)
+{
+   if (engine->condition.stop)
+      return TRUE;
+   return RHVoice_cancellation_requested(engine->condition.cancel) ? TRUE : FALSE;
+}
+
 /* HTS_Engine_set_volume: set volume in db */
 void HTS_Engine_set_volume(HTS_Engine * engine, double f)
 {
@@ -284,6 +308,15 @@ double HTS_Engine_get_gv_weight(HTS_Engine * engine, size_t stream_index)
    return engine->condition.gv_weight[stream_index];
 }
 
+/* HTS_Engine_set_gv_iteration: set iteration budget and convergence tolerance of GV-based generation */
+void HTS_Engine_set_gv_iteration(HTS_Engine * engine, size_t max_iteration, double tolerance)
+{
+   if (tolerance < 0.0)
+      tolerance = 0.0;
+   engine->condition.gv_max_iteration = max_iteration;
+   engine->condition.gv_tolerance = tolerance;
+}
+
 /* HTS_Engine_set_speed: set speech speed */
 void HTS_Engine_set_speed(HTS_Engine * engine, double f)
 {
@@ -457,7 +490,7 @@ static HTS_Boolean HTS_Engine_generate_state_sequence(HTS_Engine * engine)
    double f;
 
    engine->label.view_pos_in_utt = engine->extra.view_pos_in_utt;
-   if (HTS_SStreamSet_create(&engine->sss, &engine->ms, &engine->label, engine->condition.phoneme_alignment_flag, engine->condition.speed, engine->condition.duration_iw, engine->condition.parameter_iw, engine->condition.gv_iw) != TRUE) {
+   if (HTS_SStreamSet_create(&engine->sss, &engine->ms, &engine->label, engine->condition.phoneme_alignment_flag, engine->condition.speed, engine->condition.duration_iw, engine->condition.parameter_iw, engine->condition.gv_iw, engine->condition.cancel) != TRUE) {
       HTS_Engine_refresh(engine);
       return FALSE;
    }
@@ -507,7 +540,7 @@ HTS_Boolean HTS_Engine_generate_state_sequence_from_strings(HTS_Engine * engine,
 /* HTS_Engine_generate_parameter_sequence: generate parameter sequence (2nd synthesis step) */
 HTS_Boolean HTS_Engine_generate_parameter_sequence(HTS_Engine * engine)
 {
-   return HTS_PStreamSet_create(&engine->pss, &engine->sss, engine->condition.msd_threshold, engine->condition.gv_weight);
+   return HTS_PStreamSet_create(&engine->pss, &engine->sss, engine->condition.msd_threshold, engine->condition.gv_weight, engine->condition.gv_max_iteration, engine->condition.gv_tolerance, engine->condition.pool, engine->condition.cancel);
 }
 
 /* HTS_Engine_generate_sample_sequence: generate sample sequence (3rd synthesis step) */
@@ -78,6 +78,8 @@ HTS_ENGINE_H_START;
 #include "core/bpf.h"
 #include "core/question_matcher.h"
 #include "core/model_answer_cache.h"
+#include "core/cancellation.h"
+#include "core/worker_pool.h"
 
 /* common ---------------------------------------------------------- */
 
@@ -152,6 +154,11 @@ typedef struct _HTS_Tree {
    size_t state;                /* state index of this tree */
 } HTS_Tree;
 
+/* storage formats of the PDFs of a stream */
+#define HTS_PDF_FLOAT32 0       /* float means and variances */
+#define HTS_PDF_FP16 1          /* half precision means and variances */
+#define HTS_PDF_FP16_U8 2       /* half precision means, 8-bit log variances */
+
 /* HTS_Model: set of PDFs, decision trees and questions. */
 typedef struct _HTS_Model {
    size_t vector_length;        /* vector length (static features only) */
@@ -160,6 +167,12 @@ typedef struct _HTS_Model {
    size_t ntree;                /* # of trees */
    size_t *npdf;                /* # of PDFs at each tree */
    float ***pdf;                /* PDFs */
+   size_t pdf_format;           /* storage format of the PDFs */
+   size_t pdf_record_size;      /* size of a packed PDF in bytes */
+   unsigned char **pdf_data;    /* packed PDFs of the reduced precision formats */
+   float *pdf_offset;           /* offsets of the packed means and variances */
+   float *pdf_scale;            /* scales of the packed means and variances */
+   float *vari_codebook;        /* levels of the 8-bit log variances */
    HTS_Tree *tree;              /* pointer to the list of trees */
    HTS_Question *question;      /* pointer to the list of questions */
   RHVoice_model_answer_cache_t answer_cache;
@@ -235,6 +248,14 @@ typedef struct _HTS_SStreamSet {
 
 /* pstream --------------------------------------------------------- */
 
+/* HTS_LaneMatrices: matrices/vectors for several dimensions generated together, interleaved */
+typedef struct _HTS_LaneMatrices {
+   double *wuw;                 /* W' U^-1 W */
+   double *wum;                 /* W' U^-1 mu */
+   double *g;                   /* g */
+   double *gv_wuw;              /* W' U^-1 W before factorization, kept for GV */
+} HTS_LaneMatrices;
+
 /* HTS_SMatrices: matrices/vectors used in the speech parameter generation algorithm. */
 typedef struct _HTS_SMatrices {
    double **mean;               /* mean vector sequence */
@@ -242,6 +263,8 @@ typedef struct _HTS_SMatrices {
    double *g;                   /* vector used in the forward substitution */
    double **wuw;                /* W' U^-1 W  */
    double *wum;                 /* W' U^-1 mu */
+   struct _HTS_LaneMatrices *lanes;     /* matrices of the blocks of dimensions, one per block when they run in parallel */
+   size_t nlanes;               /* number of the lane matrices */
 } HTS_SMatrices;
 
 /* HTS_PStream: individual PDF stream. */
@@ -260,6 +283,8 @@ typedef struct _HTS_PStream {
    double *gv_vari;             /* variance vector of GV */
    HTS_Boolean *gv_switch;      /* GV flag sequence */
    size_t gv_length;            /* frame length for GV calculation */
+   size_t gv_max_iteration;     /* iteration budget of GV-based generation */
+   double gv_tolerance;         /* relative change of the GV objective which ends the iterations (0: never) */
 } HTS_PStream;
 
 /* HTS_PStreamSet: set of PDF streams. */
@@ -295,9 +320,13 @@ typedef struct _HTS_Condition {
    size_t fperiod;              /* frame period */
    size_t audio_buff_size;      /* audio buffer size (for audio device) */
    HTS_Boolean stop;            /* stop flag */
+   RHVoice_cancellation_token_t cancel; /* checked between labels and streams */
+   RHVoice_worker_pool_t pool;  /* runs the parts of the parameter generation in parallel if set */
    double volume;               /* volume */
    double *msd_threshold;       /* MSD thresholds */
    double *gv_weight;           /* GV weights */
+   size_t gv_max_iteration;     /* iteration budget of GV-based generation */
+   double gv_tolerance;         /* relative change of the GV objective which ends the iterations (0: never) */
 
    /* duration */
    HTS_Boolean phoneme_alignment_flag;  /* flag for using phoneme alignment in label */
@@ -367,6 +396,15 @@ void HTS_Engine_set_stop_flag(HTS_Engine * engine, HTS_Boolean b);
 /* HTS_Engine_get_stop_flag: get stop flag */
 HTS_Boolean HTS_Engine_get_stop_flag(HTS_Engine * engine);
 
+/* HTS_Engine_set_cancellation_token: set the token which can interrupt the generation from another thread */
+void HTS_Engine_set_cancellation_token(HTS_Engine * engine, RHVoice_cancellation_token_t token);
+
+/* HTS_Engine_set_worker_pool: set the threads which generate the streams and the blocks of their dimensions in parallel */
+void HTS_Engine_set_worker_pool(HTS_Engine * engine, RHVoice_worker_pool_t pool);
+
+/* HTS_Engine_is_cancelled: check the stop flag and the cancellation token */
+HTS_Boolean HTS_Engine_is_cancelled(HTS_Engine * engine);
+
 /* HTS_Engine_set_volume: set volume in db */
 void HTS_Engine_set_volume(HTS_Engine * engine, double f);
 
@@ -385,6 +423,9 @@ void HTS_Engine_set_gv_weight(HTS_Engine * engine, size_t stream_index, double f
 /* HTS_Engine_get_gv_weight: get GV weight */
 double HTS_Engine_get_gv_weight(HTS_Engine * engine, size_t stream_index);
 
+/* HTS_Engine_set_gv_iteration: set iteration budget and convergence tolerance of GV-based generation */
+void HTS_Engine_set_gv_iteration(HTS_Engine * engine, size_t max_iteration, double tolerance);
+
 /* HTS_Engine_set_speed: set speech speed */
 void HTS_Engine_set_speed(HTS_Engine * engine, double f);
 
@@ -300,7 +300,7 @@ void HTS_Label_clear(HTS_Label * label);
 void HTS_SStreamSet_initialize(HTS_SStreamSet * sss);
 
 /* HTS_SStreamSet_create: parse label and determine state duration */
-HTS_Boolean HTS_SStreamSet_create(HTS_SStreamSet * sss, HTS_ModelSet * ms, HTS_Label * label, HTS_Boolean phoneme_alignment_flag, double speed, double *duration_iw, double **parameter_iw, double **gv_iw);
+HTS_Boolean HTS_SStreamSet_create(HTS_SStreamSet * sss, HTS_ModelSet * ms, HTS_Label * label, HTS_Boolean phoneme_alignment_flag, double speed, double *duration_iw, double **parameter_iw, double **gv_iw, RHVoice_cancellation_token_t cancel);
 
 /* HTS_SStreamSet_get_nstream: get number of stream */
 size_t HTS_SStreamSet_get_nstream(HTS_SStreamSet * sss);
@@ -384,11 +384,14 @@ void HTS_SStreamSet_clear(HTS_SStreamSet * sss);
 #define W2       1.0
 #define GV_MAX_ITERATION 5
 
+/* number of dimensions which mlpg solves together */
+#define HTS_PSTREAM_LANES 4
+
 /* HTS_PStreamSet_initialize: initialize parameter stream set */
 void HTS_PStreamSet_initialize(HTS_PStreamSet * pss);
 
 /* HTS_PStreamSet_create: parameter generation using GV weight */
-HTS_Boolean HTS_PStreamSet_create(HTS_PStreamSet * pss, HTS_SStreamSet * sss, double *msd_threshold, double *gv_weight);
+HTS_Boolean HTS_PStreamSet_create(HTS_PStreamSet * pss, HTS_SStreamSet * sss, double *msd_threshold, double *gv_weight, size_t gv_max_iteration, double gv_tolerance, RHVoice_worker_pool_t pool, RHVoice_cancellation_token_t cancel);
 
 /* HTS_PStreamSet_get_nstream: get number of stream */
 size_t HTS_PStreamSet_get_nstream(HTS_PStreamSet * pss);
@@ -501,9 +504,13 @@ typedef struct _HTS_Vocoder {
    double pitch_counter;        /* used in excitation generation */
    double pitch_inc_per_point;  /* used in excitation generation */
    double *pulses_ring_buff;    /* used in excitation generation */
-  double *noise_ring_buff;    /* used in excitation generation */
+   size_t *pulse_slots;         /* nonzero positions of the pulse ring */
+   size_t num_pulse_slots;      /* number of nonzero positions */
+   double *noise_buff;          /* noise history followed by the noise of the frame */
+   double *excite_frame;        /* excitation of the frame */
    double *pulse_filter;    /* used in excitation generation */
   double *noise_filter;    /* used in excitation generation */
+   double *band_sum;            /* sum of all band-pass filters */
    size_t excite_buff_size;     /* used in excitation generation */
    size_t excite_buff_index;    /* used in excitation generation */
    unsigned char sw;            /* switch used in random generator */
@@ -528,6 +535,9 @@ void HTS_Vocoder_initialize(HTS_Vocoder * v, size_t m, size_t stage, HTS_Boolean
 /* HTS_Vocoder_synthesize: pulse/noise excitation and MLSA/MGLSA filster based waveform synthesis */
 void HTS_Vocoder_synthesize(HTS_Vocoder * v, size_t m, double lf0, double *spectrum, double *bap, BPF* bpf, double alpha, double beta, double volume, double *rawdata, HTS_Audio * audio);
 
+/* HTS_Vocoder_synthesize_silence: output a frame of silence instead of filtering the excitation */
+void HTS_Vocoder_synthesize_silence(HTS_Vocoder * v, size_t m, double *spectrum, BPF * bpf, double alpha, HTS_Audio * audio);
+
 /* HTS_Vocoder_clear: clear vocoder */
 void HTS_Vocoder_clear(HTS_Vocoder * v);
 
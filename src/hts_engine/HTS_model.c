@@ -77,12 +77,14 @@ HTS_MODEL_C_START;
 #include <stdlib.h>             /* for atoi(),abs() */
 #include <string.h>             /* for strlen(),strstr(),strrchr(),strcmp() */
 #include <ctype.h>              /* for isdigit() */
+#include <math.h>               /* for exp() */
 
 /* hts_engine libraries */
 #include "HTS_hidden.h"
 
 #ifdef WIN32
 typedef unsigned __int32 uint32_t;
+typedef unsigned __int16 uint16_t;
 #else
 #include <stdint.h>
 #endif                          /* WIN32 */
@@ -585,6 +587,12 @@ static void HTS_Model_initialize(HTS_Model * model)
    model->ntree = 0;
    model->npdf = NULL;
    model->pdf = NULL;
+   model->pdf_format = HTS_PDF_FLOAT32;
+   model->pdf_record_size = 0;
+   model->pdf_data = NULL;
+   model->pdf_offset = NULL;
+   model->pdf_scale = NULL;
+   model->vari_codebook = NULL;
    model->tree = NULL;
    model->question = NULL;
    model->answer_cache.impl=NULL;
@@ -619,6 +627,18 @@ static void HTS_Model_clear(HTS_Model * model)
       model->pdf += 2;
       HTS_free(model->pdf);
    }
+   if (model->pdf_data) {
+      for (i = 2; i <= model->ntree + 1; i++)
+         HTS_free(model->pdf_data[i]);
+      model->pdf_data += 2;
+      HTS_free(model->pdf_data);
+   }
+   if (model->pdf_offset)
+      HTS_free(model->pdf_offset);
+   if (model->pdf_scale)
+      HTS_free(model->pdf_scale);
+   if (model->vari_codebook)
+      HTS_free(model->vari_codebook);
    if (model->npdf) {
       model->npdf += 2;
       HTS_free(model->npdf);
@@ -694,8 +714,72 @@ static HTS_Boolean HTS_Model_load_tree(HTS_Model * model, HTS_File * fp)
    return TRUE;
 }
 
+/* HTS_half_to_float: expand an IEEE 754 half precision value */
+static float HTS_half_to_float(uint16_t h)
+{
+   uint32_t bits;
+   uint32_t exponent = (h >> 10) & 0x1f;
+   uint32_t mantissa = h & 0x3ff;
+   float result;
+
+   if (exponent == 0) {
+      /* zero or subnormal */
+      result = (float) mantissa *(1.0f / 16777216.0f);
+      return (h & 0x8000) ? -result : result;
+   }
+   if (exponent == 31)
+      bits = 0x7f800000 | (mantissa << 13);
+   else
+      bits = ((exponent + 112) << 23) | (mantissa << 13);
+   bits |= (uint32_t) (h & 0x8000) << 16;
+   memcpy(&result, &bits, sizeof(result));
+   return result;
+}
+
+/* HTS_Model_load_packed_pdf: load pdfs of the reduced precision formats */
+static HTS_Boolean HTS_Model_load_packed_pdf(HTS_Model * model, HTS_File * fp)
+{
+   size_t j, k;
+   size_t len = model->vector_length * model->num_windows;
+   size_t msd_size = model->is_msd ? sizeof(float) : 0;
+   size_t vari_size = (model->pdf_format == HTS_PDF_FP16_U8) ? 1 : sizeof(uint16_t);
+   unsigned char *record;
+
+   /* per dimension offsets and scales of the means, then of the variances */
+   model->pdf_offset = (float *) HTS_calloc(len * 2, sizeof(float));
+   model->pdf_scale = (float *) HTS_calloc(len * 2, sizeof(float));
+   if (HTS_fread_little_endian(model->pdf_offset, sizeof(float), len * 2, fp) != len * 2)
+      return FALSE;
+   if (HTS_fread_little_endian(model->pdf_scale, sizeof(float), len * 2, fp) != len * 2)
+      return FALSE;
+   if (model->pdf_format == HTS_PDF_FP16_U8) {
+      model->vari_codebook = (float *) HTS_calloc(256, sizeof(float));
+      if (HTS_fread_little_endian(model->vari_codebook, sizeof(float), 256, fp) != 256)
+         return FALSE;
+   }
+   /* each record is the MSD weight, the means and the variances, padded for alignment */
+   model->pdf_record_size = msd_size + len * sizeof(uint16_t) + len * vari_size;
+   model->pdf_record_size = (model->pdf_record_size + sizeof(float) - 1) / sizeof(float) * sizeof(float);
+   model->pdf_data = (unsigned char **) HTS_calloc(model->ntree, sizeof(unsigned char *));
+   model->pdf_data -= 2;
+   for (j = 2; j <= model->ntree + 1; j++)
+      model->pdf_data[j] = (unsigned char *) HTS_calloc(model->npdf[j], model->pdf_record_size);
+   for (j = 2; j <= model->ntree + 1; j++) {
+      for (k = 0; k < model->npdf[j]; k++) {
+         record = model->pdf_data[j] + k * model->pdf_record_size;
+         if (msd_size != 0 && HTS_fread_little_endian(record, sizeof(float), 1, fp) != 1)
+            return FALSE;
+         if (HTS_fread_little_endian(record + msd_size, sizeof(uint16_t), len, fp) != len)
+            return FALSE;
+         if (HTS_fread_little_endian(record + msd_size + len * sizeof(uint16_t), vari_size, len, fp) != len)
+            return FALSE;
+      }
+   }
+   return TRUE;
+}
+
 /* HTS_Model_load_pdf: load pdfs */
-static HTS_Boolean HTS_Model_load_pdf(HTS_Model * model, HTS_File * fp, size_t vector_length, size_t num_windows, HTS_Boolean is_msd)
+static HTS_Boolean HTS_Model_load_pdf(HTS_Model * model, HTS_File * fp, size_t vector_length, size_t num_windows, HTS_Boolean is_msd, size_t pdf_format)
 {
    uint32_t i;
    size_t j, k;
@@ -712,6 +796,7 @@ static HTS_Boolean HTS_Model_load_pdf(HTS_Model * model, HTS_File * fp, size_t v
    model->vector_length = vector_length;
    model->num_windows = num_windows;
    model->is_msd = is_msd;
+   model->pdf_format = pdf_format;
    model->npdf = (size_t *) HTS_calloc(model->ntree, sizeof(size_t));
    model->npdf -= 2;
    /* read the number of pdfs */
@@ -735,6 +820,13 @@ static HTS_Boolean HTS_Model_load_pdf(HTS_Model * model, HTS_File * fp, size_t v
       HTS_Model_initialize(model);
       return FALSE;
    }
+   if (pdf_format != HTS_PDF_FLOAT32) {
+      if (HTS_Model_load_packed_pdf(model, fp) != TRUE) {
+         HTS_Model_clear(model);
+         return FALSE;
+      }
+      return TRUE;
+   }
    model->pdf = (float ***) HTS_calloc(model->ntree, sizeof(float **));
    model->pdf -= 2;
    /* read means and variances */
@@ -759,7 +851,7 @@ static HTS_Boolean HTS_Model_load_pdf(HTS_Model * model, HTS_File * fp, size_t v
 }
 
 /* HTS_Model_load: load pdf and tree */
-static HTS_Boolean HTS_Model_load(HTS_Model * model, HTS_File * pdf, HTS_File * tree, size_t vector_length, size_t num_windows, HTS_Boolean is_msd)
+static HTS_Boolean HTS_Model_load(HTS_Model * model, HTS_File * pdf, HTS_File * tree, size_t vector_length, size_t num_windows, HTS_Boolean is_msd, size_t pdf_format)
 {
    /* check */
    if (model == NULL || pdf == NULL || vector_length == 0 || num_windows == 0)
@@ -775,7 +867,7 @@ static HTS_Boolean HTS_Model_load(HTS_Model * model, HTS_File * pdf, HTS_File *
    }
 
    /* load pdf */
-   if (HTS_Model_load_pdf(model, pdf, vector_length, num_windows, is_msd) != TRUE) {
+   if (HTS_Model_load_pdf(model, pdf, vector_length, num_windows, is_msd, pdf_format) != TRUE) {
       HTS_Model_clear(model);
       return FALSE;
    }
@@ -942,6 +1034,7 @@ HTS_Boolean HTS_ModelSet_load(HTS_ModelSet * ms, char **voices, size_t num_voice
    HTS_Boolean *is_msd = NULL;
    size_t *num_windows = NULL;
    HTS_Boolean *use_gv = NULL;
+   size_t *pdf_format = NULL;
 
    char *gv_off_context = NULL;
 
@@ -961,6 +1054,7 @@ HTS_Boolean HTS_ModelSet_load(HTS_ModelSet * ms, char **voices, size_t num_voice
    HTS_Boolean *temp_is_msd;
    size_t *temp_num_windows;
    HTS_Boolean *temp_use_gv;
+   size_t *temp_pdf_format;
    char **temp_option;
 
    char *temp_duration_pdf;
@@ -1123,6 +1217,9 @@ HTS_Boolean HTS_ModelSet_load(HTS_ModelSet * ms, char **voices, size_t num_voice
       temp_use_gv = (HTS_Boolean *) HTS_calloc(ms->num_streams, sizeof(HTS_Boolean));
       for (j = 0; j < ms->num_streams; j++)
          temp_use_gv[j] = FALSE;
+      temp_pdf_format = (size_t *) HTS_calloc(ms->num_streams, sizeof(size_t));
+      for (j = 0; j < ms->num_streams; j++)
+         temp_pdf_format[j] = HTS_PDF_FLOAT32;
       temp_option = (char **) HTS_calloc(ms->num_streams, sizeof(char *));
       for (j = 0; j < ms->num_streams; j++)
          temp_option[j] = NULL;
@@ -1174,6 +1271,25 @@ HTS_Boolean HTS_ModelSet_load(HTS_ModelSet * ms, char **voices, size_t num_voice
                      }
                }
             }
+         } else if (HTS_match_head_string(buff1, "PDF_FORMAT[", &matched_size) == TRUE) {
+            if (HTS_get_token_from_string_with_separator(buff1, &matched_size, buff2, ']') == TRUE) {
+               if (buff1[matched_size++] == ':') {
+                  for (j = 0; j < ms->num_streams; j++)
+                     if (strcmp(stream_type_list[j], buff2) == 0) {
+                        if (HTS_strequal(&buff1[matched_size], "FLOAT32") == TRUE)
+                           temp_pdf_format[j] = HTS_PDF_FLOAT32;
+                        else if (HTS_strequal(&buff1[matched_size], "FP16") == TRUE)
+                           temp_pdf_format[j] = HTS_PDF_FP16;
+                        else if (HTS_strequal(&buff1[matched_size], "FP16_U8") == TRUE)
+                           temp_pdf_format[j] = HTS_PDF_FP16_U8;
+                        else {
+                           HTS_error(0, "HTS_ModelSet_load: Unknown PDF format %s.\n", &buff1[matched_size]);
+                           error = TRUE;
+                        }
+                        break;
+                     }
+               }
+            }
          } else if (HTS_match_head_string(buff1, "OPTION[", &matched_size) == TRUE) {
             if (HTS_get_token_from_string_with_separator(buff1, &matched_size, buff2, ']') == TRUE) {
                if (buff1[matched_size++] == ':') {
@@ -1196,6 +1312,7 @@ HTS_Boolean HTS_ModelSet_load(HTS_ModelSet * ms, char **voices, size_t num_voice
          is_msd = temp_is_msd;
          num_windows = temp_num_windows;
          use_gv = temp_use_gv;
+         pdf_format = temp_pdf_format;
          ms->option = temp_option;
       } else {
          for (j = 0; j < ms->num_streams; j++)
@@ -1210,6 +1327,9 @@ HTS_Boolean HTS_ModelSet_load(HTS_ModelSet * ms, char **voices, size_t num_voice
          for (j = 0; j < ms->num_streams; j++)
             if (use_gv[j] != temp_use_gv[j])
                error = TRUE;
+         for (j = 0; j < ms->num_streams; j++)
+            if (pdf_format[j] != temp_pdf_format[j])
+               error = TRUE;
          for (j = 0; j < ms->num_streams; j++)
             if (HTS_strequal(ms->option[j], temp_option[j]) != TRUE)
                error = TRUE;
@@ -1217,6 +1337,7 @@ HTS_Boolean HTS_ModelSet_load(HTS_ModelSet * ms, char **voices, size_t num_voice
          free(temp_is_msd);
          free(temp_num_windows);
          free(temp_use_gv);
+         free(temp_pdf_format);
          for (j = 0; j < ms->num_streams; j++)
             if (temp_option[j] != NULL)
                free(temp_option[j]);
@@ -1389,7 +1510,7 @@ HTS_Boolean HTS_ModelSet_load(HTS_ModelSet * ms, char **voices, size_t num_voice
          tree_fp = HTS_fopen_from_fp(fp, e - s + 1);
          HTS_fseek(fp, start_of_data, SEEK_SET);
       }
-      if (HTS_Model_load(&ms->duration[i], pdf_fp, tree_fp, ms->num_states, 1, FALSE) != TRUE)
+      if (HTS_Model_load(&ms->duration[i], pdf_fp, tree_fp, ms->num_states, 1, FALSE, HTS_PDF_FLOAT32) != TRUE)
          error = TRUE;
       HTS_fclose(pdf_fp);
       HTS_fclose(tree_fp);
@@ -1435,7 +1556,7 @@ HTS_Boolean HTS_ModelSet_load(HTS_ModelSet * ms, char **voices, size_t num_voice
             tree_fp = HTS_fopen_from_fp(fp, e - s + 1);
             HTS_fseek(fp, start_of_data, SEEK_SET);
          }
-         if (HTS_Model_load(&ms->stream[i][j], pdf_fp, tree_fp, vector_length[j], num_windows[j], is_msd[j]) != TRUE)
+         if (HTS_Model_load(&ms->stream[i][j], pdf_fp, tree_fp, vector_length[j], num_windows[j], is_msd[j], pdf_format[j]) != TRUE)
             error = TRUE;
          HTS_fclose(pdf_fp);
          HTS_fclose(tree_fp);
@@ -1461,7 +1582,7 @@ HTS_Boolean HTS_ModelSet_load(HTS_ModelSet * ms, char **voices, size_t num_voice
             HTS_fseek(fp, start_of_data, SEEK_SET);
          }
          if (use_gv[j] == TRUE) {
-            if (HTS_Model_load(&ms->gv[i][j], pdf_fp, tree_fp, vector_length[j], 1, FALSE) != TRUE)
+            if (HTS_Model_load(&ms->gv[i][j], pdf_fp, tree_fp, vector_length[j], 1, FALSE, HTS_PDF_FLOAT32) != TRUE)
                error = TRUE;
          }
          HTS_fclose(pdf_fp);
@@ -1529,6 +1650,8 @@ HTS_Boolean HTS_ModelSet_load(HTS_ModelSet * ms, char **voices, size_t num_voice
       free(num_windows);
    if (use_gv != NULL)
       free(use_gv);
+   if (pdf_format != NULL)
+      free(pdf_format);
 
    return !error;
 }
@@ -1643,6 +1766,37 @@ HTS_Boolean HTS_ModelSet_use_gv(HTS_ModelSet * ms, size_t stream_index)
       return FALSE;
 }
 
+/* HTS_Model_add_packed_parameter: expand a packed PDF using interpolation weight */
+static void HTS_Model_add_packed_parameter(HTS_Model * model, size_t tree_index, size_t pdf_index, double *mean, double *vari, double *msd, double weight)
+{
+   size_t i;
+   size_t len = model->vector_length * model->num_windows;
+   size_t msd_size = model->is_msd ? sizeof(float) : 0;
+   const unsigned char *record = model->pdf_data[tree_index] + (pdf_index - 1) * model->pdf_record_size;
+   const uint16_t *packed_mean = (const uint16_t *) (record + msd_size);
+   const uint16_t *packed_vari;
+   const unsigned char *coded_vari;
+   const float *offset = model->pdf_offset;
+   const float *scale = model->pdf_scale;
+   float w;
+
+   for (i = 0; i < len; i++)
+      mean[i] += weight * (offset[i] + scale[i] * HTS_half_to_float(packed_mean[i]));
+   if (model->pdf_format == HTS_PDF_FP16_U8) {
+      coded_vari = (const unsigned char *) (packed_mean + len);
+      for (i = 0; i < len; i++)
+         vari[i] += weight * exp(offset[i + len] + scale[i + len] * model->vari_codebook[coded_vari[i]]);
+   } else {
+      packed_vari = packed_mean + len;
+      for (i = 0; i < len; i++)
+         vari[i] += weight * (offset[i + len] + scale[i + len] * HTS_half_to_float(packed_vari[i]));
+   }
+   if (msd != NULL && model->is_msd == TRUE) {
+      memcpy(&w, record, sizeof(w));
+      *msd += weight * w;
+   }
+}
+
 /* HTS_Model_add_parameter: get parameter using interpolation weight */
 static void HTS_Model_add_parameter(HTS_Model * model, size_t state_index, const char *string, const RHVoice_parsed_label_string* parsed, double *mean, double *vari, double *msd, double weight)
 {
@@ -1651,6 +1805,10 @@ static void HTS_Model_add_parameter(HTS_Model * model, size_t state_index, const
    size_t len = model->vector_length * model->num_windows;
 
    HTS_Model_get_index(model, state_index, string, parsed, &tree_index, &pdf_index);
+   if (model->pdf_format != HTS_PDF_FLOAT32) {
+      HTS_Model_add_packed_parameter(model, tree_index, pdf_index, mean, vari, msd, weight);
+      return;
+   }
    for (i = 0; i < len; i++) {
       mean[i] += weight * model->pdf[tree_index][pdf_index][i];
       vari[i] += weight * model->pdf[tree_index][pdf_index][i + len];
@@ -75,6 +75,7 @@
 HTS_PSTREAM_C_START;
 
 #include <math.h>               /* for sqrt() */
+#include <string.h>             /* for memcpy() */
 
 /* hts_engine libraries */
 #include "HTS_hidden.h"
@@ -168,6 +169,122 @@ static void HTS_PStream_backward_substitution(HTS_PStream * pst, size_t m)
    }
 }
 
+/* The following functions do the same as the ones above for HTS_PSTREAM_LANES */
+/* consecutive dimensions starting from m at once. The band structure of */
+/* W'U^{-1}W is the same for all the dimensions, so their matrices are */
+/* stored interleaved and the innermost loops run over the dimensions, */
+/* which lets the compiler use SIMD instructions. The arithmetic of each */
+/* dimension is done in the same order as in the scalar functions. */
+
+/* HTS_PStream_calc_wuw_and_wum_lanes: calcurate W'U^{-1}W and W'U^{-1}M */
+static void HTS_PStream_calc_wuw_and_wum_lanes(HTS_PStream * pst, HTS_LaneMatrices * lm, size_t m)
+{
+   size_t t, i, j, k;
+   int shift;
+   double coef;
+   double wu[HTS_PSTREAM_LANES];
+   double *wuw, *wum;
+   const double *ivar, *mean;
+
+   for (t = 0; t < pst->length; t++) {
+      wuw = lm->wuw + t * pst->width * HTS_PSTREAM_LANES;
+      wum = lm->wum + t * HTS_PSTREAM_LANES;
+      for (k = 0; k < HTS_PSTREAM_LANES; k++)
+         wum[k] = 0.0;
+      for (i = 0; i < pst->width * HTS_PSTREAM_LANES; i++)
+         wuw[i] = 0.0;
+
+      for (i = 0; i < pst->win_size; i++)
+         for (shift = pst->win_l_width[i]; shift <= pst->win_r_width[i]; shift++)
+            if (((int) t + shift >= 0) && ((int) t + shift < (int) pst->length) && (pst->win_coefficient[i][-shift] != 0.0)) {
+               coef = pst->win_coefficient[i][-shift];
+               ivar = pst->sm.ivar[t + shift] + i * pst->vector_length + m;
+               mean = pst->sm.mean[t + shift] + i * pst->vector_length + m;
+               for (k = 0; k < HTS_PSTREAM_LANES; k++) {
+                  wu[k] = coef * ivar[k];
+                  wum[k] += wu[k] * mean[k];
+               }
+               for (j = 0; (j < pst->width) && (t + j < pst->length); j++)
+                  if (((int) j <= pst->win_r_width[i] + shift) && (pst->win_coefficient[i][j - shift] != 0.0)) {
+                     coef = pst->win_coefficient[i][j - shift];
+                     for (k = 0; k < HTS_PSTREAM_LANES; k++)
+                        wuw[j * HTS_PSTREAM_LANES + k] += wu[k] * coef;
+                  }
+            }
+   }
+}
+
+/* HTS_PStream_ldl_factorization_lanes: Factorize W'*U^{-1}*W to L*D*L' */
+static void HTS_PStream_ldl_factorization_lanes(HTS_PStream * pst, HTS_LaneMatrices * lm)
+{
+   size_t t, i, j, k;
+   const size_t row = pst->width * HTS_PSTREAM_LANES;
+   double *cur;
+   const double *prev;
+
+   for (t = 0; t < pst->length; t++) {
+      cur = lm->wuw + t * row;
+      for (i = 1; (i < pst->width) && (t >= i); i++) {
+         prev = cur - i * row;
+         for (k = 0; k < HTS_PSTREAM_LANES; k++)
+            cur[k] -= prev[i * HTS_PSTREAM_LANES + k] * prev[i * HTS_PSTREAM_LANES + k] * prev[k];
+      }
+
+      for (i = 1; i < pst->width; i++) {
+         for (j = 1; (i + j < pst->width) && (t >= j); j++) {
+            prev = cur - j * row;
+            for (k = 0; k < HTS_PSTREAM_LANES; k++)
+               cur[i * HTS_PSTREAM_LANES + k] -= prev[j * HTS_PSTREAM_LANES + k] * prev[(i + j) * HTS_PSTREAM_LANES + k] * prev[k];
+         }
+         for (k = 0; k < HTS_PSTREAM_LANES; k++)
+            cur[i * HTS_PSTREAM_LANES + k] /= cur[k];
+      }
+   }
+}
+
+/* HTS_PStream_forward_substitution_lanes: forward subtitution for mlpg */
+static void HTS_PStream_forward_substitution_lanes(HTS_PStream * pst, HTS_LaneMatrices * lm)
+{
+   size_t t, i, k;
+   const size_t row = pst->width * HTS_PSTREAM_LANES;
+   double *g;
+   const double *prev, *prev_g;
+
+   for (t = 0; t < pst->length; t++) {
+      g = lm->g + t * HTS_PSTREAM_LANES;
+      for (k = 0; k < HTS_PSTREAM_LANES; k++)
+         g[k] = lm->wum[t * HTS_PSTREAM_LANES + k];
+      for (i = 1; (i < pst->width) && (t >= i); i++) {
+         prev = lm->wuw + (t - i) * row;
+         prev_g = g - i * HTS_PSTREAM_LANES;
+         for (k = 0; k < HTS_PSTREAM_LANES; k++)
+            g[k] -= prev[i * HTS_PSTREAM_LANES + k] * prev_g[k];
+      }
+   }
+}
+
+/* HTS_PStream_backward_substitution_lanes: backward subtitution for mlpg */
+static void HTS_PStream_backward_substitution_lanes(HTS_PStream * pst, HTS_LaneMatrices * lm, size_t m)
+{
+   size_t rev, t, i, k;
+   double x[HTS_PSTREAM_LANES];
+   const double *cur, *next;
+
+   for (rev = 0; rev < pst->length; rev++) {
+      t = pst->length - 1 - rev;
+      cur = lm->wuw + t * pst->width * HTS_PSTREAM_LANES;
+      for (k = 0; k < HTS_PSTREAM_LANES; k++)
+         x[k] = lm->g[t * HTS_PSTREAM_LANES + k] / cur[k];
+      for (i = 1; (i < pst->width) && (t + i < pst->length); i++) {
+         next = pst->par[t + i] + m;
+         for (k = 0; k < HTS_PSTREAM_LANES; k++)
+            x[k] -= cur[i * HTS_PSTREAM_LANES + k] * next[k];
+      }
+      for (k = 0; k < HTS_PSTREAM_LANES; k++)
+         pst->par[t][m + k] = x[k];
+   }
+}
+
 /* HTS_PStream_calc_gv: subfunction for mlpg using GV */
 static void HTS_PStream_calc_gv(HTS_PStream * pst, size_t m, double *mean, double *vari)
 {
@@ -238,6 +355,14 @@ static double HTS_PStream_calc_derivative(HTS_PStream * pst, size_t m)
    return (-(hmmobj + gvobj));
 }
 
+/* HTS_PStream_gv_converged: check if the GV objective has stopped changing */
+static HTS_Boolean HTS_PStream_gv_converged(HTS_PStream * pst, double prev, double obj)
+{
+   if (pst->gv_tolerance <= 0.0)
+      return FALSE;
+   return (fabs(obj - prev) <= pst->gv_tolerance * fabs(prev)) ? TRUE : FALSE;
+}
+
 /* HTS_PStream_gv_parmgen: function for mlpg using GV */
 static void HTS_PStream_gv_parmgen(HTS_PStream * pst, size_t m)
 {
@@ -250,11 +375,13 @@ static void HTS_PStream_gv_parmgen(HTS_PStream * pst, size_t m)
       return;
 
    HTS_PStream_conv_gv(pst, m);
-   if (GV_MAX_ITERATION > 0) {
+   if (pst->gv_max_iteration > 0) {
       HTS_PStream_calc_wuw_and_wum(pst, m);
-      for (i = 1; i <= GV_MAX_ITERATION; i++) {
+      for (i = 1; i <= pst->gv_max_iteration; i++) {
          obj = HTS_PStream_calc_derivative(pst, m);
          if (i > 1) {
+            if (HTS_PStream_gv_converged(pst, prev, obj))
+               break;
             if (obj > prev)
                step *= STEPDEC;
             if (obj < prev)
@@ -269,15 +396,138 @@ static void HTS_PStream_gv_parmgen(HTS_PStream * pst, size_t m)
    }
 }
 
-/* HTS_PStream_mlpg: generate sequence of speech parameter vector maximizing its output probability for given pdf sequence */
-static void HTS_PStream_mlpg(HTS_PStream * pst)
+/* HTS_PStream_calc_derivative_lanes: HTS_PStream_calc_derivative for several dimensions, */
+/* using the W'U^{-1}W saved by mlpg instead of computing it again */
+static void HTS_PStream_calc_derivative_lanes(HTS_PStream * pst, HTS_LaneMatrices * lm, size_t m, double *obj)
 {
-   size_t m;
+   size_t t, i, k;
+   const size_t row = pst->width * HTS_PSTREAM_LANES;
+   double mean[HTS_PSTREAM_LANES];
+   double vari[HTS_PSTREAM_LANES];
+   double dv[HTS_PSTREAM_LANES];
+   double gvobj[HTS_PSTREAM_LANES];
+   double hmmobj[HTS_PSTREAM_LANES];
+   double h;
+   double w = 1.0 / (pst->win_size * pst->length);
+   const double *band, *par, *other, *wum;
+   double *g;
+
+   for (k = 0; k < HTS_PSTREAM_LANES; k++) {
+      HTS_PStream_calc_gv(pst, m + k, &mean[k], &vari[k]);
+      gvobj[k] = -0.5 * W2 * vari[k] * pst->gv_vari[m + k] * (vari[k] - 2.0 * pst->gv_mean[m + k]);
+      dv[k] = -2.0 * pst->gv_vari[m + k] * (vari[k] - pst->gv_mean[m + k]) / pst->length;
+      hmmobj[k] = 0.0;
+   }
 
-   if (pst->length == 0)
+   for (t = 0; t < pst->length; t++) {
+      band = lm->gv_wuw + t * row;
+      par = pst->par[t] + m;
+      g = lm->g + t * HTS_PSTREAM_LANES;
+      for (k = 0; k < HTS_PSTREAM_LANES; k++)
+         g[k] = band[k] * par[k];
+      for (i = 1; i < pst->width; i++) {
+         if (t + i < pst->length) {
+            other = pst->par[t + i] + m;
+            for (k = 0; k < HTS_PSTREAM_LANES; k++)
+               g[k] += band[i * HTS_PSTREAM_LANES + k] * other[k];
+         }
+         if (t + 1 > i) {
+            other = pst->par[t - i] + m;
+            for (k = 0; k < HTS_PSTREAM_LANES; k++)
+               g[k] += band[i * HTS_PSTREAM_LANES + k - i * row] * other[k];
+         }
+      }
+   }
+
+   for (t = 0; t < pst->length; t++) {
+      band = lm->gv_wuw + t * row;
+      par = pst->par[t] + m;
+      wum = lm->wum + t * HTS_PSTREAM_LANES;
+      g = lm->g + t * HTS_PSTREAM_LANES;
+      for (k = 0; k < HTS_PSTREAM_LANES; k++) {
+         hmmobj[k] += W1 * w * par[k] * (wum[k] - 0.5 * g[k]);
+         h = -W1 * w * band[k] - W2 * 2.0 / (pst->length * pst->length) * ((pst->length - 1) * pst->gv_vari[m + k] * (vari[k] - pst->gv_mean[m + k]) + 2.0 * pst->gv_vari[m + k] * (par[k] - mean[k]) * (par[k] - mean[k]));
+         if (pst->gv_switch[t])
+            g[k] = 1.0 / h * (W1 * w * (-g[k] + wum[k]) + W2 * dv[k] * (par[k] - mean[k]));
+         else
+            g[k] = 1.0 / h * (W1 * w * (-g[k] + wum[k]));
+      }
+   }
+
+   for (k = 0; k < HTS_PSTREAM_LANES; k++)
+      obj[k] = -(hmmobj[k] + gvobj[k]);
+}
+
+/* HTS_PStream_gv_parmgen_lanes: HTS_PStream_gv_parmgen for several dimensions, */
+/* each of which stops iterating on its own */
+static void HTS_PStream_gv_parmgen_lanes(HTS_PStream * pst, HTS_LaneMatrices * lm, size_t m)
+{
+   size_t t, i, k, active;
+   double step[HTS_PSTREAM_LANES];
+   double prev[HTS_PSTREAM_LANES];
+   double obj[HTS_PSTREAM_LANES];
+   HTS_Boolean done[HTS_PSTREAM_LANES];
+   double *par;
+   const double *g;
+
+   if (pst->gv_length == 0)
       return;
 
-   for (m = 0; m < pst->vector_length; m++) {
+   for (k = 0; k < HTS_PSTREAM_LANES; k++) {
+      HTS_PStream_conv_gv(pst, m + k);
+      step[k] = STEPINIT;
+      prev[k] = 0.0;
+      done[k] = FALSE;
+   }
+   for (i = 1; i <= pst->gv_max_iteration; i++) {
+      HTS_PStream_calc_derivative_lanes(pst, lm, m, obj);
+      for (k = 0, active = 0; k < HTS_PSTREAM_LANES; k++) {
+         if (done[k])
+            continue;
+         if (i > 1) {
+            if (HTS_PStream_gv_converged(pst, prev[k], obj[k])) {
+               done[k] = TRUE;
+               continue;
+            }
+            if (obj[k] > prev[k])
+               step[k] *= STEPDEC;
+            if (obj[k] < prev[k])
+               step[k] *= STEPINC;
+         }
+         prev[k] = obj[k];
+         active++;
+      }
+      if (active == 0)
+         break;
+      for (t = 0; t < pst->length; t++) {
+         if (pst->gv_switch[t]) {
+            par = pst->par[t] + m;
+            g = lm->g + t * HTS_PSTREAM_LANES;
+            for (k = 0; k < HTS_PSTREAM_LANES; k++)
+               if (!done[k])
+                  par[k] += step[k] * g[k];
+         }
+      }
+   }
+}
+
+/* HTS_PStream_mlpg_lanes: generate HTS_PSTREAM_LANES dimensions starting from m */
+static void HTS_PStream_mlpg_lanes(HTS_PStream * pst, HTS_LaneMatrices * lm, size_t m)
+{
+   HTS_PStream_calc_wuw_and_wum_lanes(pst, lm, m);
+   if (pst->gv_length > 0 && pst->gv_max_iteration > 0)
+      memcpy(lm->gv_wuw, lm->wuw, pst->length * pst->width * HTS_PSTREAM_LANES * sizeof(double));
+   HTS_PStream_ldl_factorization_lanes(pst, lm);
+   HTS_PStream_forward_substitution_lanes(pst, lm);
+   HTS_PStream_backward_substitution_lanes(pst, lm, m);
+   if (pst->gv_length > 0)
+      HTS_PStream_gv_parmgen_lanes(pst, lm, m);
+}
+
+/* HTS_PStream_mlpg_remainder: generate the dimensions from m which do not fill a block of lanes */
+static void HTS_PStream_mlpg_remainder(HTS_PStream * pst, size_t m)
+{
+   for (; m < pst->vector_length; m++) {
       HTS_PStream_calc_wuw_and_wum(pst, m);
       HTS_PStream_ldl_factorization(pst);       /* LDL factorization */
       HTS_PStream_forward_substitution(pst);    /* forward substitution   */
@@ -287,6 +537,75 @@ static void HTS_PStream_mlpg(HTS_PStream * pst)
    }
 }
 
+/* HTS_PStream_get_ntask: number of independent parts of the parameter generation of a stream */
+static size_t HTS_PStream_get_ntask(HTS_PStream * pst)
+{
+   if (pst->length == 0)
+      return 0;
+   return pst->vector_length / HTS_PSTREAM_LANES + (pst->vector_length % HTS_PSTREAM_LANES != 0 ? 1 : 0);
+}
+
+/* HTS_PStream_mlpg_task: generate sequence of speech parameter vector maximizing its output probability for given pdf sequence, */
+/* for one block of lanes or the remaining dimensions, so that the tasks can run in any order or at the same time */
+static void HTS_PStream_mlpg_task(HTS_PStream * pst, size_t task)
+{
+   size_t m = task * HTS_PSTREAM_LANES;
+
+   if (m + HTS_PSTREAM_LANES <= pst->vector_length)
+      HTS_PStream_mlpg_lanes(pst, &pst->sm.lanes[task % pst->sm.nlanes], m);
+   else
+      HTS_PStream_mlpg_remainder(pst, m);
+}
+
+/* HTS_PStreamSet_task_list: the tasks of all the streams, for the worker pool */
+typedef struct _HTS_PStreamSet_task_list {
+   HTS_PStreamSet *pss;
+   size_t *first_task;          /* index of the first task of each stream */
+   RHVoice_cancellation_token_t cancel;
+} HTS_PStreamSet_task_list;
+
+/* HTS_PStreamSet_run_task: run one task from the list */
+static void HTS_PStreamSet_run_task(void *data, size_t index)
+{
+   HTS_PStreamSet_task_list *list = (HTS_PStreamSet_task_list *) data;
+   size_t i;
+
+   if (RHVoice_cancellation_requested(list->cancel))
+      return;
+   for (i = list->pss->nstream - 1; list->first_task[i] > index; i--);
+   HTS_PStream_mlpg_task(&list->pss->pstream[i], index - list->first_task[i]);
+}
+
+/* HTS_PStreamSet_mlpg: generate all the streams, using the worker pool if there is one */
+static HTS_Boolean HTS_PStreamSet_mlpg(HTS_PStreamSet * pss, RHVoice_worker_pool_t pool, RHVoice_cancellation_token_t cancel)
+{
+   size_t i, j, ntask;
+   HTS_PStreamSet_task_list list;
+
+   if (pool.impl == NULL) {
+      for (i = 0; i < pss->nstream; i++) {
+         ntask = HTS_PStream_get_ntask(&pss->pstream[i]);
+         for (j = 0; j < ntask; j++) {
+            if (RHVoice_cancellation_requested(cancel))
+               return FALSE;
+            HTS_PStream_mlpg_task(&pss->pstream[i], j);
+         }
+      }
+      return TRUE;
+   }
+
+   list.pss = pss;
+   list.cancel = cancel;
+   list.first_task = (size_t *) HTS_calloc(pss->nstream, sizeof(size_t));
+   for (i = 0, ntask = 0; i < pss->nstream; i++) {
+      list.first_task[i] = ntask;
+      ntask += HTS_PStream_get_ntask(&pss->pstream[i]);
+   }
+   RHVoice_worker_pool_run(pool, ntask, HTS_PStreamSet_run_task, &list);
+   HTS_free(list.first_task);
+   return RHVoice_cancellation_requested(cancel) ? FALSE : TRUE;
+}
+
 /* HTS_PStreamSet_initialize: initialize parameter stream set */
 void HTS_PStreamSet_initialize(HTS_PStreamSet * pss)
 {
@@ -296,7 +615,7 @@ void HTS_PStreamSet_initialize(HTS_PStreamSet * pss)
 }
 
 /* HTS_PStreamSet_create: parameter generation using GV weight */
-HTS_Boolean HTS_PStreamSet_create(HTS_PStreamSet * pss, HTS_SStreamSet * sss, double *msd_threshold, double *gv_weight)
+HTS_Boolean HTS_PStreamSet_create(HTS_PStreamSet * pss, HTS_SStreamSet * sss, double *msd_threshold, double *gv_weight, size_t gv_max_iteration, double gv_tolerance, RHVoice_worker_pool_t pool, RHVoice_cancellation_token_t cancel)
 {
    size_t i, j, k, l, m;
    int shift;
@@ -317,6 +636,8 @@ HTS_Boolean HTS_PStreamSet_create(HTS_PStreamSet * pss, HTS_SStreamSet * sss, do
 
    /* create */
    for (i = 0; i < pss->nstream; i++) {
+      if (RHVoice_cancellation_requested(cancel))
+         return FALSE;
       pst = &pss->pstream[i];
       if (HTS_SStreamSet_is_msd(sss, i) == TRUE) {      /* for MSD */
          pst->length = 0;
@@ -352,6 +673,16 @@ HTS_Boolean HTS_PStreamSet_create(HTS_PStreamSet * pss, HTS_SStreamSet * sss, do
          pst->sm.wuw = HTS_alloc_matrix(pst->length, pst->width);
          pst->sm.g = (double *) HTS_calloc(pst->length, sizeof(double));
          pst->par = HTS_alloc_matrix(pst->length, pst->vector_length);
+         if (pst->vector_length >= HTS_PSTREAM_LANES) {
+            /* the blocks running at the same time need their own matrices */
+            pst->sm.nlanes = (pool.impl != NULL) ? pst->vector_length / HTS_PSTREAM_LANES : 1;
+            pst->sm.lanes = (HTS_LaneMatrices *) HTS_calloc(pst->sm.nlanes, sizeof(HTS_LaneMatrices));
+            for (j = 0; j < pst->sm.nlanes; j++) {
+               pst->sm.lanes[j].wuw = (double *) HTS_calloc(pst->length * pst->width * HTS_PSTREAM_LANES, sizeof(double));
+               pst->sm.lanes[j].wum = (double *) HTS_calloc(pst->length * HTS_PSTREAM_LANES, sizeof(double));
+               pst->sm.lanes[j].g = (double *) HTS_calloc(pst->length * HTS_PSTREAM_LANES, sizeof(double));
+            }
+         }
       }
       /* copy dynamic window */
       pst->win_l_width = (int *) HTS_calloc(pst->win_size, sizeof(int));
@@ -373,6 +704,8 @@ HTS_Boolean HTS_PStreamSet_create(HTS_PStreamSet * pss, HTS_SStreamSet * sss, do
 
       }
       /* copy GV */
+      pst->gv_max_iteration = gv_max_iteration;
+      pst->gv_tolerance = gv_tolerance;
       if (HTS_SStreamSet_use_gv(sss, i)) {
          pst->gv_mean = (double *) HTS_calloc(pst->vector_length, sizeof(double));
          pst->gv_vari = (double *) HTS_calloc(pst->vector_length, sizeof(double));
@@ -394,6 +727,9 @@ HTS_Boolean HTS_PStreamSet_create(HTS_PStreamSet * pss, HTS_SStreamSet * sss, do
          for (j = 0, pst->gv_length = 0; j < pst->length; j++)
             if (pst->gv_switch[j])
                pst->gv_length++;
+         if (pst->gv_length > 0 && pst->sm.lanes != NULL)
+            for (j = 0; j < pst->sm.nlanes; j++)
+               pst->sm.lanes[j].gv_wuw = (double *) HTS_calloc(pst->length * pst->width * HTS_PSTREAM_LANES, sizeof(double));
       } else {
          pst->gv_switch = NULL;
          pst->gv_length = 0;
@@ -532,9 +868,14 @@ HTS_Boolean HTS_PStreamSet_create(HTS_PStreamSet * pss, HTS_SStreamSet * sss, do
             }
          }
       }
-      /* parameter generation */
-      HTS_PStream_mlpg(pst);
+   }
 
+   /* parameter generation */
+   if (!HTS_PStreamSet_mlpg(pss, pool, cancel))
+      return FALSE;
+
+   for (i = 0; i < pss->nstream; i++) {
+      pst = &pss->pstream[i];
 if ( 0) {
 			/* MAR debug */
 		fprintf(stderr,"\n---- solution ---%ld\n",i);
@@ -642,6 +983,16 @@ void HTS_PStreamSet_clear(HTS_PStreamSet * pss)
             HTS_free(pstream->sm.g);
          if (pstream->sm.wuw)
             HTS_free_matrix(pstream->sm.wuw, pstream->length);
+         if (pstream->sm.lanes) {
+            for (j = 0; j < pstream->sm.nlanes; j++) {
+               HTS_free(pstream->sm.lanes[j].wuw);
+               HTS_free(pstream->sm.lanes[j].wum);
+               HTS_free(pstream->sm.lanes[j].g);
+               if (pstream->sm.lanes[j].gv_wuw)
+                  HTS_free(pstream->sm.lanes[j].gv_wuw);
+            }
+            HTS_free(pstream->sm.lanes);
+         }
          if (pstream->sm.ivar)
             HTS_free_matrix(pstream->sm.ivar, pstream->length);
          if (pstream->sm.mean)
@@ -206,7 +206,7 @@ void HTS_SStreamSet_initialize(HTS_SStreamSet * sss)
 }
 
 /* HTS_SStreamSet_create: parse label and determine state duration */
-HTS_Boolean HTS_SStreamSet_create(HTS_SStreamSet * sss, HTS_ModelSet * ms, HTS_Label * label, HTS_Boolean phoneme_alignment_flag, double speed, double *duration_iw, double **parameter_iw, double **gv_iw)
+HTS_Boolean HTS_SStreamSet_create(HTS_SStreamSet * sss, HTS_ModelSet * ms, HTS_Label * label, HTS_Boolean phoneme_alignment_flag, double speed, double *duration_iw, double **parameter_iw, double **gv_iw, RHVoice_cancellation_token_t cancel)
 {
    size_t i, j, k;
    double temp;
@@ -290,6 +290,11 @@ HTS_Boolean HTS_SStreamSet_create(HTS_SStreamSet * sss, HTS_ModelSet * ms, HTS_L
    duration_vari = (double *) HTS_calloc(sss->total_state, sizeof(double));
    for (i = 0; i < HTS_Label_get_size(label); i++)
      {
+       if (RHVoice_cancellation_requested(cancel)) {
+          HTS_free(duration_mean);
+          HTS_free(duration_vari);
+          return FALSE;
+       }
        HTS_ModelSet_get_duration(ms, HTS_Label_get_string(label, i), HTS_Label_get_parsed(label, i), duration_iw, &duration_mean[i * sss->nstate], &duration_vari[i * sss->nstate]);
        label_dur_mod=HTS_Label_get_dur_mod(label, i);
        for(j=0; j < sss->nstate; ++j)
@@ -338,6 +343,8 @@ HTS_Boolean HTS_SStreamSet_create(HTS_SStreamSet * sss, HTS_ModelSet * ms, HTS_L
 
    /* get parameter */
    for (i = 0, state = 0; i < HTS_Label_get_size(label); i++) {
+      if (RHVoice_cancellation_requested(cancel))
+         return FALSE;
       for (j = 2; j <= sss->nstate + 1; j++) {
          sss->total_frame += sss->duration[state];
          for (k = 0; k < sss->nstream; k++) {
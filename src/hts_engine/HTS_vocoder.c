@@ -75,6 +75,7 @@
 HTS_VOCODER_C_START;
 
 #include <math.h>               /* for sqrt(),log(),exp(),pow(),cos() */
+#include <string.h>             /* for memmove() */
 
 /* hts_engine libraries */
 #include "HTS_hidden.h"
@@ -669,31 +670,37 @@ static double HTS_white_noise(HTS_Vocoder * v)
 }
 
 /* HTS_Vocoder_initialize_excitation: initialize excitation */
-static void HTS_Vocoder_initialize_excitation(HTS_Vocoder * v, double pitch, size_t nbpf)
+static void HTS_Vocoder_initialize_excitation(HTS_Vocoder * v, double pitch, BPF * bpf)
 {
-   size_t i;
+   size_t i, j;
 
    v->pitch_of_curr_point = pitch;
    v->pitch_counter = pitch;
    v->pitch_inc_per_point = 0.0;
-   if (nbpf > 0) {
-      v->excite_buff_size = nbpf;
+   if (bpf != NULL && bpf->length > 0) {
+      v->excite_buff_size = bpf->length;
       v->pulses_ring_buff = (double *) HTS_calloc(v->excite_buff_size, sizeof(double));
-      v->noise_ring_buff = (double *) HTS_calloc(v->excite_buff_size, sizeof(double));
-      v->pulse_filter = (double *) HTS_calloc(nbpf, sizeof(double));
-      v->noise_filter = (double *) HTS_calloc(nbpf, sizeof(double));
-      for (i = 0; i < v->excite_buff_size; i++)
-        {
-          v->pulses_ring_buff[i] = 0.0;
-          v->noise_ring_buff[i] = 0.0;
-        }
+      v->pulse_slots = (size_t *) HTS_calloc(v->excite_buff_size, sizeof(size_t));
+      v->num_pulse_slots = 0;
+      v->noise_buff = (double *) HTS_calloc(v->excite_buff_size - 1 + v->fprd, sizeof(double));
+      v->excite_frame = (double *) HTS_calloc(v->fprd, sizeof(double));
+      v->pulse_filter = (double *) HTS_calloc(bpf->length, sizeof(double));
+      v->noise_filter = (double *) HTS_calloc(bpf->length, sizeof(double));
+      v->band_sum = (double *) HTS_calloc(bpf->length, sizeof(double));
+      for (i = 0; i < bpf->number; i++)
+         for (j = 0; j < bpf->length; j++)
+            v->band_sum[j] += bpf->coefs[i][j];
       v->excite_buff_index = 0;
    } else {
       v->excite_buff_size = 0;
       v->pulses_ring_buff = NULL;
-      v->noise_ring_buff = NULL;
+      v->pulse_slots = NULL;
+      v->num_pulse_slots = 0;
+      v->noise_buff = NULL;
+      v->excite_frame = NULL;
       v->pulse_filter = NULL;
       v->noise_filter = NULL;
+      v->band_sum = NULL;
       v->excite_buff_index = 0;
    }
 }
@@ -711,100 +718,111 @@ static void HTS_Vocoder_start_excitation(HTS_Vocoder * v, double pitch, double*
    if(bap!=NULL&&v->pitch_of_curr_point!=0)
      {
        for(int j=0;j<bpf->length;++j)
-         {
-           v->pulse_filter[j]=0.0;
-           v->noise_filter[j]=0.0;
-}
-       double pw,nw;
+         v->noise_filter[j]=0.0;
+       double nw;
        for(int i=0;i<bpf->number;++i)
          {
            nw=bap[i];
-           pw=1-nw;
            for(int j=0;j<bpf->length;++j)
-             {
-               v->pulse_filter[j]+=(pw*bpf->coefs[i][j]);
-               v->noise_filter[j]+=(nw*bpf->coefs[i][j]);
-}
+             v->noise_filter[j]+=(nw*bpf->coefs[i][j]);
 }
+       /* the pulse weights are 1-bap */
+       for(unsigned int j=0;j<bpf->length;++j)
+         v->pulse_filter[j]=v->band_sum[j]-v->noise_filter[j];
 }
 }
 
-/* HTS_Vocoder_excite_unvoiced_frame: ping noise to ring buffer */
-static double HTS_Vocoder_excite_unvoiced_frame(HTS_Vocoder * v, double noise)
+/* HTS_Vocoder_set_pulse: put the pulse value of the current sample to the pulse ring */
+static void HTS_Vocoder_set_pulse(HTS_Vocoder * v, double pulse)
 {
-   v->noise_ring_buff[v->excite_buff_index] = noise;
-   return noise;
+   const size_t i = v->excite_buff_index;
+   const double prev = v->pulses_ring_buff[i];
+   size_t k;
+
+   v->pulses_ring_buff[i] = pulse;
+   if (prev == 0.0 && pulse != 0.0) {
+      v->pulse_slots[v->num_pulse_slots++] = i;
+   } else if (prev != 0.0 && pulse == 0.0) {
+      for (k = 0; k < v->num_pulse_slots; k++) {
+         if (v->pulse_slots[k] == i) {
+            v->pulse_slots[k] = v->pulse_slots[--v->num_pulse_slots];
+            break;
+         }
+      }
+   }
 }
 
-/* HTS_Vocoder_excite_vooiced_frame: ping noise and pulse to ring buffer */
-static double HTS_Vocoder_excite_voiced_frame(HTS_Vocoder * v, double noise, double pulse)
+/* HTS_Vocoder_filter_pulses: filter the pulse ring, there is only one pulse per period */
+static double HTS_Vocoder_filter_pulses(HTS_Vocoder * v)
 {
-   double x=0.0;
-   v->pulses_ring_buff[v->excite_buff_index]=pulse;
-   v->noise_ring_buff[v->excite_buff_index]=noise;
-   const size_t m=v->excite_buff_index+1;
-   const double* pulse_sig_ptr=v->pulses_ring_buff+m;
-   const double* pulse_coef_ptr=v->pulse_filter;
-   const double* noise_sig_ptr=v->noise_ring_buff+m;
-   const double* noise_coef_ptr=v->noise_filter;
-   const size_t n=v->excite_buff_size-m;
-   size_t i=n;
-   while(i!=0)
-     {
-       --i;
-       x+=pulse_sig_ptr[i]*pulse_coef_ptr[i];
-       x+=noise_sig_ptr[i]*noise_coef_ptr[i];
-     }
-   pulse_sig_ptr=v->pulses_ring_buff;
-   noise_sig_ptr=v->noise_ring_buff;
-   pulse_coef_ptr+=n;
-   noise_coef_ptr+=n;
-   i=m;
-   while(i!=0)
-     {
-       --i;
-       x+=pulse_sig_ptr[i]*pulse_coef_ptr[i];
-       x+=noise_sig_ptr[i]*noise_coef_ptr[i];
-     }
+   const size_t len = v->excite_buff_size;
+   const size_t i = v->excite_buff_index;
+   double x = 0.0;
+   size_t k, s, age;
+
+   for (k = 0; k < v->num_pulse_slots; k++) {
+      s = v->pulse_slots[k];
+      age = (i >= s) ? (i - s) : (i + len - s);
+      x += v->pulses_ring_buff[s] * v->pulse_filter[len - 1 - age];
+   }
    return x;
 }
 
-/* HTS_Vocoder_get_excitation: get excitation of each sample */
-static double HTS_Vocoder_get_excitation(HTS_Vocoder * v)
+/* HTS_Vocoder_excite_frame: mixed excitation of a whole frame */
+static void HTS_Vocoder_excite_frame(HTS_Vocoder * v)
 {
-   double x;
-   double noise, pulse = 0.0;
-
-   if (v->excite_buff_size > 0) {
-      noise = HTS_white_noise(v);
-      pulse = 0.0;
+   const size_t len = v->excite_buff_size;
+   double *noise = v->noise_buff + len - 1;
+   const double *f = v->noise_filter;
+   const double *n;
+   double pulse, x;
+   size_t j, k;
+
+   for (j = 0; j < v->fprd; j++)
+      noise[j] = HTS_white_noise(v);
+   for (j = 0; j < v->fprd; j++) {
       if (v->pitch_of_curr_point == 0.0) {
-         x=HTS_Vocoder_excite_unvoiced_frame(v, noise);
+         /* the pulse ring is kept as it is */
+         v->excite_frame[j] = noise[j];
       } else {
          v->pitch_counter += 1.0;
+         pulse = 0.0;
          if (v->pitch_counter >= v->pitch_of_curr_point) {
             pulse = sqrt(v->pitch_of_curr_point);
             v->pitch_counter -= v->pitch_of_curr_point;
          }
-         x=HTS_Vocoder_excite_voiced_frame(v, noise, pulse);
+         HTS_Vocoder_set_pulse(v, pulse);
+         x = HTS_Vocoder_filter_pulses(v);
+         n = noise + j + 1 - len;
+         for (k = 0; k < len; k++)
+            x += n[k] * f[k];
+         v->excite_frame[j] = x;
          v->pitch_of_curr_point += v->pitch_inc_per_point;
       }
       v->excite_buff_index++;
       if (v->excite_buff_index >= v->excite_buff_size)
          v->excite_buff_index = 0;
+   }
+   /* keep the history for the next frame */
+   memmove(v->noise_buff, v->noise_buff + v->fprd, (len - 1) * sizeof(double));
+}
+
+/* HTS_Vocoder_get_excitation: get excitation of each sample, without band-pass filters */
+static double HTS_Vocoder_get_excitation(HTS_Vocoder * v)
+{
+   double x;
+
+   if (v->pitch_of_curr_point == 0.0) {
+      x = HTS_white_noise(v);
    } else {
-      if (v->pitch_of_curr_point == 0.0) {
-         x = HTS_white_noise(v);
+      v->pitch_counter += 1.0;
+      if (v->pitch_counter >= v->pitch_of_curr_point) {
+         x = sqrt(v->pitch_of_curr_point);
+         v->pitch_counter -= v->pitch_of_curr_point;
       } else {
-         v->pitch_counter += 1.0;
-         if (v->pitch_counter >= v->pitch_of_curr_point) {
-            x = sqrt(v->pitch_of_curr_point);
-            v->pitch_counter -= v->pitch_of_curr_point;
-         } else {
-            x = 0.0;
-         }
-         v->pitch_of_curr_point += v->pitch_inc_per_point;
+         x = 0.0;
       }
+      v->pitch_of_curr_point += v->pitch_inc_per_point;
    }
 
    return x;
@@ -902,8 +920,12 @@ void HTS_Vocoder_initialize(HTS_Vocoder * v, size_t m, size_t stage, HTS_Boolean
    v->pitch_inc_per_point = 0.0;
    v->pulse_filter = NULL;
    v->noise_filter = NULL;
+   v->band_sum = NULL;
    v->pulses_ring_buff = NULL;
-   v->noise_ring_buff = NULL;
+   v->pulse_slots = NULL;
+   v->num_pulse_slots = 0;
+   v->noise_buff = NULL;
+   v->excite_frame = NULL;
    v->excite_buff_size = 0;
    v->excite_buff_index = 0;
    v->sw = 0;
@@ -953,7 +975,7 @@ void HTS_Vocoder_synthesize(HTS_Vocoder * v, size_t m, double lf0, double *spect
 
    /* first time */
    if (v->is_first == TRUE) {
-     HTS_Vocoder_initialize_excitation(v, p, (bpf==NULL)?0:bpf->length);
+     HTS_Vocoder_initialize_excitation(v, p, bpf);
       if (v->stage == 0) {      /* for MCP */
          HTS_mc2b(spectrum, v->c, m, alpha);
       } else {                  /* for LSP */
@@ -985,8 +1007,13 @@ void HTS_Vocoder_synthesize(HTS_Vocoder * v, size_t m, double lf0, double *spect
          v->cinc[i] = (v->cc[i] - v->c[i]) / v->fprd;
    }
 
+   if (v->excite_buff_size > 0)
+      HTS_Vocoder_excite_frame(v);
    for (j = 0; j < v->fprd; j++) {
-     x = HTS_Vocoder_get_excitation(v);
+      if (v->excite_buff_size > 0)
+         x = v->excite_frame[j];
+      else
+         x = HTS_Vocoder_get_excitation(v);
       if (v->stage == 0) {      /* for MCP */
          if (x != 0.0)
             x *= exp(v->c[0]);
@@ -1019,6 +1046,39 @@ void HTS_Vocoder_synthesize(HTS_Vocoder * v, size_t m, double lf0, double *spect
    HTS_movem(v->cc, v->c, m + 1);
 }
 
+/* HTS_Vocoder_synthesize_silence: output a frame of silence instead of filtering the excitation */
+void HTS_Vocoder_synthesize_silence(HTS_Vocoder * v, size_t m, double *spectrum, BPF * bpf, double alpha, HTS_Audio * audio)
+{
+   size_t i, j, d1_size;
+
+   if (v->is_first == TRUE) {
+      HTS_Vocoder_initialize_excitation(v, 0.0, bpf);
+      v->is_first = FALSE;
+   }
+   /* the next frame starts from the spectrum of this one, as it would after a synthesized frame */
+   if (v->stage == 0) {         /* for MCP */
+      HTS_mc2b(spectrum, v->c, m, alpha);
+      d1_size = m * PADEORDER + 5 * PADEORDER + 3;
+   } else {                     /* for LSP */
+      HTS_movem(spectrum, v->c, m + 1);
+      HTS_check_lsp_stability(v->c, m);
+      HTS_lsp2mgc(v, v->c, v->c, m, alpha);
+      HTS_mc2b(v->c, v->c, m, alpha);
+      HTS_gnorm(v->c, v->c, m, v->gamma);
+      for (i = 1; i <= m; i++)
+         v->c[i] *= v->gamma;
+      d1_size = (m + 1) * v->stage;
+   }
+   /* nothing rings from before the pause */
+   memset(v->d1, 0, d1_size * sizeof(double));
+   v->pitch_of_curr_point = 0.0;
+   v->pitch_counter = 0.0;
+   v->pitch_inc_per_point = 0.0;
+   if (audio)
+      for (j = 0; j < v->fprd; j++)
+         HTS_Audio_write(audio, 0);
+}
+
 /* HTS_Vocoder_clear: clear vocoder */
 void HTS_Vocoder_clear(HTS_Vocoder * v)
 {
@@ -1059,9 +1119,22 @@ void HTS_Vocoder_clear(HTS_Vocoder * v)
          HTS_free(v->pulses_ring_buff);
          v->pulses_ring_buff = NULL;
       }
-      if (v->noise_ring_buff != NULL) {
-        HTS_free(v->noise_ring_buff);
-        v->noise_ring_buff = NULL;
+      v->num_pulse_slots = 0;
+      if (v->pulse_slots != NULL) {
+         HTS_free(v->pulse_slots);
+         v->pulse_slots = NULL;
+      }
+      if (v->noise_buff != NULL) {
+         HTS_free(v->noise_buff);
+         v->noise_buff = NULL;
+      }
+      if (v->excite_frame != NULL) {
+         HTS_free(v->excite_frame);
+         v->excite_frame = NULL;
+      }
+      if (v->band_sum != NULL) {
+         HTS_free(v->band_sum);
+         v->band_sum = NULL;
       }
       if (v->pulse_filter != NULL) {
          HTS_free(v->pulse_filter);
@@ -126,6 +126,12 @@ typedef struct
   char const * const * RHVoice_get_voice_profiles(RHVoice_tts_engine tts_engine);
   int RHVoice_are_languages_compatible(RHVoice_tts_engine tts_engine,const char* language1,const char* language2);
 
+  /* Rereads the configuration file and the user dictionaries. */
+  /* Sentences which are already being synthesized are finished */
+  /* with the old ones. The voices stay loaded. Returns 0 on */
+  /* failure. */
+  int RHVoice_reload(RHVoice_tts_engine tts_engine);
+
   /* Text should be a valid utf-8 string */
   RHVoice_message RHVoice_new_message(RHVoice_tts_engine tts_engine,const char* text,unsigned int length,RHVoice_message_type message_type,const RHVoice_synth_params* synth_params,void* user_data);
 
@@ -133,10 +139,38 @@ typedef struct
   /* so wchar_t will always mean utf-16 there */
   RHVoice_message RHVoice_new_message_w(RHVoice_tts_engine tts_engine,const wchar_t* text,unsigned int length,RHVoice_message_type message_type,const RHVoice_synth_params* synth_params,void* user_data);
 
+  /* A message whose utf-8 text is supplied in chunks. Only plain text */
+  /* and characters are supported. RHVoice_speak may be called from */
+  /* another thread before the input is complete: it starts speaking */
+  /* as soon as the end of the first sentence is known and returns */
+  /* after the text received before RHVoice_finish_message has been spoken. */
+  /* A chunk may end in the middle of a multibyte character. */
+  RHVoice_message RHVoice_new_incremental_message(RHVoice_tts_engine tts_engine,RHVoice_message_type message_type,const RHVoice_synth_params* synth_params,void* user_data);
+  int RHVoice_append_to_message(RHVoice_message message,const char* text,unsigned int length);
+  int RHVoice_finish_message(RHVoice_message message);
+
   void RHVoice_delete_message(RHVoice_message message);
 
   int RHVoice_speak(RHVoice_message message);
 
+  /* May be called from any thread while RHVoice_speak is running. */
+  /* The synthesis stops within a few milliseconds of work, no more */
+  /* speech or events are sent and RHVoice_speak returns 0. The */
+  /* message cannot be spoken again. */
+  int RHVoice_cancel(RHVoice_message message);
+
+  /* Optional. The function will be called at the start of each phone, */
+  /* including pauses, with the name of the phone in the phone set of */
+  /* the language. Mostly useful with RHVoice_synth_flag_timing_only. */
+  /* Set before speaking. Returns 0 on failure. */
+  int RHVoice_set_phone_callback(RHVoice_message message,int (*phone_starts)(const char* name,void* user_data));
+
+  /* Synthesizes several complete messages, distributing their */
+  /* sentences over num_threads worker threads (0 means one per core). */
+  /* The callbacks of each message are still called from the calling */
+  /* thread, in the order of the messages and of their sentences. */
+  int RHVoice_speak_batch(RHVoice_message* messages,unsigned int count,unsigned int num_threads);
+
 #ifdef __cplusplus
 }
 #endif
@@ -47,6 +47,19 @@ typedef enum
   } RHVoice_log_level;
 
 typedef enum {
-              RHVoice_synth_flag_dont_clip_rate=1
+              RHVoice_synth_flag_dont_clip_rate=1,
+              /* Only predict the durations and report the events. */
+              /* No speech is produced: play_speech receives a null pointer */
+              /* and the number of samples the speech would take. */
+              RHVoice_synth_flag_timing_only=2,
+              /* The speech is rendered to a file rather than played, */
+              /* so only the total time matters. Each sentence is sent */
+              /* to the client at once, after its parts between the */
+              /* pauses have been vocoded in parallel. Every part starts */
+              /* with an empty pulse ring and its own noise, so the */
+              /* output is not bit-identical to the one without the flag: */
+              /* the unvoiced frames and the first voiced frames after */
+              /* each pause differ. */
+              RHVoice_synth_flag_offline=4
 } RHVoice_synth_flag;
 #endif
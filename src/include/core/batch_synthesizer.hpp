@@ -0,0 +1,136 @@
+/* Copyright (C) 2026  RHVoice contributors */
+
+/* This program is free software: you can redistribute it and/or modify */
+/* it under the terms of the GNU Lesser General Public License as published by */
+/* the Free Software Foundation, either version 2.1 of the License, or */
+/* (at your option) any later version. */
+
+/* This program is distributed in the hope that it will be useful, */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+/* GNU Lesser General Public License for more details. */
+
+/* You should have received a copy of the GNU Lesser General Public License */
+/* along with this program.  If not, see <https://www.gnu.org/licenses/>. */
+
+#ifndef RHVOICE_BATCH_SYNTHESIZER_HPP
+#define RHVOICE_BATCH_SYNTHESIZER_HPP
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include "client.hpp"
+#include "document.hpp"
+
+namespace RHVoice
+{
+  // Stores everything the synthesizer sends to a client, so that it
+  // can be passed on to the real client later.
+  class speech_recorder: public client
+  {
+  public:
+    explicit speech_recorder(const client& target_):
+      target(target_),
+      recorded_sample_rate(0)
+    {
+    }
+
+    unsigned int get_audio_buffer_size() const
+    {
+      return target.get_audio_buffer_size();
+    }
+
+    event_mask get_supported_events() const
+    {
+      return target.get_supported_events();
+    }
+
+    bool play_speech(const short* samples,std::size_t count);
+    bool skip_speech(std::size_t count);
+    bool process_mark(const std::string& name);
+    bool play_audio(const std::string& src);
+    bool set_sample_rate(int sample_rate);
+    bool sentence_starts(std::size_t position,std::size_t length);
+    bool sentence_ends(std::size_t position,std::size_t length);
+    bool word_starts(std::size_t position,std::size_t length);
+    bool word_ends(std::size_t position,std::size_t length);
+    bool phone_starts(const std::string& name);
+
+    bool replay(client& c) const;
+
+  private:
+    enum record_type
+      {
+        record_speech,
+        record_skip,
+        record_mark,
+        record_audio,
+        record_sentence_starts,
+        record_sentence_ends,
+        record_word_starts,
+        record_word_ends,
+        record_phone_starts
+      };
+
+    struct record
+    {
+      record_type type;
+      std::size_t start,count;
+      std::string name;
+    };
+
+    void add(record_type type,std::size_t start,std::size_t count,const std::string& name=std::string());
+
+    const client& target;
+    int recorded_sample_rate;
+    std::vector<short> samples;
+    std::vector<record> records;
+  };
+
+  // Synthesizes the sentences of one or more documents on a pool of
+  // worker threads. All the workers share the engine and its model
+  // pools. The output of each sentence is recorded separately and
+  // passed on to the owner of its document in the original order
+  // from the thread which called run.
+  class batch_synthesizer
+  {
+  public:
+    // 0 means one thread per hardware core
+    explicit batch_synthesizer(unsigned int num_threads_=0);
+
+    void add(document& doc);
+    void run();
+
+  private:
+    batch_synthesizer(const batch_synthesizer&);
+    batch_synthesizer& operator=(const batch_synthesizer&);
+
+    struct task
+    {
+      std::size_t doc_index;
+      document::iterator sentence_iter;
+      sentence_position pos;
+      bool last_in_document;
+      std::unique_ptr<speech_recorder> recorder;
+      std::exception_ptr error;
+      bool ready;
+    };
+
+    void prepare_tasks();
+    void work();
+    void deliver(task& t);
+
+    unsigned int num_threads;
+    std::vector<document*> documents;
+    std::vector<bool> stopped_documents;
+    std::vector<task> tasks;
+    std::size_t next_task,next_delivery,window;
+    bool aborted;
+    std::mutex task_mutex;
+    std::condition_variable task_done,delivery_done;
+  };
+}
+#endif
@@ -0,0 +1,61 @@
+/* Copyright (C) 2026  RHVoice contributors */
+
+/* This program is free software: you can redistribute it and/or modify */
+/* it under the terms of the GNU Lesser General Public License as published by */
+/* the Free Software Foundation, either version 2.1 of the License, or */
+/* (at your option) any later version. */
+
+/* This program is distributed in the hope that it will be useful, */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+/* GNU Lesser General Public License for more details. */
+
+/* You should have received a copy of the GNU Lesser General Public License */
+/* along with this program.  If not, see <https://www.gnu.org/licenses/>. */
+
+#ifndef RHVOICE_CANCELLATION_HPP
+#define RHVOICE_CANCELLATION_HPP
+
+#include <atomic>
+#include "cancellation.h"
+
+namespace RHVoice
+{
+  // Lets another thread stop the processing of a document. It is
+  // checked between the passes of the text analysis, between the
+  // labels and streams in the HTS engine and before each frame of
+  // speech, so that no step runs long after a cancellation.
+  class cancellation_token
+  {
+  public:
+    cancellation_token():
+      cancelled(false)
+    {
+    }
+
+    void cancel()
+    {
+      cancelled.store(true);
+    }
+
+    bool is_cancelled() const
+    {
+      return cancelled.load(std::memory_order_relaxed);
+    }
+
+    // For the HTS engine
+    RHVoice_cancellation_token_t get_c_token() const
+    {
+      RHVoice_cancellation_token_t result;
+      result.impl=this;
+      return result;
+    }
+
+  private:
+    cancellation_token(const cancellation_token&);
+    cancellation_token& operator=(const cancellation_token&);
+
+    std::atomic<bool> cancelled;
+  };
+}
+#endif
@@ -28,7 +28,8 @@ namespace RHVoice
       event_sentence_starts=8,
       event_sentence_ends=16,
       event_audio=32,
-event_done=64
+event_done=64,
+      event_phone_starts=128
     };
   typedef unsigned int event_mask;
 
@@ -49,6 +50,13 @@ event_done=64
       return true;
     }
 
+    // In the timing-only mode, the time advances by this number of
+    // samples without any speech
+    virtual bool skip_speech(std::size_t count)
+    {
+      return true;
+    }
+
     virtual event_mask get_supported_events() const
     {
       return 0;
@@ -89,6 +97,11 @@ event_done=64
       return true;
     }
 
+    virtual bool phone_starts(const std::string& name)
+    {
+      return true;
+    }
+
     virtual void done()
     {
 }
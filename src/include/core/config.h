@@ -0,0 +1,9 @@
+#pragma once
+
+#ifndef RHVOICE_GLOBAL_CONFIG_INCLUDED
+#define RHVOICE_GLOBAL_CONFIG_INCLUDED
+#define ENABLE_SONIC 0
+#define ENABLE_PKG 0
+
+const char VERSION[] = "";
+#endif
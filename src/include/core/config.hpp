@@ -22,6 +22,8 @@
 #include <string>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <functional>
 
 #include "str.hpp"
 #include "property.hpp"
@@ -35,20 +37,44 @@ namespace RHVoice
     typedef std::map<std::string,abstract_property*,str::less> registration_map;
     registration_map registered_settings;
     std::shared_ptr<event_logger> logger;
+    const bool shared;
+    std::size_t slot_count;
+    shared_setting_values values;
+    // The changes made through set and reset. They are applied again
+    // over every snapshot read from a file, so a reload keeps them.
+    std::map<std::size_t,std::shared_ptr<const void> > overrides;
+    std::mutex update_mutex;
 
     config(const config&);
     config& operator=(const config&);
 
+    void read_file(const std::string& file_path,const std::function<void(const std::string&,const std::string&)>& callback) const;
+    std::shared_ptr<setting_values> copy_values() const;
+    void store_values(const std::shared_ptr<const setting_values>& new_values);
+
   public:
 
-    config():
-      logger(new event_logger)
+    // The settings of a shared configuration can be changed while
+    // other threads are reading them. They take their values from
+    // immutable snapshots, and every change publishes a new one.
+    explicit config(bool shared_=false):
+      logger(new event_logger),
+      shared(shared_),
+      slot_count(0)
     {
+      if(shared)
+        store_values(std::make_shared<setting_values>(&values));
     }
 
     void register_setting(abstract_property& setting,const std::string& prefix="")
     {
       registered_settings.insert(registration_map::value_type(prefix.empty()?setting.get_name():(prefix+"."+setting.get_name()),&setting));
+      if(shared&&(setting.shared_values==0))
+        {
+          setting.shared_values=&values;
+          setting.slot=slot_count;
+          ++slot_count;
+        }
     }
 
     bool set(const std::string& name,const std::string& value);
@@ -58,6 +84,18 @@ namespace RHVoice
 
     void load(const std::string& file_path);
 
+    // Only for shared configurations: reads the file into a new
+    // snapshot, which can be completed and then published. The values
+    // set and reset since the configuration was created are put over
+    // the ones from the file when the snapshot is published.
+    std::shared_ptr<setting_values> read(const std::string& file_path) const;
+    void publish(const std::shared_ptr<setting_values>& new_values);
+
+    std::shared_ptr<const setting_values> get_values() const
+    {
+      return std::atomic_load(&values.current);
+    }
+
     void set_logger(const std::shared_ptr<event_logger>& logger_)
     {
       logger=logger_;
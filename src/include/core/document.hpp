@@ -17,11 +17,14 @@
 #include <memory>
 #include <string>
 #include <vector>
+#include <ostream>
 #include <list>
 #include <algorithm>
 #include <functional>
 #include <iterator>
 #include <stdexcept>
+#include <mutex>
+#include <condition_variable>
 
 #include "engine.hpp"
 #include "voice_profile.hpp"
@@ -33,6 +36,7 @@
 #include "client.hpp"
 #include "params.hpp"
 #include "quality_setting.hpp"
+#include "cancellation.hpp"
 #include "emoji.hpp"
 
 #ifndef RHVOICE_DOCUMENT_HPP
@@ -92,6 +96,11 @@ namespace RHVoice
       }
 
       virtual void set_eos() {}
+
+      virtual void print(std::ostream& out) const
+      {
+        out << get_type();
+      }
     };
 
     typedef std::shared_ptr<abstract_command> command_ptr;
@@ -121,6 +130,7 @@ namespace RHVoice
       void set_eos() {eos=true;}
 
       void execute(utterance& u) const;
+      void print(std::ostream& out) const;
 
     protected:
       std::string name,whitespace;
@@ -178,6 +188,11 @@ namespace RHVoice
         u.get_relation("Event",true).append().set("mark",name);
       }
 
+      void print(std::ostream& out) const
+      {
+        out << "mark " << name;
+      }
+
       bool has_text() const
       {
         return false;
@@ -209,6 +224,11 @@ namespace RHVoice
         u.get_language().on_token_break(u);
       }
 
+      void print(std::ostream& out) const
+      {
+        out << "audio " << src;
+      }
+
       bool has_text() const
       {
         return false;
@@ -298,6 +318,9 @@ namespace RHVoice
 
     bool has_text() const;
     bool notify_client();
+    // Writes the commands of the sentence one per line, for comparing
+    // the results of different ways of parsing the same text
+    void print(std::ostream& out) const;
 
   private:
     template<typename text_iterator>
@@ -380,6 +403,17 @@ namespace RHVoice
       flags=value;
 }
 
+    bool is_incremental() const
+    {
+      return incremental;
+    }
+
+    // The offset of the text currently being parsed from the start of an incrementally received input
+    std::size_t get_input_offset() const
+    {
+      return input_offset;
+    }
+
     template<typename some_iterator>
     static std::unique_ptr<document> create_from_plain_text(const std::shared_ptr<engine>& engine_ptr,const some_iterator& text_start,const some_iterator& text_end,content_type say_as=content_text,const voice_profile& profile=voice_profile())
     {
@@ -393,6 +427,16 @@ namespace RHVoice
     template<typename input_iterator>
     static std::unique_ptr<document> create_from_ssml(const std::shared_ptr<engine>& engine_ptr,const input_iterator& text_start,const input_iterator& text_end,const voice_profile& profile=voice_profile());
 
+    // A document which receives its utf-8 text in chunks. synthesize
+    // can run in another thread while the text is still arriving: it
+    // starts as soon as the end of the first sentence is certain and
+    // returns after finish_input has been called and the last
+    // sentence has been spoken.
+    static std::unique_ptr<document> create_incremental(const std::shared_ptr<engine>& engine_ptr,content_type say_as=content_text,const voice_profile& profile=voice_profile());
+
+    void append_text(const char* text,std::size_t size);
+    void finish_input();
+
     typedef std::list<sentence>::iterator iterator;
     typedef std::list<sentence>::const_iterator const_iterator;
 
@@ -444,7 +488,26 @@ namespace RHVoice
 
     void synthesize();
 
+    // Can be called from any thread. synthesize returns as soon as
+    // the current step notices it, without the done event.
+    void cancel();
+
+    bool is_cancelled() const
+    {
+      return cancellation.is_cancelled();
+    }
+
+    const cancellation_token& get_cancellation_token() const
+    {
+      return cancellation;
+    }
+
   private:
+    bool synthesize_sentence(sentence& s,sentence_position pos);
+    void synthesize_incrementally();
+    std::string::size_type get_complete_input_size() const;
+    void parse_input(std::string::size_type size);
+
     sentence& get_current_sentence()
     {
       if(current_sentence==sentences.end())
@@ -490,6 +553,15 @@ namespace RHVoice
     std::list<sentence>::iterator current_sentence;
     voice_profile profile;
     int flags;
+    cancellation_token cancellation;
+    // Incremental input
+    bool incremental{false};
+    bool input_finished{false};
+    content_type input_type{content_text};
+    std::string input_buffer;
+    std::size_t input_offset{0};
+    std::mutex input_mutex;
+    std::condition_variable input_available;
   };
 
   template<typename text_iterator>
@@ -509,7 +581,7 @@ namespace RHVoice
     next_token.type=markup_info.say_as;
     next_token.text.clear();
     next_token.whitespace.clear();
-    next_token.position=text_start.offset();
+    next_token.position=parent->get_input_offset()+text_start.offset();
     next_token.length=0;
     if(text_start==text_end)
       return text_start;
@@ -552,7 +624,7 @@ namespace RHVoice
 }
       }
     next_token.text.assign(text_start,token_end);
-    next_token.length=token_end.offset()-next_token.position;
+    next_token.length=token_end.offset()-text_start.offset();
     return token_end;
   }
 
@@ -576,7 +648,10 @@ namespace RHVoice
     text_iterator token_end;
     voice_list::const_iterator token_voice=voices.end();
     std::size_t old_length=length;
-    do
+    // The limits are checked before each token, so that a sentence
+    // which has reached one of them at the end of the previous chunk
+    // of the text is not extended by the next one
+    while((sentence_end!=text_end)&&(prev_token.text.size()<max_token_length)&&(length<max_sentence_length)&&(num_tokens<max_tokens))
       {
         sentence_end=skip_whitespace(sentence_end,text_end,markup_info);
         if(sentence_end==text_end)
@@ -618,7 +693,6 @@ namespace RHVoice
         ++num_tokens;
         sentence_end=token_end;
       }
-    while((sentence_end!=text_end)&&(prev_token.text.size()<max_token_length)&&(length<max_sentence_length)&&(num_tokens<max_tokens));
     if(length>old_length)
       {
         if(old_length==0)
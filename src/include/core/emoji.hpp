@@ -16,7 +16,7 @@
 #ifndef RHVOICE_EMOJI_HPP
 #define RHVOICE_EMOJI_HPP
 
-#include <memory>
+#include <cstddef>
 #include "utf8.h"
 
 namespace RHVoice
@@ -52,32 +52,6 @@ emoji_property_extended_pictographic=32
   const utf8::uint32_t emoji_presentation_selector=0xfe0f;
   const utf8::uint32_t zwj=0x200d;
 
-  class emoji_scanner_state
-  {
-  public:
-    emoji_scanner_state()
-    {
-}
-
-    virtual ~emoji_scanner_state()
-    {
-}
-
-    virtual bool can_end_emoji() const
-    {
-      return false;
-}
-
-    virtual std::unique_ptr<emoji_scanner_state> next(emoji_char_t c) const
-    {
-      return std::unique_ptr<emoji_scanner_state>();
-}
-
-  private:
-    emoji_scanner_state(const emoji_scanner_state&);
-    emoji_scanner_state& operator=(const emoji_scanner_state&);
-  };
-
   class emoji_scanner
   {
   public:
@@ -97,7 +71,8 @@ emoji_property_extended_pictographic=32
     bool process(utf8::uint32_t c);
 
   private:
-    std::unique_ptr<emoji_scanner_state> state;
+    // An index into the transition table generated by import-emoji
+    unsigned char state;
     std::size_t result;
     std::size_t length;
   };
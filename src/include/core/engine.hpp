@@ -19,6 +19,7 @@
 #include <string>
 #include <map>
 #include <set>
+#include <mutex>
 #include "exception.hpp"
 #include "params.hpp"
 #include "language.hpp"
@@ -142,12 +143,41 @@ namespace RHVoice
 
     voice_profile get_fallback_voice_profile() const;
 
+    hts_engine_pool_stats get_engine_pool_stats() const
+    {
+      return engine_pools->get_stats();
+    }
+
+    // Rereads the configuration file and the user dictionaries of the
+    // languages which are in use. They are built while the synthesis
+    // goes on and published together as one snapshot, which the
+    // utterances started afterwards use. The settings changed through
+    // configure keep their values. The voices and their model pools
+    // are kept. The set of voice profiles is not changed.
+    void reload();
+
+    // Held while an utterance is being processed, so that all of it
+    // uses the settings and dictionaries which were current when it
+    // started
+    class utterance_scope
+    {
+    public:
+      explicit utterance_scope(const engine& e);
+
+    private:
+      utterance_scope(const utterance_scope&);
+      utterance_scope& operator=(const utterance_scope&);
+
+      setting_values::scope scope;
+    };
+
   private:
     engine(const engine&);
     engine& operator=(const engine&);
 
     string_property voice_profiles_spec;
     std::string data_path,config_path,version;
+    std::shared_ptr<hts_engine_pool_manager> engine_pools;
     language_list languages;
     voice_list voices;
     std::set<voice_profile> voice_profiles;
@@ -158,6 +188,9 @@ namespace RHVoice
     #endif
 
     void create_voice_profiles();
+    std::string get_config_file_path() const;
+
+    std::mutex reload_mutex;
 
   public:
     voice_params voice_settings;
@@ -166,6 +199,7 @@ namespace RHVoice
     bool_property prefer_primary_language;
     bool_property enable_bilingual;
     quality_setting quality;
+    engine_pool_params engine_pool_settings;
     stream_params stream_settings;
   };
 }
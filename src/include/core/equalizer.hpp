@@ -16,7 +16,7 @@
 #ifndef RHVOICE_EQUALIZER_HPP
 #define RHVOICE_EQUALIZER_HPP
 
-#include <list>
+#include <vector>
 #include <array>
 #include <string>
 #include <iostream>
@@ -30,7 +30,8 @@ public:
   equalizer(const std::string& path);
   equalizer(const equalizer&)=delete;
   equalizer& operator=(const equalizer&)=delete;
-  double apply(double x);
+  // Filters a block in place, one section at a time
+  void apply(float* samples, std::size_t count);
   void reset();
 
 private:
@@ -41,30 +42,21 @@ private:
 
   struct section_t
   {
-    const double b0, b1, b2, a1, a2;
-    const double& x0;
-    const double& x1;
-    const double& x2;
-    double y0{0}, y1{0}, y2{0};
+    double b0, b1, b2, a1, a2;
+    double x1{0}, x2{0}, y1{0}, y2{0};
 
-    section_t(const coefs_t cs, const double& i0, const double& i1, const double& i2):
+    explicit section_t(const coefs_t& cs):
       b0(cs[0]),
       b1(cs[1]),
       b2(cs[2]),
       a1(cs[4]),
-      a2(cs[5]),
-      x0(i0),
-      x1(i1),
-      x2(i2)
+      a2(cs[5])
     {
     }
   };
 
   unsigned int version{0};
-  double x0{0};
-  double x1{0};
-  double x2{0};
-  std::list<section_t> sections;
+  std::vector<section_t> sections;
 };
 }
 #endif
@@ -16,7 +16,7 @@
 #ifndef RHVOICE_EVENTS_HPP
 #define RHVOICE_EVENTS_HPP
 
-#include <list>
+#include <vector>
 
 #include "client.hpp"
 #include "hts_label.hpp"
@@ -30,37 +30,41 @@ namespace RHVoice
   {
   public:
     typedef std::shared_ptr<event> pointer;
-    typedef label_sequence::const_iterator position;
 
-    virtual ~event()
+    event():
+      labels(0),
+      label_index(0)
     {
     }
 
-    position get_position() const
+    virtual ~event()
     {
-      return pos;
     }
 
-    void set_position(position pos_)
+    // The event follows this label. The labels are referred to by
+    // index, since adding more of them may move the others.
+    void set_position(const label_sequence& labels_,std::size_t index)
     {
-      pos=pos_;
+      labels=&labels_;
+      label_index=index;
     }
 
     int get_time() const
     {
-      if(pos==position())
+      if(labels==0)
         return 0;
-      else
-        return (pos->get_time()+pos->get_duration());
+      const hts_label& lab=(*labels)[label_index];
+      return (lab.get_time()+lab.get_duration());
     }
 
     virtual bool notify(client& c) const=0;
 
   private:
-    position pos;
+    const label_sequence* labels;
+    std::size_t label_index;
   };
 
-  typedef std::list<event::pointer> event_sequence;
+  typedef std::vector<event::pointer> event_sequence;
 
   class text_unit_event: public event
   {
@@ -151,6 +155,23 @@ namespace RHVoice
     }
   };
 
+  class phone_starts_event: public event
+  {
+  public:
+    explicit phone_starts_event(const item& seg):
+      name(seg.get("name").as<std::string>())
+    {
+    }
+
+    bool notify(client& c) const
+    {
+      return c.phone_starts(name);
+    }
+
+  private:
+    std::string name;
+  };
+
   class mark_event: public event
   {
   public:
@@ -35,10 +35,13 @@ namespace RHVoice
   {
   public:
     explicit fst(const std::string& path);
-    
+
+    typedef uint16_t symbol_id;
+    // Unknown input symbols, and outputs which copy the input symbol
+    static const symbol_id copy_symbol=1;
+
   private:
     typedef uint32_t state_id;
-    typedef uint16_t symbol_id;
 
     class symbol_not_found: public lookup_error
     {
@@ -57,10 +60,32 @@ namespace RHVoice
       std::string name(symbol_id id,const std::string& default_name) const;
       symbol_id id(const std::string& name) const;
       symbol_id id(const std::string& name,symbol_id default_id) const;
+
+      symbol_id id(utf8::uint32_t cp) const
+      {
+        if(cp<cps_to_ids.size())
+          return cps_to_ids[cp];
+        std::vector<std::pair<utf8::uint32_t,symbol_id> >::const_iterator it=std::lower_bound(other_cps_to_ids.begin(),other_cps_to_ids.end(),std::pair<utf8::uint32_t,symbol_id>(cp,0));
+        return (((it!=other_cps_to_ids.end())&&(it->first==cp))?it->second:copy_symbol);
+      }
+
+      const std::string& name_ref(symbol_id id) const;
+
+      bool is_single_char(symbol_id id) const
+      {
+        return ((id>=2)&&(id<(single_char_flags.size()+2))&&single_char_flags[id-2]);
+      }
+
     private:
       typedef std::map<std::string,symbol_id> symbol_map;
       std::vector<std::string> ids_to_names;
       symbol_map names_to_ids;
+      // Symbols consisting of one character, indexed directly for the
+      // commonly used part of the bmp
+      static const utf8::uint32_t max_direct_cp=0x3000;
+      std::vector<symbol_id> cps_to_ids;
+      std::vector<std::pair<utf8::uint32_t,symbol_id> > other_cps_to_ids;
+      std::vector<bool> single_char_flags;
     };
 
     struct arc
@@ -165,6 +190,7 @@ namespace RHVoice
       arc_iterator current_arc;
     };
 
+    template<class input_iterator,class id_getter> bool find_path(input_iterator first,input_iterator last,id_getter get_id,std::vector<arc_filter>& path) const;
     template<class output_iterator> bool do_translate(const input_symbols& input,output_iterator output) const;
     void append_input_symbol(const std::string& name,input_symbols& dest) const
     {
@@ -185,26 +211,75 @@ namespace RHVoice
 
   public:
     template<class input_iterator,class output_iterator> bool translate(input_iterator first,input_iterator last,output_iterator output) const;
+
+    symbol_id get_symbol_id(utf8::uint32_t cp) const
+    {
+      return symbols.id(cp);
+    }
+
+    symbol_id get_symbol_id(const std::string& name) const
+    {
+      return symbols.id(name,copy_symbol);
+    }
+
+    const std::string& get_symbol_name(symbol_id id) const
+    {
+      return symbols.name_ref(id);
+    }
+
+    bool is_single_char_symbol(symbol_id id) const
+    {
+      return symbols.is_single_char(id);
+    }
+
+    // Input and output of a translation over pre-resolved symbol ids.
+    // It is meant to be reused, so that repeated translations don't
+    // allocate memory once the buffers have grown large enough.
+    class id_translation
+    {
+    public:
+      struct output_symbol
+      {
+        // copy_symbol means the input symbol at input_pos is copied
+        symbol_id id;
+        std::size_t input_pos;
+      };
+
+      std::vector<symbol_id> input;
+      std::vector<output_symbol> output;
+
+      void clear()
+      {
+        input.clear();
+        output.clear();
+      }
+
+    private:
+      friend class fst;
+      std::vector<arc_filter> path;
+    };
+
+    bool translate(id_translation& t) const;
   };
 
-  template<class output_iterator>
-  bool fst::do_translate(const input_symbols& input,output_iterator output) const
+  template<class input_iterator,class id_getter>
+  bool fst::find_path(input_iterator first,input_iterator last,id_getter get_id,std::vector<arc_filter>& path) const
   {
+    path.clear();
     if(states.empty())
       return false;
-    input_symbols::const_iterator pos=input.begin();
-    if(pos==input.end())
+    input_iterator pos=first;
+    if(pos==last)
       return false;
-    arc_filter f(states.begin(),pos->second);
+    arc_filter f(states.begin(),get_id(*pos));
     if(f.done())
       return false;
-    std::vector<arc_filter> path;
     path.push_back(f);
     if(f.get().isymbol!=0)
       ++pos;
     while(!path.empty())
       {
-        if(pos==input.end())
+        if(pos==last)
           {
             if(states[path.back().get().target].is_final())
               break;
@@ -212,7 +287,7 @@ namespace RHVoice
               f=arc_filter(states.begin()+path.back().get().target,0);
           }
         else
-          f=arc_filter(states.begin()+path.back().get().target,pos->second);
+          f=arc_filter(states.begin()+path.back().get().target,get_id(*pos));
         if(f.done())
           {
             while(!path.empty())
@@ -237,9 +312,16 @@ namespace RHVoice
               ++pos;
           }
       }
-    if((pos!=input.end())||path.empty()||(!states[path.back().get().target].is_final()))
+    return ((pos==last)&&!path.empty()&&states[path.back().get().target].is_final());
+  }
+
+  template<class output_iterator>
+  bool fst::do_translate(const input_symbols& input,output_iterator output) const
+  {
+    std::vector<arc_filter> path;
+    if(!find_path(input.begin(),input.end(),[](const input_symbols::value_type& s) {return s.second;},path))
       return false;
-    pos=input.begin();
+    input_symbols::const_iterator pos=input.begin();
     for(std::vector<arc_filter>::const_iterator it=path.begin();it!=path.end();++it)
       {
         if(it->get().osymbol!=0)
@@ -47,6 +47,7 @@ namespace RHVoice
 
     void set_input();
     void set_output();
+    bool report_timing();
 
     void add_label(const item& seg);
 
@@ -27,6 +27,7 @@
 #include "quality_setting.hpp"
 #include "pitch.hpp"
 #include "equalizer.hpp"
+#include "cancellation.hpp"
 
 struct _HTS_Audio;
 extern "C" void HTS_Audio_write(_HTS_Audio * audio, short sample);
@@ -97,6 +98,8 @@ namespace RHVoice
     }
 
     void synthesize();
+    // Only sets the times of the labels, nothing is sent to the output
+    void predict_timing();
     void reset();
 
     sample_rate_t get_sample_rate() const
@@ -109,6 +112,23 @@ namespace RHVoice
       rate=value;
     }
 
+    // How much speech the client wants at a time, in milliseconds
+    void set_audio_buffer_size(unsigned int value)
+    {
+      audio_buffer_size=value;
+    }
+
+    // The client does not need the speech as soon as possible
+    void set_offline(bool value)
+    {
+      offline=value;
+    }
+
+    void set_cancellation_token(const cancellation_token* token)
+    {
+      cancellation=token;
+    }
+
     double get_gain() const
     {
       return gain;
@@ -123,6 +143,17 @@ namespace RHVoice
 
     bool uses_eq() const {return (eq!=nullptr);}
 
+    quality_t get_quality() const
+    {
+      return quality;
+    }
+
+    // Roughly the memory taken by the models of this instance
+    std::size_t get_memory_size() const
+    {
+      return memory_size;
+    }
+
   protected:
     explicit hts_engine_impl(const std::string& name,const voice_info& info_);
     virtual sample_rate_t get_sample_rate_for_quality(quality_t q) const;
@@ -140,15 +171,24 @@ namespace RHVoice
     numeric_property<double> emph_shift;
     numeric_property<double> base_pitch_shift;
     std::unique_ptr<equalizer> eq;
+    std::size_t memory_size{0};
 
     double get_emph_shift() const
     {
       return std::log(2.0)*emph_shift/12.0;
 }
 
+    bool is_cancelled() const
+    {
+      return (cancellation&&cancellation->is_cancelled());
+    }
+
     hts_input* input;
     speech_processing_chain* output;
     double rate;
+    unsigned int audio_buffer_size;
+    bool offline;
+    const cancellation_token* cancellation;
     double pitch_shift;
     pitch::editor pitch_editor;
 
@@ -157,6 +197,7 @@ namespace RHVoice
     hts_engine_impl& operator=(const hts_engine_impl&);
 
     void on_new_sample(short sample);
+    void flush_samples();
 
     void load_configs();
 
@@ -164,6 +205,7 @@ namespace RHVoice
     virtual pointer do_create() const=0;
     virtual void do_initialize()=0;
     virtual void do_synthesize()=0;
+    virtual void do_predict_timing()=0;
     virtual void do_reset()=0;
 
     virtual void do_stop()
@@ -171,6 +213,8 @@ namespace RHVoice
 }
 
     std::string name;
+    // The samples are passed to the output in blocks
+    std::vector<float> samples;
   };
 }
 #endif
@@ -19,58 +19,107 @@
 
 #include <string>
 #include <list>
+#include <deque>
+#include <vector>
+#include <memory>
 #include "threading.hpp"
+#include "params.hpp"
 #include "str_hts_engine_impl.hpp"
 #include "quality_setting.hpp"
 
 namespace RHVoice
 {
   class voice_info;
+  class hts_engine_pool;
 
-  class hts_engine_pool
+  struct hts_engine_pool_stats
+  {
+    // Engines taken from the pools
+    unsigned long hits{0};
+    unsigned long creations{0};
+    unsigned long evictions{0};
+    // The memory of all the engines, in use or not
+    std::size_t bytes{0};
+    std::size_t idle_bytes{0};
+    std::size_t idle_instances{0};
+  };
+
+  // Keeps the idle engines of all the voices of one RHVoice engine in
+  // the order of their last use, and frees the oldest of them when
+  // the engines take more memory than allowed. The voices always keep
+  // a few idle engines, unless there is no other way to stay within
+  // the limit.
+  class hts_engine_pool_manager
   {
   public:
-    explicit hts_engine_pool(const voice_info& info_):
-      info(info_)
+    explicit hts_engine_pool_manager(const engine_pool_params* params_=nullptr):
+      params(params_)
     {
-      prototypes.push_back(hts_engine_impl::pointer(new str_hts_engine_impl(info_)));
     }
 
+    hts_engine_pool_stats get_stats() const
+    {
+      threading::lock l(mgr_mutex);
+      return stats;
+    }
+
+  private:
+    hts_engine_pool_manager(const hts_engine_pool_manager&);
+    hts_engine_pool_manager& operator=(const hts_engine_pool_manager&);
+
+    friend class hts_engine_pool;
+
+    struct idle_engine
+    {
+      hts_engine_pool* pool;
+      hts_engine_impl::pointer engine;
+    };
+
+    typedef std::list<idle_engine> idle_list;
+    typedef std::vector<hts_engine_impl::pointer> engine_vector;
+
+    hts_engine_impl::pointer take(hts_engine_pool& pool,quality_t quality);
+    void put(hts_engine_pool& pool,const hts_engine_impl::pointer& engine);
+    void add(const hts_engine_impl::pointer& engine);
+    void remove_pool(hts_engine_pool& pool);
+    void remove(idle_list::iterator it,engine_vector& evicted);
+    void evict(engine_vector& evicted);
+
+    const engine_pool_params* params;
+    mutable threading::mutex mgr_mutex;
+    idle_list idle;
+    hts_engine_pool_stats stats;
+  };
+
+  class hts_engine_pool
+  {
+  public:
+    hts_engine_pool(const voice_info& info_,const std::shared_ptr<hts_engine_pool_manager>& mgr);
+    ~hts_engine_pool();
+
     hts_engine_impl::pointer acquire(quality_t quality)
     {
-      hts_engine_impl::pointer result(get_instance(quality));
+      hts_engine_impl::pointer result(manager->take(*this,quality));
       if(! result)
-        result=get_prototype(quality)->create(quality);
+        {
+          result=get_prototype(quality)->create(quality);
+          manager->add(result);
+        }
       return result;
     }
 
     void release(const hts_engine_impl::pointer& engine)
     {
-      threading::lock l(inst_mutex);
-      instances.push_front(engine);
+      manager->put(*this,engine);
     }
 
   private:
     hts_engine_pool(const hts_engine_pool&);
     hts_engine_pool& operator=(const hts_engine_pool&);
 
-    typedef std::list<hts_engine_impl::pointer> engine_list;
+    friend class hts_engine_pool_manager;
 
-    hts_engine_impl::pointer get_instance(quality_t quality )
-    {
-      hts_engine_impl::pointer result;
-      threading::lock l(inst_mutex);
-      for(engine_list::iterator it=instances.begin();it!=instances.end();++it)
-        {
-          if((*it)->supports_quality(quality))
-            {
-              result=*it;
-              instances.erase(it);
-              break;
-            }
-        }
-      return result;
-    }
+    typedef std::list<hts_engine_impl::pointer> engine_list;
 
     hts_engine_impl::pointer get_prototype(quality_t quality) const
     {
@@ -86,9 +135,14 @@ namespace RHVoice
       return result;
     }
 
-    engine_list prototypes,instances;
-    threading::mutex inst_mutex;
+    engine_list prototypes;
     const voice_info& info;
+    std::shared_ptr<hts_engine_pool_manager> manager;
+    // The idle engines of this voice for each quality, the most
+    // recently used ones at the back. Guarded by the mutex of the
+    // manager.
+    std::deque<hts_engine_pool_manager::idle_list::iterator> free_lists[quality_max+1];
+    std::size_t idle_count;
   };
 }
 #endif
@@ -16,6 +16,8 @@
 #ifndef RHVOICE_HTS_INPUT_HPP
 #define RHVOICE_HTS_INPUT_HPP
 
+#include <string>
+#include <vector>
 #include "item.hpp"
 #include "hts_label.hpp"
 #include "events.hpp"
@@ -47,6 +49,30 @@ namespace RHVoice
       return labels.end();
     }
 
+    std::size_t label_count() const
+    {
+      return labels.size();
+    }
+
+    const hts_label& get_label(std::size_t index) const
+    {
+      return labels[index];
+    }
+
+    // The names are evaluated when they are first needed and stored
+    // one after another in a single buffer, each followed by a null
+    // character. The pointer stays valid until another name is added.
+    const char* get_label_name(std::size_t index)
+    {
+      if(name_offsets[index]==std::string::npos)
+        {
+          name_offsets[index]=label_text.size();
+          label_text.append(labels[index].eval_name());
+          label_text.push_back('\0');
+        }
+      return (label_text.data()+name_offsets[index]);
+    }
+
     event_sequence::iterator ebegin()
     {
       return events.begin();
@@ -69,8 +95,8 @@ namespace RHVoice
 
     hts_label& add_label(const item& seg)
     {
-      hts_label lab(seg);
-      labels.push_back(lab);
+      labels.push_back(hts_label(seg));
+      name_offsets.push_back(std::string::npos);
       return labels.back();
     }
 
@@ -96,14 +122,12 @@ namespace RHVoice
     {
       events.push_back(p);
       if(!labels.empty())
-        {
-          event::position pos=labels.end();
-          --pos;
-          p->set_position(pos);
-        }
+        p->set_position(labels,labels.size()-1);
     }
 
     label_sequence labels;
+    std::vector<std::size_t> name_offsets;
+    std::string label_text;
     event_sequence events;
   };
 }
@@ -17,7 +17,7 @@
 #define RHVOICE_HTS_LABEL_HPP
 
 #include <string>
-#include <list>
+#include <vector>
 #include "item.hpp"
 #include "relation.hpp"
 #include "utterance.hpp"
@@ -38,7 +38,8 @@ namespace RHVoice
     {
     }
 
-    const std::string& get_name() const;
+    // Evaluated each time, hts_input keeps the results
+    std::string eval_name() const;
 
     double get_rate() const;
     double get_pitch() const;
@@ -96,10 +97,9 @@ namespace RHVoice
     const item* get_token() const;
 
     const item* segment;
-    mutable std::string name;
     int time,duration,position,length;
   };
 
-  typedef std::list<hts_label> label_sequence;
+  typedef std::vector<hts_label> label_sequence;
 }
 #endif
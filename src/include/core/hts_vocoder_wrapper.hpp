@@ -19,6 +19,8 @@
 #include <memory>
 #include <vector>
 #include <queue>
+#include <deque>
+#include <utility>
 #include "pitch.hpp"
 
 struct _HTS_Vocoder;
@@ -26,6 +28,8 @@ struct _HTS_Engine;
 
 namespace RHVoice
 {
+  class worker_pool;
+
   class hts_vocoder_wrapper
   {
   public:
@@ -37,25 +41,46 @@ namespace RHVoice
     void clear();
     void synth(std::size_t i, std::size_t n);
     void finish();
+    // The frames of a pause, counted from the start of the utterance.
+    // Except for a few frames at its edges, they are not filtered.
+    void add_pause(std::size_t first, std::size_t length);
+    // The frames are only collected until finish, which cuts the
+    // utterance at the pauses and vocodes the parts on the pool, each
+    // with its own vocoder. For offline rendering: the excitation is
+    // not carried across the pauses as in the serial path, so the
+    // samples differ from it.
+    void set_worker_pool(worker_pool* p)
+    {
+      pool=p;
+    }
 
   private:
+    static const std::size_t pause_margin=3;
+
+    bool is_silent(std::size_t index);
 
     void do_synth();
+    void do_parallel_synth();
 
     struct frame_t
     {
       std::size_t index{0};
       bool voiced{false};
+      bool silent{false};
       double lf0{0};
       std::vector<double> spec, bap;
     };
 
+    void synth_segment(std::vector<frame_t>& frames, std::size_t first, std::size_t last, std::vector<short>& samples);
+
     std::unique_ptr<_HTS_Vocoder> vocoder;
     _HTS_Engine* engine;
     pitch::editor* pitch_editor;
     std::size_t count{0};
     std::queue<frame_t> fq;
+    std::deque<std::pair<std::size_t, std::size_t>> pauses;
     double pitch_shift{0};
+    worker_pool* pool{nullptr};
   };
 }
 #endif
@@ -40,6 +40,7 @@
 #include "userdict.hpp"
 #include "str.hpp"
 #include "pitch.hpp"
+#include "threading.hpp"
 
 namespace RHVoice
 {
@@ -233,6 +234,12 @@ namespace RHVoice
       return vocab_fst->translate(first, last, std::back_inserter(out));
     }
 
+    // Loads the user dictionaries from their current files
+    std::shared_ptr<const userdict::dict> load_userdict() const;
+    // Used by the text processed outside of an utterance scope. The
+    // utterances take the dictionaries from their own snapshot.
+    void set_userdict(const std::shared_ptr<const userdict::dict>& new_udict) const;
+
     item& append_emoji(utterance& u,const std::string& text) const;
     void do_text_analysis(utterance& u) const;
     void do_pos_tagging(utterance& u) const;
@@ -245,6 +252,11 @@ namespace RHVoice
     void set_pitch_modifications(utterance& u) const;
     void set_duration_modifications(utterance& u) const;
     void do_syl_accents(utterance& u) const;
+    // Stores the positions and counts within the syllables, words
+    // and phrases as features of the items, in one pass over the
+    // utterance, so that the labeller does not have to walk the
+    // relations for each segment
+    void precompute_positional_features(utterance& u) const;
     void stress_monosyllabic_words(utterance& u) const;
     void rename_palatalized_consonants(utterance& u) const;
 
@@ -287,6 +299,7 @@ namespace RHVoice
     language& operator=(const language&);
 
     void register_default_features();
+    std::shared_ptr<const userdict::dict> get_userdict() const;
 
     virtual void post_lex(utterance& u) const
     {
@@ -329,6 +342,64 @@ namespace RHVoice
 
     void apply_simple_dict(item&) const;
 
+    // Reusable buffers for the tokenizer fst input and output, kept in
+    // a pool because several threads may be tokenizing at once
+    struct tok_workspace
+    {
+      fst::id_translation translation;
+      // The character behind each input symbol, or a tok_*_char marker
+      std::vector<utf8::uint32_t> chars;
+      std::vector<bool> stress_mask;
+      std::string name;
+      std::string output_name;
+
+      void clear()
+      {
+        translation.clear();
+        chars.clear();
+        stress_mask.clear();
+        name.clear();
+        output_name.clear();
+      }
+    };
+
+    class tok_workspace_lease
+    {
+    public:
+      explicit tok_workspace_lease(const language& lang_);
+      ~tok_workspace_lease();
+
+      tok_workspace& operator*() const
+      {
+        return *workspace;
+      }
+
+      tok_workspace* operator->() const
+      {
+        return workspace.get();
+      }
+
+    private:
+      tok_workspace_lease(const tok_workspace_lease&);
+      tok_workspace_lease& operator=(const tok_workspace_lease&);
+
+      const language& lang;
+      std::unique_ptr<tok_workspace> workspace;
+    };
+
+    static const utf8::uint32_t tok_sb_char=0x110000;
+    static const utf8::uint32_t tok_eb_char=0x110001;
+    static const utf8::uint32_t tok_br_char=0x110002;
+    static const utf8::uint32_t tok_eos_char=0x110003;
+
+    void append_tok_input(tok_workspace& ws,utf8::uint32_t c,fst::symbol_id id) const;
+    void append_tok_input(tok_workspace& ws,const std::string& text) const;
+    bool tok_output_matches_input(const tok_workspace& ws,const fst::id_translation::output_symbol& o,std::size_t input_pos) const;
+    bool is_tok_output_char(const tok_workspace& ws,const fst::id_translation::output_symbol& o) const;
+    // The name refers to the symbol table, or to the workspace if the
+    // output is a copied character, and is valid until the next call
+    const std::string& get_tok_output_name(tok_workspace& ws,const fst::id_translation::output_symbol& o) const;
+
     std::map<std::string,std::shared_ptr<feature_function> > feature_functions;
     const phoneme_set phonemes;
     hts_labeller labeller;
@@ -347,7 +418,11 @@ std::unique_ptr<fst> qst_fst;
     std::unique_ptr<dtree> pitch_mod_dtree;
     std::unique_ptr<dtree> dur_mod_dtree;
     pitch::targets_spec_parser pts_parser;
-    userdict::dict udict;
+    // Replaced atomically when the dictionaries are reloaded
+    mutable std::shared_ptr<const userdict::dict> udict;
+    fst::symbol_id tok_sb,tok_eb,tok_br,tok_eos;
+    mutable threading::mutex tok_workspace_mutex;
+    mutable std::vector<std::unique_ptr<tok_workspace> > free_tok_workspaces;
 
   protected:
     struct lang_config
@@ -406,6 +481,11 @@ std::unique_ptr<fst> qst_fst;
       return (signs.find(cp)!=signs.end());
     }
 
+    const std::set<utf8::uint32_t>& get_letters() const
+    {
+      return letters;
+    }
+
     bool has_common_letters(const language_info& other) const
     {
       for(std::set<utf8::uint32_t>::const_iterator iter=letters.begin();iter!=letters.end();++iter)
@@ -525,11 +605,18 @@ std::unique_ptr<fst> qst_fst;
     std::string userdict_path;
   };
 
+  class language_search_criteria;
+
   class language_list: public resource_list<language_info>
   {
   public:
     language_list(const std::vector<std::string>& language_paths,const std::string& userdict_path,const event_logger& logger);
 
+    using resource_list<language_info>::find;
+    // Finds the same language as std::find_if would, but looks it up
+    // by name or code
+    const_iterator find(const language_search_criteria& criteria) const;
+
   private:
     class creator
     {
@@ -568,7 +655,11 @@ std::unique_ptr<fst> qst_fst;
       creators[language_id(name,format)]=std::shared_ptr<creator>(new concrete_creator<T>);
     }
 
+    void index_codes(const language_info& lang);
+
     Creators creators;
+    // Both the codes and the names are compared as find_if would
+    std::map<std::string,std::set<std::string,str::less>,str::less> names_by_code;
   };
 
   class language_search_criteria: public std::unary_function<const language_info&,bool>
@@ -599,6 +690,16 @@ std::unique_ptr<fst> qst_fst;
       return (name.empty()&&code.empty());
     }
 
+    const std::string& get_name() const
+    {
+      return name;
+    }
+
+    const std::string& get_code() const
+    {
+      return code;
+    }
+
     bool operator()(const language_info& info) const;
 
   private:
@@ -17,10 +17,9 @@
 #define RHVOICE_LIMITER_HPP
 
 #include <cmath>
-#include <queue>
-#include <set>
+#include <vector>
+#include <deque>
 #include "sample_rate.hpp"
-#include "speech_processor.hpp"
 
 namespace RHVoice
 {
@@ -54,10 +53,27 @@ namespace RHVoice
     S value;
   };
 
-  class limiter: public speech_processor
+  // A look-ahead peak limiter. Every sample leaves it delayed by the
+  // length of the window, with the gain computed from the largest
+  // peak of the window which starts with it.
+  class limiter
   {
   public:
-    limiter(double volume);
+    explicit limiter(double volume);
+
+    void initialize(sample_rate_t sr);
+
+    std::size_t get_window_size() const
+    {
+      return window_size;
+    }
+
+    // Writes the samples leaving the window to out, which should have
+    // room for count samples, and returns their number.
+    std::size_t process(const float* in,std::size_t count,float* out);
+    // Empties the window, out should have room for get_window_size()
+    // samples.
+    std::size_t flush(float* out);
 
   private:
     double amp2db(double a)
@@ -65,32 +81,28 @@ namespace RHVoice
       return 20.0*std::log10(a);
 }
 
-    double db2amp(double db)
-    {
-      return std::pow(10.0,db/20.0);
-}
-
-    double compute_gain(double v)
+    float compute_gain(float v) const
     {
-      double db=amp2db(v);
-      if(db<threshold)
-        return 1.0;
-      double gain=slope*(threshold-db);
-      return db2amp(gain);
+      if(v<=threshold_amp)
+        return 1;
+      return std::pow(threshold_amp/v,slope);
 }
 
-    void on_input();
-    void on_end_of_input();
-    void do_initialize();
-    void process_sample();
+    float release_sample();
 
     const double threshold;
     const double ratio;
     const double slope;
+    float threshold_amp;
     std::size_t window_size;
-    std::queue<sample_type> window;
-    std::multiset<sample_type> ordering;
-    envelope_computer<sample_type> env_comp;
+    // The delayed samples, indexed by their position modulo the
+    // window size
+    std::vector<float> window;
+    // Positions of the decreasing peaks of the window
+    std::deque<std::size_t> peaks;
+    std::size_t in_pos;
+    std::size_t out_pos;
+    envelope_computer<float> env_comp;
   };
 }
 #endif
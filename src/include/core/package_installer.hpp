@@ -0,0 +1,100 @@
+/* Copyright (C) 2026  RHVoice contributors */
+
+/* This program is free software: you can redistribute it and/or modify */
+/* it under the terms of the GNU Lesser General Public License as published by */
+/* the Free Software Foundation, either version 2.1 of the License, or */
+/* (at your option) any later version. */
+
+/* This program is distributed in the hope that it will be useful, */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+/* GNU Lesser General Public License for more details. */
+
+/* You should have received a copy of the GNU Lesser General Public License */
+/* along with this program.  If not, see <https://www.gnu.org/licenses/>. */
+
+#ifndef RHVOICE_PACKAGE_INSTALLER_HPP
+#define RHVOICE_PACKAGE_INSTALLER_HPP
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <exception>
+
+namespace RHVoice
+{
+  namespace pkg
+  {
+    // Downloads several packages at once and unpacks each archive
+    // into its directory while it arrives, checking the crc of every
+    // file. The directory keeps the position of the last complete
+    // file, so an interrupted installation continues from there.
+    class package_installer final
+    {
+    public:
+      // The index of the package, the bytes received and the size of
+      // the archive (0 if not known yet). Returning false cancels
+      // everything. Every download calls it from its own worker
+      // thread, so it may run for several packages at the same time.
+      using progress_callback_t=std::function<bool(std::size_t, double, double)>;
+      // Called from the worker thread as soon as a package is
+      // complete, so that the client can load the new voice while
+      // the other packages are still downloading
+      using installed_callback_t=std::function<void(std::size_t, const std::string&)>;
+
+      // On Android, ca_dir contains the cacert.pem which curl uses to
+      // check the servers, as for package_client. It is ignored on
+      // other platforms.
+      explicit package_installer(const std::string& ca_dir, unsigned int max_downloads_=3);
+      package_installer(const package_installer&)=delete;
+      package_installer& operator=(const package_installer&)=delete;
+
+      // The url is usually the data_url of a package from
+      // package_client
+      std::size_t add(const std::string& url, const std::string& target_dir);
+
+      void set_progress_callback(progress_callback_t c)
+      {
+        on_progress=c;
+      }
+
+      void set_installed_callback(installed_callback_t c)
+      {
+        on_installed=c;
+      }
+
+      // Returns after every package has been installed or has failed,
+      // and rethrows the first error. A cancellation only applies to
+      // the run in progress.
+      void run();
+      // Can be called from any thread
+      void cancel()
+      {
+        cancelled=true;
+      }
+
+    private:
+      struct job
+      {
+        std::string url;
+        std::string target_dir;
+      };
+
+      void work();
+      void install(std::size_t index);
+
+      const std::string ca_dir_path;
+      const unsigned int max_downloads;
+      std::vector<job> jobs;
+      std::vector<std::exception_ptr> errors;
+      std::size_t next_job{0};
+      std::mutex jobs_mutex;
+      std::atomic<bool> cancelled{false};
+      progress_callback_t on_progress;
+      installed_callback_t on_installed;
+    };
+  }
+}
+#endif
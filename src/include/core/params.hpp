@@ -104,6 +104,41 @@ namespace RHVoice
   {
     numeric_property<unsigned int> fixed_size{"stream.fixed_size", 1, 1, 10};
     numeric_property<unsigned int> view_size{"stream.view_size", 3, 1, 10};
+    // The first view is smaller, so that the speech starts sooner. When
+    // the speech is ahead of the client by more than its audio buffer,
+    // the number of labels finished in each view grows up to the
+    // maximum, keeping the same look-ahead.
+    numeric_property<unsigned int> first_view_size{"stream.first_view_size", 2, 1, 10};
+    numeric_property<unsigned int> max_fixed_size{"stream.max_fixed_size", 8, 1, 40};
+    // Iteration budgets of the global variance optimization and the
+    // relative change of its objective at which it stops early (0
+    // means it always uses the whole budget). At the maximum quality
+    // the budget is always used.
+    numeric_property<unsigned int> gv_iterations_min{"stream.gv_iterations_min", 2, 0, 20};
+    numeric_property<unsigned int> gv_iterations_std{"stream.gv_iterations_std", 5, 0, 20};
+    numeric_property<unsigned int> gv_iterations_max{"stream.gv_iterations_max", 5, 0, 20};
+    numeric_property<double> gv_tolerance_min{"stream.gv_tolerance_min", 0.001, 0, 1};
+    numeric_property<double> gv_tolerance_std{"stream.gv_tolerance_std", 0, 0, 1};
+    // How many frames the pitch editor may hold back, 0 means until
+    // the targets are known (the default)
+    numeric_property<unsigned int> pitch_look_ahead{"stream.pitch_look_ahead", 0, 0, 1000};
+    // Generate the streams and the blocks of their dimensions on a
+    // pool shared by all the engines, one thread per core. The result
+    // is the same, it only helps when there are idle cores.
+    bool_property parallel_generation{"stream.parallel_generation", false};
+
+    void register_self(config& cfg);
+  };
+
+  struct engine_pool_params
+  {
+    // The memory all the synthesis engines may take, in megabytes. When
+    // it is exceeded, the idle engines which were used least recently
+    // are freed. 0 means no limit.
+    numeric_property<unsigned int> memory_limit{"engine_pool.memory_limit", 0, 0, 1000000};
+    // How many idle engines of each voice stay loaded while the ones of
+    // other voices can be freed
+    numeric_property<unsigned int> min_idle{"engine_pool.min_idle", 1, 0, 100};
 
     void register_self(config& cfg);
   };
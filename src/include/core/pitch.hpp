@@ -17,12 +17,13 @@
 #define RHVOICE_PITCH_HPP
 
 #include <vector>
-#include <set>
+#include <algorithm>
 #include <map>
 #include <queue>
 #include <cmath>
 #include <string>
 #include <sstream>
+#include <mutex>
 #include "hts_label.hpp"
 
 namespace RHVoice
@@ -65,8 +66,11 @@ namespace pitch
               for(std::size_t i=1;i<(s.points.size()-1);++i)
                 {
                   set_distance(s,i,i-1,i+1);
-                  s.dists.insert(dist_t(s.points[i]));
+                  s.points[i].heap_pos=s.heap.size();
+                  s.heap.push_back(i);
                 }
+              for(std::size_t k=s.heap.size()/2;k>0;--k)
+                sift_down(s,k-1);
 }
 }
       return do_stylize(s);
@@ -80,13 +84,15 @@ namespace pitch
       std::size_t prev_index;
       std::size_t next_index;
       double distance;
+      std::size_t heap_pos;
 
       point_t(point_t& prev,double v):
         index(prev.index+1),
         value(v),
         prev_index(prev.index),
         next_index(0),
-        distance(0)
+        distance(0),
+        heap_pos(0)
       {
         prev.next_index=index;
 }
@@ -96,7 +102,8 @@ namespace pitch
         value(v),
         prev_index(0),
         next_index(0),
-        distance(0)
+        distance(0),
+        heap_pos(0)
       {
 }
 
@@ -108,38 +115,39 @@ namespace pitch
 
     typedef std::vector<point_t> point_list_t;
 
-    struct dist_t
-    {
-      const double value;
-      const std::size_t index;
-
-      dist_t(const point_t& p):
-        value(p.distance),
-        index(p.index)
-      {
-}
-
-      bool operator<(const dist_t& other) const
-      {
-        if(value<other.value)
-          return true;
-        if(value>other.value)
-          return false;
-        return (index<other.index);
-}
-    };
-
-    typedef std::set<dist_t> dist_set_t;
-
+    // The inner points which can still be removed are kept in a
+    // binary heap of their indices, ordered by the distance and then
+    // by the index. Every point knows its place in the heap, so that
+    // its neighbours can be moved when it is removed.
     struct state_t
     {
       point_list_t points;
-      dist_set_t dists;
+      std::vector<std::size_t> heap;
     };
 
     result_t do_stylize(state_t& s) const;
     void remove_point(state_t& s) const;
 
+    bool heap_less(const state_t& s,std::size_t k1,std::size_t k2) const
+    {
+      const point_t& p1=s.points[s.heap[k1]];
+      const point_t& p2=s.points[s.heap[k2]];
+      if(p1.distance!=p2.distance)
+        return (p1.distance<p2.distance);
+      return (p1.index<p2.index);
+}
+
+    void heap_swap(state_t& s,std::size_t k1,std::size_t k2) const
+    {
+      std::swap(s.heap[k1],s.heap[k2]);
+      s.points[s.heap[k1]].heap_pos=k1;
+      s.points[s.heap[k2]].heap_pos=k2;
+}
+
+    void sift_up(state_t& s,std::size_t k) const;
+    void sift_down(state_t& s,std::size_t k) const;
+    void update_distance(state_t& s,std::size_t i) const;
+
     double get_expected_value(const state_t& s,std::size_t i,std::size_t il,std::size_t ir) const
   {
     const point_t& pl=s.points[il];
@@ -155,9 +163,9 @@ namespace pitch
 
     bool done(const state_t& s) const
     {
-      if(s.dists.empty())
+      if(s.heap.empty())
         return true;
-      return (s.dists.begin()->value>=threshold);
+      return (s.points[s.heap.front()].distance>=threshold);
 }
 
     const double threshold;
@@ -202,6 +210,7 @@ namespace pitch
     bool read_target(target_t& t,std::istringstream& is,const std::string& spec) const;
 
     mutable cache_t cache;
+    mutable std::mutex cache_mutex;
   };
 
   class editor
@@ -236,6 +245,14 @@ namespace pitch
 
     void set_key(double k);
 
+    // The largest number of frames the editor may hold back while it
+    // waits for the targets, 0 means no limit. When the limit is
+    // reached, the oldest frame gets the best value known so far.
+    void set_look_ahead(std::size_t n)
+    {
+      look_ahead=n;
+}
+
     bool has_work() const
     {
       if(key==lzero)
@@ -309,6 +326,7 @@ namespace pitch
     void extend_base_values(const point_t&);
     void extend_base_values();
     void extend_results();
+    void release_next_value();
     bool has_trailing_values(const point_t&) const;
     std::size_t get_first_voiced_in_interval(interval_t i) const;
     std::size_t get_last_voiced_in_interval(interval_t i) const;
@@ -331,6 +349,7 @@ namespace pitch
     std::queue<point_t> val_queue;
     bool mod_flag;
     bool has_edits;
+    std::size_t look_ahead;
   };
 }
 }
@@ -23,11 +23,97 @@
 #include <stdexcept>
 #include <set>
 #include <map>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <cstdint>
 #include "utf.hpp"
 #include "str.hpp"
 
 namespace RHVoice
 {
+  class config;
+  class setting_values;
+
+  // The latest snapshot of a shared configuration. The version changes
+  // with every publication and is never reused, even by another
+  // configuration, so a thread can tell whether the copy it already
+  // has is still current without taking the lock which atomic_load
+  // needs for a shared_ptr.
+  struct shared_setting_values
+  {
+    std::shared_ptr<const setting_values> current;
+    std::atomic<std::uint64_t> version{0};
+  };
+
+  // The values of all the settings of a shared configuration, together
+  // with other data which must change at the same time. A new set is
+  // built for every change, and a published set is never modified.
+  class setting_values
+  {
+  public:
+    explicit setting_values(const void* owner_):
+      owner(owner_)
+    {
+    }
+
+    const void* get_owner() const
+    {
+      return owner;
+    }
+
+    const void* get(std::size_t slot) const
+    {
+      return (slot<values.size())?values[slot].get():0;
+    }
+
+    void set(std::size_t slot,const std::shared_ptr<const void>& value)
+    {
+      if(slot>=values.size())
+        values.resize(slot+1);
+      values[slot]=value;
+    }
+
+    std::shared_ptr<const void> get_object(const void* key) const
+    {
+      std::map<const void*,std::shared_ptr<const void> >::const_iterator it=objects.find(key);
+      return (it==objects.end())?std::shared_ptr<const void>():it->second;
+    }
+
+    void set_object(const void* key,const std::shared_ptr<const void>& obj)
+    {
+      objects[key]=obj;
+    }
+
+    // The set which the current thread has been told to use, if any
+    static const setting_values* get_active();
+    // The latest published set. The current thread keeps it until it
+    // asks for another version; the set it kept before, if any, is
+    // moved into hold.
+    static const setting_values* get_latest(const shared_setting_values& s,std::shared_ptr<const setting_values>& hold);
+
+    // Makes the current thread use the given set until the end of the
+    // scope, so that everything it reads belongs to one version
+    class scope
+    {
+    public:
+      explicit scope(const std::shared_ptr<const setting_values>& v);
+      ~scope();
+
+    private:
+      scope(const scope&);
+      scope& operator=(const scope&);
+
+      std::shared_ptr<const setting_values> values;
+      const setting_values* previous;
+    };
+
+  private:
+    const void* owner;
+    std::vector<std::shared_ptr<const void> > values;
+    std::map<const void*,std::shared_ptr<const void> > objects;
+  };
+
   class abstract_property
   {
   public:
@@ -41,13 +127,31 @@ namespace RHVoice
     }
 
     virtual bool set_from_string(const std::string& s)=0;
+    // Converts the string into a valid value without changing the
+    // setting. Returns an empty pointer if this is not possible.
+    virtual std::shared_ptr<const void> parse(const std::string& s) const=0;
     virtual void reset()=0;
     virtual bool is_set(bool recursive=false) const=0;
 
   protected:
     explicit abstract_property(const std::string& name_):
-      name(name_)
+      name(name_),
+      shared_values(0),
+      slot(0)
+    {
+    }
+
+    // The value from the configuration snapshot which the current
+    // thread uses. The snapshot is kept alive by hold, or by the
+    // thread until it reads another version.
+    const void* find_shared_value(std::shared_ptr<const setting_values>& hold) const
     {
+      if(shared_values==0)
+        return 0;
+      const setting_values* v=setting_values::get_active();
+      if((v==0)||(v->get_owner()!=shared_values))
+        v=setting_values::get_latest(*shared_values,hold);
+      return (v==0)?0:v->get(slot);
     }
 
   private:
@@ -55,23 +159,36 @@ namespace RHVoice
     abstract_property& operator=(const abstract_property&);
 
     const std::string name;
+    // Set when the property is registered in a shared configuration
+    const shared_setting_values* shared_values;
+    std::size_t slot;
+
+    friend class config;
   };
 
   template<typename T>
   class property: public abstract_property
   {
   protected:
-    const T& get_value() const
+    // The reference stays valid while hold is kept and the thread
+    // reads no other property. A value assigned in the code takes
+    // priority over the configuration.
+    const T& get_value(std::shared_ptr<const setting_values>& hold) const
     {
       if(value_set)
         return current_value;
+      if(const void* v=find_shared_value(hold))
+        return *static_cast<const T*>(v);
+      if(next)
+        return next->get_value(hold);
       else
-        {
-          if(next)
-            return next->get_value();
-          else
-            return default_value;
-        }
+        return default_value;
+    }
+
+    T get_value() const
+    {
+      std::shared_ptr<const setting_values> hold;
+      return get_value(hold);
     }
 
     void set_default_value(const T& val)
@@ -102,6 +219,21 @@ namespace RHVoice
     }
 
   public:
+    bool set_from_string(const std::string& s)
+    {
+      T val;
+      return (from_string(s,val)&&set_value(val));
+    }
+
+    std::shared_ptr<const void> parse(const std::string& s) const
+    {
+      T val,tmp;
+      if(from_string(s,val)&&(check_value(val,tmp)||(next&&next->check_value(val,tmp))))
+        return std::make_shared<T>(tmp);
+      else
+        return std::shared_ptr<const void>();
+    }
+
     T get() const
     {
       return get_value();
@@ -114,7 +246,8 @@ namespace RHVoice
 
     bool is_set(bool recursive=false) const
     {
-      return (value_set||(recursive&&next&&next->is_set(true)));
+      std::shared_ptr<const setting_values> hold;
+      return (value_set||(find_shared_value(hold)!=0)||(recursive&&next&&next->is_set(true)));
     }
 
     void reset()
@@ -134,6 +267,8 @@ namespace RHVoice
     bool value_set;
     const property* next;
 
+    virtual bool from_string(const std::string& s,T& val) const=0;
+
     virtual bool check_value(const T& given_value,T& correct_value) const
     {
       correct_value=given_value;
@@ -164,14 +299,6 @@ namespace RHVoice
       return max_value;
 }
 
-    bool set_from_string(const std::string& s)
-    {
-      std::istringstream strm(s);
-      strm.imbue(std::locale::classic());
-      T val;
-      return ((strm >> val)&&this->set_value(val));
-    }
-
     numeric_property& operator=(T val)
     {
       this->set_value(val);
@@ -179,6 +306,13 @@ namespace RHVoice
     }
 
   private:
+    bool from_string(const std::string& s,T& val) const
+    {
+      std::istringstream strm(s);
+      strm.imbue(std::locale::classic());
+      return static_cast<bool>(strm >> val);
+    }
+
     bool check_value(const T& given_value,T& correct_value) const
     {
       correct_value=std::max(min_value,std::min(max_value,given_value));
@@ -196,13 +330,6 @@ namespace RHVoice
     {
     }
 
-    bool set_from_string(const std::string& s)
-    {
-      std::string::const_iterator pos=s.begin();
-      utf8::uint32_t cp=utf8::next(pos,s.end());
-      return ((pos==s.end())&&this->set_value(cp));
-    }
-
     char_property& operator=(utf8::uint32_t val)
     {
       this->set_value(val);
@@ -210,6 +337,13 @@ namespace RHVoice
     }
 
   private:
+    bool from_string(const std::string& s,utf8::uint32_t& val) const
+    {
+      std::string::const_iterator pos=s.begin();
+      val=utf8::next(pos,s.end());
+      return (pos==s.end());
+    }
+
     bool check_value(const utf8::uint32_t& given_value,utf8::uint32_t& correct_value) const
     {
       if(utf::is_valid(given_value))
@@ -234,16 +368,6 @@ namespace RHVoice
     {
     }
 
-    bool set_from_string(const std::string& s)
-    {
-      #ifdef _MSC_VER
-      name_map::const_iterator it=names_to_values.find(s);
-      #else
-      typename name_map::const_iterator it=names_to_values.find(s);
-      #endif
-      return ((it!=names_to_values.end())&&this->set_value(it->second));
-    }
-
     enum_property& operator=(T val)
     {
       this->set_value(val);
@@ -260,6 +384,19 @@ namespace RHVoice
     }
 
   private:
+    bool from_string(const std::string& s,T& val) const
+    {
+      #ifdef _MSC_VER
+      name_map::const_iterator it=names_to_values.find(s);
+      #else
+      typename name_map::const_iterator it=names_to_values.find(s);
+      #endif
+      if(it==names_to_values.end())
+        return false;
+      val=it->second;
+      return true;
+    }
+
     name_map names_to_values;
   };
 
@@ -271,16 +408,18 @@ namespace RHVoice
     {
     }
 
-    bool set_from_string(const std::string& s)
-    {
-      return this->set_value(s);
-    }
-
     string_property& operator=(const std::string& val)
     {
       this->set_value(val);
       return *this;
     }
+
+  private:
+    bool from_string(const std::string& s,std::string& val) const
+    {
+      val=s;
+      return true;
+    }
   };
 
   class enum_string_property: public string_property
@@ -354,16 +493,18 @@ namespace RHVoice
     {
     }
 
-    bool set_from_string(const std::string& s)
+    bool includes(utf8::uint32_t c) const
     {
-      charset val(str::utf8_string_begin(s),str::utf8_string_end(s));
-      return this->set_value(val);
+      std::shared_ptr<const setting_values> hold;
+      const charset& val=get_value(hold);
+      return (val.find(c)!=val.end());
     }
 
-    bool includes(utf8::uint32_t c) const
+  private:
+    bool from_string(const std::string& s,charset& val) const
     {
-      const charset& val=get_value();
-      return (val.find(c)!=val.end());
+      val=charset(str::utf8_string_begin(s),str::utf8_string_end(s));
+      return true;
     }
   };
 
@@ -400,17 +541,19 @@ namespace RHVoice
     {
     }
 
-    bool set_from_string(const std::string& s)
+    bool includes(const std::string& s) const
     {
-      str::tokenizer<str::is_equal_to> tok(s,str::is_equal_to(','));
-      stringset val(tok.begin(),tok.end());
-      return this->set_value(val);
+      std::shared_ptr<const setting_values> hold;
+      const stringset& val=get_value(hold);
+      return (val.find(s)!=val.end());
     }
 
-    bool includes(const std::string& s) const
+  private:
+    bool from_string(const std::string& s,stringset& val) const
     {
-      const stringset& val=get_value();
-      return (val.find(s)!=val.end());
+      str::tokenizer<str::is_equal_to> tok(s,str::is_equal_to(','));
+      val=stringset(tok.begin(),tok.end());
+      return true;
     }
   };
 }
@@ -46,6 +46,12 @@ namespace RHVoice
 
     const T& get_instance() const;
 
+    bool has_instance() const
+    {
+      threading::lock instance_lock(instance_mutex);
+      return (instance.get()!=0);
+    }
+
     virtual void register_settings(config& cfg)
     {
     }
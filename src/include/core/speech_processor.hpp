@@ -25,7 +25,7 @@ namespace RHVoice
   class speech_processor
   {
   public:
-    typedef double sample_type;
+    typedef float sample_type;
     typedef const sample_type* sample_ptr;
 
   protected:
@@ -17,11 +17,12 @@
 #define RHVOICE_STR_HTS_ENGINE_IMPL_HPP
 
 #include <memory>
-#include <queue>
 #include <vector>
 #include <array>
+#include <chrono>
 #include "hts_engine_impl.hpp"
 #include "quality_setting.hpp"
+#include "params.hpp"
 #include "hts_vocoder_wrapper.hpp"
 
 struct _HTS_Engine;
@@ -55,10 +56,24 @@ struct par_mat_mem_t
     void do_initialize();
     void do_reset();
     void do_synthesize();
+    void do_predict_timing();
     void do_stop();
     void queue_labels();
     bool fill_lab_view();
+
+    bool all_labels_in_view() const
+    {
+      return (view_end==lab_names.size());
+    }
+
+    bool should_stop() const
+    {
+      return (output->is_stopped()||is_cancelled());
+    }
+
+    void resize_views();
     void set_speed();
+    void set_gv_iteration(const stream_params& stream_settings);
     void set_frame_ranges();
     void set_label_timing();
     void save_params();
@@ -67,11 +82,18 @@ struct par_mat_mem_t
     std::unique_ptr<_HTS_Engine> engine;
     hts_vocoder_wrapper vocoder;
     std::size_t base_frame_shift;
-    std::queue<const hts_label*> lab_queue;
-    std::vector<char*> lab_view;
+    // One entry per label of the utterance, the engine sees the window
+    // between view_start and view_end
+    std::vector<char*> lab_names;
     std::vector<double> dur_mods;
+    std::size_t view_start{0};
+    std::size_t view_end{0};
     std::size_t view_size{3};
     std::size_t fixed_size{1};
+    std::size_t base_fixed_size{1};
+    std::size_t max_fixed_size{1};
+    std::size_t first_view_size{3};
+    std::chrono::steady_clock::time_point start_time;
     par_mem_t par_mem;
     bool first_iter{true};
     std::size_t first_frame{0};
@@ -33,13 +33,13 @@ namespace RHVoice
         samples.push_back(0.5*std::sin(2*pi*freq*(static_cast<double>(i)/sample_rate)));
     }
 
-    const std::vector<double>& operator()() const
+    const std::vector<float>& operator()() const
     {
       return samples;
     }
 
   private:
-    std::vector<double> samples;
+    std::vector<float> samples;
   };
 }
 
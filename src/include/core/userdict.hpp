@@ -29,7 +29,6 @@
 #include "relation.hpp"
 #include "utterance.hpp"
 #include "stress_pattern.hpp"
-#include "trie.hpp"
 
 namespace RHVoice
 {
@@ -768,6 +767,78 @@ namespace RHVoice
       }
     };
 
+    // All the rule keys of a dictionary compiled into one
+    // Aho-Corasick automaton over case-folded code points, so that a
+    // run of tokens is scanned only once. The precedence of the rules
+    // is that of the trie which was used before: a character of a key
+    // matches itself and, if it is a lowercase one, its uppercase
+    // forms. Of the keys which start at the same position, the one
+    // which follows the case of the text for longer wins, and a longer
+    // key wins over its prefix when their case is equally good.
+    class rule_matcher
+    {
+    public:
+      struct match
+      {
+        const rule* matched_rule;
+        std::size_t length;
+      };
+
+      rule_matcher();
+
+      // The last of the rules with the same key wins
+      void add(const rule& r);
+      void compile();
+
+      // Finds the rule to apply at each position of the text. A miss
+      // is a match of zero length.
+      void find(const chars32& text,std::vector<match>& result) const;
+
+    private:
+      rule_matcher(const rule_matcher&);
+      rule_matcher& operator=(const rule_matcher&);
+
+      struct entry
+      {
+        chars32 key;
+        rule value;
+        // The key has no characters which match a different case
+        bool caseless;
+      };
+
+      struct state
+      {
+        std::size_t first_transition,last_transition;
+        std::size_t first_entry,last_entry;
+        std::size_t failure;
+        // The nearest state on the failure chain which has entries
+        std::size_t output;
+      };
+
+      struct transition
+      {
+        utf8::uint32_t label;
+        std::size_t target;
+      };
+
+      static utf8::uint32_t fold(utf8::uint32_t c)
+      {
+        if(c>=token_start)
+          return c;
+        else
+          return str::tolower(c);
+      }
+
+      std::size_t get_next_state(std::size_t s,utf8::uint32_t c) const;
+      bool matches(const entry& e,const chars32& text,std::size_t start) const;
+      bool is_better(const entry& e1,const entry& e2,const chars32& text,std::size_t start) const;
+
+      std::vector<entry> entries;
+      std::vector<state> states;
+      std::vector<transition> transitions;
+      bool compiled;
+    };
+
     class dict
   {
   public:
@@ -779,24 +850,13 @@ namespace RHVoice
     dict(const dict&);
     dict& operator=(const dict&);
 
-    struct to_lower
-    {
-      utf8::uint32_t operator()(utf8::uint32_t c) const
-      {
-        if(c>=token_start)
-          return c;
-        else
-          return str::tolower(c);
-      }
-    };
-
     void load_all();
     void load_dir(const std::string& path);
     void load_file(const std::string& file_path);
     bool should_ignore_token(const position& pos) const;
 
     const language_info& lang;
-    trie<utf8::uint32_t,rule,to_lower> rules;
+    rule_matcher rules;
     std::map<std::string, std::string> simple;
   };
   }
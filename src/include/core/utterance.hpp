@@ -23,6 +23,7 @@
 
 #include "relation.hpp"
 #include "quality_setting.hpp"
+#include "cancellation.hpp"
 
 namespace RHVoice
 {
@@ -61,6 +62,7 @@ namespace RHVoice
     relative_volume(1.0),
     utt_type("s"),
     flags(0),
+    cancellation(0),
     bilingual_enabled(true)
     {
     }
@@ -105,6 +107,21 @@ namespace RHVoice
       flags=value;
 }
 
+    void set_cancellation_token(const cancellation_token* token)
+    {
+      cancellation=token;
+    }
+
+    const cancellation_token* get_cancellation_token() const
+    {
+      return cancellation;
+    }
+
+    bool is_cancelled() const
+    {
+      return (cancellation&&cancellation->is_cancelled());
+    }
+
     double get_absolute_rate() const
     {
       return absolute_rate;
@@ -231,6 +248,7 @@ namespace RHVoice
     double absolute_rate,relative_rate,absolute_pitch,relative_pitch,absolute_volume,relative_volume;
     std::string utt_type;
     int flags;
+    const cancellation_token* cancellation;
     bool bilingual_enabled;
   };
 
@@ -135,6 +135,16 @@ private:
       stream_settings=&s;
     }
 
+    const std::shared_ptr<hts_engine_pool_manager>& get_engine_pool_manager() const
+    {
+      return engine_pool_manager;
+    }
+
+    void set_engine_pool_manager(const std::shared_ptr<hts_engine_pool_manager>& m)
+    {
+      engine_pool_manager=m;
+    }
+
   private:
     std::shared_ptr<voice> create_instance() const
     {
@@ -152,12 +162,20 @@ private:
     string_property country;
     stringset_property extra_utt_types;
     const stream_params* stream_settings{nullptr};
+    std::shared_ptr<hts_engine_pool_manager> engine_pool_manager;
   };
 
+  class voice_search_criteria;
+
   class voice_list: public resource_list<voice_info>
   {
   public:
     voice_list(const std::vector<std::string>& voice_paths,language_list& languages,const event_logger& logger);
+
+    using resource_list<voice_info>::find;
+    // Finds the same voice as std::find_if would, looking the names
+    // up directly when the criteria have any
+    const_iterator find(const voice_search_criteria& criteria) const;
   };
 
   class voice_search_criteria: public std::unary_function<const voice_info&,bool>
@@ -207,6 +225,11 @@ private:
 
     bool operator()(const voice_info& info) const;
 
+    const std::set<std::string,str::less>& get_names() const
+    {
+      return names;
+    }
+
     bool empty() const
     {
       return (names.empty()&&
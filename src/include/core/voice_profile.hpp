@@ -16,8 +16,11 @@
 #ifndef RHVOICE_VOICE_PROFILE_HPP
 #define RHVOICE_VOICE_PROFILE_HPP
 
+#include <cstdint>
 #include <string>
 #include <vector>
+#include <memory>
+#include <unordered_map>
 #include "voice.hpp"
 
 namespace RHVoice
@@ -27,8 +30,41 @@ namespace RHVoice
   private:
     typedef std::vector<voice_list::const_iterator> list;
 
+    // Maps each letter to the voices of the profile whose languages
+    // have it, as a bit mask over their positions in the profile
+    class letter_index
+    {
+    public:
+      typedef std::uint32_t mask;
+      static const std::size_t max_voices=32;
+
+      explicit letter_index(const list& voices);
+
+      mask find(utf8::uint32_t cp) const
+      {
+        if(cp<direct.size())
+          return direct[cp];
+        std::unordered_map<utf8::uint32_t,mask>::const_iterator it=others.find(cp);
+        return (it==others.end())?0:(it->second);
+      }
+
+      bool have_common_letters(std::size_t i,std::size_t j) const
+      {
+        return ((overlaps[i]>>j)&1);
+      }
+
+    private:
+      // Most alphabets are in this range, so they get a plain table
+      static const utf8::uint32_t direct_limit=0x3000;
+
+      std::vector<mask> direct;
+      std::unordered_map<utf8::uint32_t,mask> others;
+      std::vector<mask> overlaps;
+    };
+
     list voices;
     std::string name;
+    std::shared_ptr<const letter_index> letters;
 
   public:
     typedef std::vector<voice_list::const_iterator>::const_iterator iterator;
@@ -77,6 +113,9 @@ namespace RHVoice
           name+="+";
           name+=v->get_name();
         }
+      letters.reset();
+      if((voices.size()>1)&&(voices.size()<=letter_index::max_voices))
+        letters=std::make_shared<letter_index>(voices);
       return true;
     }
 
@@ -107,10 +146,47 @@ namespace RHVoice
     }
 
     template<typename text_iterator> iterator voice_for_text(text_iterator text_start,text_iterator text_end) const;
+
+  private:
+    template<typename text_iterator> iterator scan_voices_for_text(text_iterator text_start,text_iterator text_end) const;
   };
 
   template<typename text_iterator>
   voice_profile::iterator voice_profile::voice_for_text(text_iterator text_start,text_iterator text_end) const
+  {
+    if(!letters)
+      return scan_voices_for_text(text_start,text_end);
+    std::size_t counts[letter_index::max_voices]={0};
+    for(text_iterator it=text_start;it!=text_end;++it)
+      {
+        std::size_t i=0;
+        for(letter_index::mask m=letters->find(*it);m!=0;m>>=1,++i)
+          {
+            if(m&1)
+              ++counts[i];
+          }
+      }
+    // The same choice as scan_voices_for_text makes
+    std::size_t best=voices.size();
+    std::size_t max_count=0;
+    for(std::size_t i=0;i<voices.size();++i)
+      {
+        if((best<voices.size())&&letters->have_common_letters(best,i))
+          continue;
+        if(counts[i]>max_count)
+          {
+            best=i;
+            max_count=counts[i];
+            if(i==0)
+              break;
+          }
+      }
+    return (best<voices.size())?(begin()+best):end();
+  }
+
+  // Checks the letters of each language in turn
+  template<typename text_iterator>
+  voice_profile::iterator voice_profile::scan_voices_for_text(text_iterator text_start,text_iterator text_end) const
   {
     iterator best=end();
     voice_list::const_iterator v;
@@ -0,0 +1,35 @@
+/* Copyright (C) 2026  RHVoice contributors */
+
+/* This program is free software: you can redistribute it and/or modify */
+/* it under the terms of the GNU Lesser General Public License as published by */
+/* the Free Software Foundation, either version 2.1 of the License, or */
+/* (at your option) any later version. */
+
+/* This program is distributed in the hope that it will be useful, */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+/* GNU Lesser General Public License for more details. */
+
+/* You should have received a copy of the GNU Lesser General Public License */
+/* along with this program.  If not, see <https://www.gnu.org/licenses/>. */
+
+#ifndef RHVOICE_WORKER_POOL_H
+#define RHVOICE_WORKER_POOL_H
+#include <stddef.h>
+#ifdef __cplusplus
+extern "C" {
+  #endif
+
+typedef struct
+{
+  void* impl;
+} RHVoice_worker_pool_t;
+
+  /* Calls task for each index from 0 to count-1 and returns when all */
+  /* of them have finished. Runs them in the calling thread if the */
+  /* pool is empty. */
+  void RHVoice_worker_pool_run(RHVoice_worker_pool_t pool,size_t count,void (*task)(void* data,size_t index),void* data);
+  #ifdef __cplusplus
+}
+#endif
+#endif
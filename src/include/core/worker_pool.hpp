@@ -0,0 +1,77 @@
+/* Copyright (C) 2026  RHVoice contributors */
+
+/* This program is free software: you can redistribute it and/or modify */
+/* it under the terms of the GNU Lesser General Public License as published by */
+/* the Free Software Foundation, either version 2.1 of the License, or */
+/* (at your option) any later version. */
+
+/* This program is distributed in the hope that it will be useful, */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+/* GNU Lesser General Public License for more details. */
+
+/* You should have received a copy of the GNU Lesser General Public License */
+/* along with this program.  If not, see <https://www.gnu.org/licenses/>. */
+
+#ifndef RHVOICE_WORKER_POOL_HPP
+#define RHVOICE_WORKER_POOL_HPP
+
+#include <cstddef>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include "worker_pool.h"
+
+namespace RHVoice
+{
+  // Threads which help a caller to run independent parts of a
+  // computation. The caller takes part in the work itself, so several
+  // threads can share the pool without waiting for each other's jobs
+  // to finish first.
+  class worker_pool
+  {
+  public:
+    explicit worker_pool(unsigned int num_threads);
+    ~worker_pool();
+
+    // One thread less than the number of cores, created on first use
+    static worker_pool& get_shared();
+
+    // Returns when task has been called for each index in [0,count)
+    void run(std::size_t count,const std::function<void(std::size_t)>& task);
+
+    RHVoice_worker_pool_t get_c_pool()
+    {
+      RHVoice_worker_pool_t result;
+      result.impl=this;
+      return result;
+    }
+
+  private:
+    worker_pool(const worker_pool&);
+    worker_pool& operator=(const worker_pool&);
+
+    struct job
+    {
+      const std::function<void(std::size_t)>* task;
+      std::size_t count;
+      std::size_t next;
+      std::size_t done;
+      std::condition_variable finished;
+    };
+
+    // Must be called with the lock held
+    std::size_t take_index(job& j);
+    void work();
+
+    std::mutex pool_mutex;
+    std::condition_variable job_available;
+    std::deque<job*> jobs;
+    std::vector<std::thread> threads;
+    bool stopping;
+  };
+}
+#endif
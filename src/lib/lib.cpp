@@ -21,6 +21,7 @@
 
 #include "core/engine.hpp"
 #include "core/document.hpp"
+#include "core/batch_synthesizer.hpp"
 #include "core/client.hpp"
 #include "core/language.hpp"
 #include "core/voice.hpp"
@@ -34,11 +35,18 @@ struct RHVoice_message_struct: public client
   template<typename ch>
   RHVoice_message_struct(const std::shared_ptr<engine>& engine_ptr,const RHVoice_callbacks& callbacks_,const ch* text,unsigned int length,RHVoice_message_type message_type,const RHVoice_synth_params* synth_params,void* user_data_);
 
+  RHVoice_message_struct(const std::shared_ptr<engine>& engine_ptr,const RHVoice_callbacks& callbacks_,RHVoice_message_type message_type,const RHVoice_synth_params* synth_params,void* user_data_);
+
   bool play_speech(const short* samples,std::size_t count)
   {
     return callbacks.play_speech(samples,count,user_data);
   }
 
+  bool skip_speech(std::size_t count)
+  {
+    return callbacks.play_speech(0,count,user_data);
+  }
+
   event_mask get_supported_events() const;
 
   bool process_mark(const std::string& name)
@@ -66,6 +74,16 @@ struct RHVoice_message_struct: public client
     return callbacks.word_ends(position,length,user_data);
   }
 
+  bool phone_starts(const std::string& name)
+  {
+    return phone_callback(name.c_str(),user_data);
+  }
+
+  void set_phone_callback(int (*callback)(const char*,void*))
+  {
+    phone_callback=callback;
+  }
+
   bool play_audio(const std::string& src)
   {
     return callbacks.play_audio(src.c_str(),user_data);
@@ -86,12 +104,33 @@ struct RHVoice_message_struct: public client
     doc_ptr->synthesize();
   }
 
+  document& get_document()
+  {
+    return *doc_ptr;
+  }
+
+  void append_text(const char* text,unsigned int length)
+  {
+    if(!text)
+      throw std::invalid_argument("Text is a null pointer");
+    doc_ptr->append_text(text,length);
+  }
+
+  void finish()
+  {
+    doc_ptr->finish_input();
+  }
+
 private:
   RHVoice_message_struct(const RHVoice_message_struct&);
   RHVoice_message_struct& operator=(const RHVoice_message_struct&);
 
+  static voice_profile get_voice_profile(const std::shared_ptr<engine>& engine_ptr,const RHVoice_synth_params* synth_params);
+  void apply_synth_params(const RHVoice_synth_params* synth_params);
+
   std::unique_ptr<document> doc_ptr;
   RHVoice_callbacks callbacks;
+  int (*phone_callback)(const char*,void*);
   void* user_data;
 };
 
@@ -121,12 +160,22 @@ struct RHVoice_tts_engine_struct
 
   bool are_languages_compatible(const char* language1,const char* language2) const;
 
+  void reload()
+  {
+    engine_ptr->reload();
+  }
+
   template<typename ch>
   RHVoice_message new_message(const ch* text,unsigned int length,RHVoice_message_type message_type,const RHVoice_synth_params* synth_params,void* user_data) const
   {
     return (new RHVoice_message_struct(engine_ptr,callbacks,text,length,message_type,synth_params,user_data));
   }
 
+  RHVoice_message new_incremental_message(RHVoice_message_type message_type,const RHVoice_synth_params* synth_params,void* user_data) const
+  {
+    return (new RHVoice_message_struct(engine_ptr,callbacks,message_type,synth_params,user_data));
+  }
+
 private:
   RHVoice_tts_engine_struct(const RHVoice_tts_engine_struct&);
   RHVoice_tts_engine_struct& operator=(const RHVoice_tts_engine_struct&);
@@ -211,22 +260,44 @@ bool RHVoice_tts_engine_struct::are_languages_compatible(const char* language1,c
   return !(first->has_common_letters(*second));
 }
 
+voice_profile RHVoice_message_struct::get_voice_profile(const std::shared_ptr<engine>& engine_ptr,const RHVoice_synth_params* synth_params)
+{
+  if(!synth_params)
+    throw std::invalid_argument("No synthesis parameters");
+  if(!synth_params->voice_profile)
+    throw std::invalid_argument("The main voice name is mandatory");
+  voice_profile profile=engine_ptr->create_voice_profile(synth_params->voice_profile);
+  if(profile.empty())
+    throw std::invalid_argument("The voice with this name does not exist or has been disabled by the user");
+  return profile;
+}
+
+void RHVoice_message_struct::apply_synth_params(const RHVoice_synth_params* synth_params)
+{
+  doc_ptr->set_owner(*this);
+  doc_ptr->speech_settings.absolute.rate=synth_params->absolute_rate;
+  doc_ptr->speech_settings.absolute.pitch=synth_params->absolute_pitch;
+  doc_ptr->speech_settings.absolute.volume=synth_params->absolute_volume;
+  doc_ptr->speech_settings.relative.rate=synth_params->relative_rate;
+  doc_ptr->speech_settings.relative.pitch=synth_params->relative_pitch;
+  doc_ptr->speech_settings.relative.volume=synth_params->relative_volume;
+  doc_ptr->set_flags(synth_params->flags);
+  doc_ptr->verbosity_settings.punctuation_mode=synth_params->punctuation_mode;
+  if(synth_params->punctuation_list)
+    doc_ptr->verbosity_settings.punctuation_list.set_from_string(synth_params->punctuation_list);
+}
+
 template<typename ch>
 RHVoice_message_struct::RHVoice_message_struct(const std::shared_ptr<engine>& engine_ptr,const RHVoice_callbacks& callbacks_,const ch* text,unsigned int length,RHVoice_message_type message_type,const RHVoice_synth_params* synth_params,void* user_data_):
   callbacks(callbacks_),
+  phone_callback(0),
   user_data(user_data_)
 {
   if(!text)
     throw std::invalid_argument("Text is a null pointer");
   if(length==0)
     throw std::invalid_argument("Text is an empty string");
-  if(!synth_params)
-    throw std::invalid_argument("No synthesis parameters");
-  if(!synth_params->voice_profile)
-    throw std::invalid_argument("The main voice name is mandatory");
-  voice_profile profile=engine_ptr->create_voice_profile(synth_params->voice_profile);
-  if(profile.empty())
-    throw std::invalid_argument("The voice with this name does not exist or has been disabled by the user");
+  voice_profile profile=get_voice_profile(engine_ptr,synth_params);
   switch(message_type)
     {
     case RHVoice_message_text:
@@ -244,17 +315,27 @@ RHVoice_message_struct::RHVoice_message_struct(const std::shared_ptr<engine>& en
     default:
       throw std::invalid_argument("Unknown message type");
     }
-  doc_ptr->set_owner(*this);
-  doc_ptr->speech_settings.absolute.rate=synth_params->absolute_rate;
-  doc_ptr->speech_settings.absolute.pitch=synth_params->absolute_pitch;
-  doc_ptr->speech_settings.absolute.volume=synth_params->absolute_volume;
-  doc_ptr->speech_settings.relative.rate=synth_params->relative_rate;
-  doc_ptr->speech_settings.relative.pitch=synth_params->relative_pitch;
-  doc_ptr->speech_settings.relative.volume=synth_params->relative_volume;
-  doc_ptr->set_flags(synth_params->flags);
-  doc_ptr->verbosity_settings.punctuation_mode=synth_params->punctuation_mode;
-  if(synth_params->punctuation_list)
-    doc_ptr->verbosity_settings.punctuation_list.set_from_string(synth_params->punctuation_list);
+  apply_synth_params(synth_params);
+}
+
+RHVoice_message_struct::RHVoice_message_struct(const std::shared_ptr<engine>& engine_ptr,const RHVoice_callbacks& callbacks_,RHVoice_message_type message_type,const RHVoice_synth_params* synth_params,void* user_data_):
+  callbacks(callbacks_),
+  phone_callback(0),
+  user_data(user_data_)
+{
+  voice_profile profile=get_voice_profile(engine_ptr,synth_params);
+  switch(message_type)
+    {
+    case RHVoice_message_text:
+      doc_ptr=document::create_incremental(engine_ptr,content_text,profile);
+      break;
+    case RHVoice_message_characters:
+      doc_ptr=document::create_incremental(engine_ptr,content_chars,profile);
+      break;
+    default:
+      throw std::invalid_argument("This message type cannot be received incrementally");
+    }
+  apply_synth_params(synth_params);
 }
 
 event_mask RHVoice_message_struct::get_supported_events() const
@@ -274,6 +355,8 @@ event_mask RHVoice_message_struct::get_supported_events() const
     result|=event_audio;
   if(callbacks.done)
     result|=event_done;
+  if(phone_callback)
+    result|=event_phone_starts;
   return result;
 }
 
@@ -331,6 +414,21 @@ int RHVoice_are_languages_compatible(RHVoice_tts_engine tts_engine,const char* l
     }
 }
 
+int RHVoice_reload(RHVoice_tts_engine tts_engine)
+{
+  if(!tts_engine)
+    return 0;
+  try
+    {
+      tts_engine->reload();
+      return 1;
+    }
+  catch(const std::exception& e)
+    {
+      return 0;
+    }
+}
+
 RHVoice_message RHVoice_new_message(RHVoice_tts_engine tts_engine,const char* text,unsigned int length,RHVoice_message_type message_type,const RHVoice_synth_params* synth_params,void* user_data)
 {
   try
@@ -355,6 +453,92 @@ RHVoice_message RHVoice_new_message_w(RHVoice_tts_engine tts_engine,const wchar_
     }
 }
 
+RHVoice_message RHVoice_new_incremental_message(RHVoice_tts_engine tts_engine,RHVoice_message_type message_type,const RHVoice_synth_params* synth_params,void* user_data)
+{
+  try
+    {
+      return (tts_engine?(tts_engine->new_incremental_message(message_type,synth_params,user_data)):0);
+    }
+  catch(const std::exception& e)
+    {
+      return 0;
+    }
+}
+
+int RHVoice_append_to_message(RHVoice_message message,const char* text,unsigned int length)
+{
+  try
+    {
+      if(message)
+        {
+          message->append_text(text,length);
+          return 1;
+        }
+      else
+        return 0;
+    }
+  catch(const std::exception& e)
+    {
+      return 0;
+    }
+}
+
+int RHVoice_finish_message(RHVoice_message message)
+{
+  try
+    {
+      if(message)
+        {
+          message->finish();
+          return 1;
+        }
+      else
+        return 0;
+    }
+  catch(const std::exception& e)
+    {
+      return 0;
+    }
+}
+
+int RHVoice_cancel(RHVoice_message message)
+{
+  if(!message)
+    return 0;
+  message->get_document().cancel();
+  return 1;
+}
+
+int RHVoice_set_phone_callback(RHVoice_message message,int (*phone_starts)(const char* name,void* user_data))
+{
+  if(!message)
+    return 0;
+  message->set_phone_callback(phone_starts);
+  return 1;
+}
+
+int RHVoice_speak_batch(RHVoice_message* messages,unsigned int count,unsigned int num_threads)
+{
+  try
+    {
+      if(!messages)
+        return 0;
+      batch_synthesizer synth(num_threads);
+      for(unsigned int i=0;i<count;++i)
+        {
+          if(!messages[i])
+            return 0;
+          synth.add(messages[i]->get_document());
+        }
+      synth.run();
+      return 1;
+    }
+  catch(const std::exception& e)
+    {
+      return 0;
+    }
+}
+
 void RHVoice_delete_message(RHVoice_message message)
 {
   delete message;
@@ -367,7 +551,7 @@ int RHVoice_speak(RHVoice_message message)
       if(message)
         {
           message->speak();
-          return 1;
+          return (message->get_document().is_cancelled()?0:1);
         }
       else
         return 0;
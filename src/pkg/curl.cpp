@@ -16,6 +16,7 @@
 #include <stdexcept>
 #include <string>
 #include <array>
+#include <algorithm>
 #include "curl.hpp"
 #include <iostream>
 
@@ -127,4 +128,63 @@ namespace RHVoice
       ok=curl_easy_setopt(h.get(), CURLOPT_NOPROGRESS, curl_opt_yes);
     ok=curl_easy_perform(h.get());
   }
+
+  void curl::do_http_get_from(easy_handle& h, const std::string& url, curl_off_t offset, write_callback_t w_callback, progress_callback_t p_callback)
+  {
+    if(offset==0)
+      {
+        do_http_get(h, url, w_callback, p_callback);
+        return;
+      }
+    CURL* p=h.get();
+    // 206 for http, 0 for file and the like. A server which ignores
+    // the range answers 200 with the whole archive.
+    auto is_full_reply=[p] {
+      long code=0;
+      curl_easy_getinfo(p, CURLINFO_RESPONSE_CODE, &code);
+      return (code==200);};
+    bool checked=false;
+    curl_off_t to_skip=0;
+    auto range_callback=[offset, &is_full_reply, &checked, &to_skip, &w_callback] (const char* data, std::size_t size) {
+      if(!checked)
+        {
+          if(is_full_reply())
+            to_skip=offset;
+          checked=true;
+        }
+      if(to_skip>0)
+        {
+          const auto n=std::min<curl_off_t>(to_skip, size);
+          to_skip-=n;
+          data+=n;
+          size-=n;
+          if(size==0)
+            return true;
+        }
+      return w_callback(data, size);};
+    progress_callback_t range_p_callback;
+    if(p_callback)
+      range_p_callback=[offset, &is_full_reply, &p_callback] (double total, double now) {
+        if(is_full_reply())
+          {
+            total=std::max(0.0, total-offset);
+            now=std::max(0.0, now-offset);
+          }
+        return p_callback(total, now);};
+    // Unlike CURLOPT_RESUME_FROM_LARGE, a range does not make curl
+    // fail when the server sends everything
+    const std::string range=std::to_string(offset)+"-";
+    curl_ok_t ok(h);
+    ok=curl_easy_setopt(p, CURLOPT_RANGE, range.c_str());
+    try
+      {
+        do_http_get(h, url, range_callback, range_p_callback);
+      }
+    catch(...)
+      {
+        curl_easy_setopt(p, CURLOPT_RANGE, nullptr);
+        throw;
+      }
+    ok=curl_easy_setopt(p, CURLOPT_RANGE, nullptr);
+  }
 }
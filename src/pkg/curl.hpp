@@ -38,6 +38,11 @@ namespace RHVoice
     static curl& get_instance();
     easy_handle easy_init();
     void do_http_get(easy_handle& h, const std::string& url, write_callback_t w_callback, progress_callback_t p_callback=progress_callback_t());
+    // Asks for the data starting at offset. Servers which do not
+    // support ranges send everything, so the bytes before the offset
+    // are dropped here and the callbacks always see the data and the
+    // progress from the offset.
+    void do_http_get_from(easy_handle& h, const std::string& url, curl_off_t offset, write_callback_t w_callback, progress_callback_t p_callback=progress_callback_t());
   };
 }
 #endif
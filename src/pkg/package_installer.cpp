@@ -0,0 +1,190 @@
+/* Copyright (C) 2026  RHVoice contributors */
+
+/* This program is free software: you can redistribute it and/or modify */
+/* it under the terms of the GNU Lesser General Public License as published by */
+/* the Free Software Foundation, either version 2.1 of the License, or */
+/* (at your option) any later version. */
+
+/* This program is distributed in the hope that it will be useful, */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+/* GNU Lesser General Public License for more details. */
+
+/* You should have received a copy of the GNU Lesser General Public License */
+/* along with this program.  If not, see <https://www.gnu.org/licenses/>. */
+
+#include "core/package_installer.hpp"
+#include <thread>
+#include <algorithm>
+#include <stdexcept>
+#include "boost/nowide/fstream.hpp"
+#include "boost/nowide/cstdio.hpp"
+#include "core/path.hpp"
+#include "curl.hpp"
+#include "zip_extractor.hpp"
+
+namespace RHVoice
+{
+  namespace pkg
+  {
+    namespace nw=boost::nowide;
+
+namespace
+{
+  // The url of the archive and the offset of its first file which
+  // has not been unpacked yet
+  const std::string state_file_name(".download");
+
+  struct download_state
+  {
+    std::string url;
+    std::uint64_t offset;
+  };
+
+  download_state load_state(const std::string& dir)
+  {
+    download_state st{std::string(), 0};
+    nw::ifstream f(path::join(dir, state_file_name));
+    if(!f)
+      return st;
+    std::string url;
+    std::uint64_t offset=0;
+    if(std::getline(f, url) && (f >> offset))
+      {
+        st.url=url;
+        st.offset=offset;
+      }
+    return st;
+  }
+
+  void save_state(const std::string& dir, const download_state& st)
+  {
+    const auto p=path::join(dir, state_file_name);
+    nw::ofstream f(p);
+    f << st.url << std::endl << st.offset << std::endl;
+    f.close();
+    if(!f)
+      throw std::runtime_error("Cannot write "+p);
+  }
+}
+
+    package_installer::package_installer(const std::string& ca_dir, unsigned int max_downloads_):
+      ca_dir_path(ca_dir),
+      max_downloads(std::max(1u, max_downloads_))
+    {
+    }
+
+    std::size_t package_installer::add(const std::string& url, const std::string& target_dir)
+    {
+      jobs.push_back(job{url, target_dir});
+      return (jobs.size()-1);
+    }
+
+    void package_installer::run()
+    {
+      cancelled=false;
+      next_job=0;
+      errors.assign(jobs.size(), std::exception_ptr());
+      std::vector<std::thread> threads;
+      const auto num_threads=std::min<std::size_t>(max_downloads, jobs.size());
+      for(std::size_t i=0; i<num_threads; ++i)
+        threads.emplace_back(&package_installer::work, this);
+      for(auto& t: threads)
+        t.join();
+      jobs.clear();
+      for(const auto& e: errors)
+        {
+          if(e)
+            std::rethrow_exception(e);
+        }
+      if(cancelled)
+        throw std::runtime_error("The installation has been cancelled");
+    }
+
+    void package_installer::work()
+    {
+      while(true)
+        {
+          std::size_t index=0;
+          {
+            std::lock_guard<std::mutex> lock(jobs_mutex);
+            if(cancelled || next_job>=jobs.size())
+              return;
+            index=next_job;
+            ++next_job;
+          }
+          try
+            {
+              install(index);
+            }
+          catch(...)
+            {
+              errors[index]=std::current_exception();
+            }
+        }
+    }
+
+    void package_installer::install(std::size_t index)
+    {
+      const auto& j=jobs[index];
+      auto st=load_state(j.target_dir);
+      // A different url means a new version of the package
+      if(st.url!=j.url)
+        {
+          st.url=j.url;
+          st.offset=0;
+        }
+      const std::uint64_t start=st.offset;
+      zip_extractor extractor(j.target_dir, start, [&j] (std::uint64_t offset) {
+                                                      save_state(j.target_dir, download_state{j.url, offset});});
+      auto& cu=curl::get_instance();
+      auto h=cu.easy_init();
+      #ifdef ANDROID
+      std::string ca_cert_path{path::join(ca_dir_path, "cacert.pem")};
+      curl_easy_setopt(h.get(), CURLOPT_CAINFO, ca_cert_path.c_str());
+      #endif
+      // Nothing may be thrown through curl
+      std::exception_ptr error;
+      curl::progress_callback_t p_callback;
+      if(on_progress)
+        p_callback=[this, index, start] (double total, double now) {
+                     if(cancelled)
+                       return false;
+                     if(on_progress(index, start+now, (total>0)?(start+total):0))
+                       return true;
+                     cancelled=true;
+                     return false;};
+      try
+        {
+          cu.do_http_get_from(
+                              h,
+                              j.url,
+                              static_cast<curl_off_t>(start),
+                              [this, &extractor, &error] (const char* data, std::size_t size) {
+                                if(cancelled)
+                                  return false;
+                                try
+                                  {
+                                    extractor.write(data, size);
+                                    return true;
+                                  }
+                                catch(...)
+                                  {
+                                    error=std::current_exception();
+                                    return false;
+                                  }},
+                              p_callback);
+        }
+      catch(...)
+        {
+          if(error)
+            std::rethrow_exception(error);
+          throw;
+        }
+      extractor.finish();
+      nw::remove(path::join(j.target_dir, state_file_name).c_str());
+      if(on_installed)
+        on_installed(index, j.target_dir);
+    }
+  }
+}
@@ -0,0 +1,344 @@
+/* Copyright (C) 2026  RHVoice contributors */
+
+/* This program is free software: you can redistribute it and/or modify */
+/* it under the terms of the GNU Lesser General Public License as published by */
+/* the Free Software Foundation, either version 2.1 of the License, or */
+/* (at your option) any later version. */
+
+/* This program is distributed in the hope that it will be useful, */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+/* GNU Lesser General Public License for more details. */
+
+/* You should have received a copy of the GNU Lesser General Public License */
+/* along with this program.  If not, see <https://www.gnu.org/licenses/>. */
+
+#include <stdexcept>
+#include <algorithm>
+#include <cerrno>
+#ifdef WIN32
+#include <direct.h>
+#include "boost/nowide/convert.hpp"
+#else
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif
+#include "core/path.hpp"
+#include "zip_extractor.hpp"
+
+namespace RHVoice
+{
+  namespace pkg
+  {
+namespace
+{
+  const std::size_t out_buf_size=65536;
+  const std::uint16_t zip64_extra_id=1;
+
+  void make_dir(const std::string& p)
+  {
+    #ifdef WIN32
+    int res=_wmkdir(boost::nowide::widen(p).c_str());
+    #else
+    int res=mkdir(p.c_str(), 0755);
+    #endif
+    if(res!=0 && errno!=EEXIST)
+      throw std::runtime_error("Cannot create directory "+p);
+  }
+}
+
+    zip_extractor::zip_extractor(const std::string& dir, std::uint64_t offset_, checkpoint_callback_t cp_callback):
+      target_dir(dir),
+      offset(offset_),
+      on_checkpoint(cp_callback),
+      out_buf(out_buf_size)
+    {
+      make_dir(target_dir);
+    }
+
+    zip_extractor::~zip_extractor()
+    {
+      if(zs_initialized)
+        inflateEnd(&zs);
+    }
+
+    bool zip_extractor::fill(const char*& data, std::size_t& size, std::size_t needed)
+    {
+      if(buf.size()<needed)
+        {
+          const auto n=std::min(needed-buf.size(), size);
+          buf.append(data, n);
+          data+=n;
+          size-=n;
+          offset+=n;
+        }
+      return (buf.size()>=needed);
+    }
+
+    std::uint16_t zip_extractor::get_u16(std::size_t pos) const
+    {
+      return static_cast<std::uint16_t>(static_cast<unsigned char>(buf[pos])|
+                                        (static_cast<unsigned char>(buf[pos+1])<<8));
+    }
+
+    std::uint32_t zip_extractor::get_u32(std::size_t pos) const
+    {
+      return (static_cast<std::uint32_t>(get_u16(pos))|(static_cast<std::uint32_t>(get_u16(pos+2))<<16));
+    }
+
+    std::uint64_t zip_extractor::get_u64(std::size_t pos) const
+    {
+      return (static_cast<std::uint64_t>(get_u32(pos))|(static_cast<std::uint64_t>(get_u32(pos+4))<<32));
+    }
+
+    void zip_extractor::write(const char* data, std::size_t size)
+    {
+      while(size>0)
+        {
+          switch(state)
+            {
+            case state_header:
+              if(!fill(data, size, 4))
+                return;
+              if(get_u32(0)==central_header_sig || get_u32(0)==end_record_sig)
+                {
+                  state=state_done;
+                  break;
+                }
+              if(get_u32(0)!=local_header_sig)
+                throw std::runtime_error("Invalid zip local header");
+              if(!fill(data, size, local_header_size))
+                return;
+              parse_header();
+              break;
+            case state_name:
+              if(!fill(data, size, local_header_size+name_size+extra_size))
+                return;
+              parse_name();
+              break;
+            case state_data:
+              {
+                const auto n=(method==method_stored)?read_stored(data, size):read_deflated(data, size);
+                data+=n;
+                size-=n;
+              }
+              break;
+            case state_descriptor:
+              if(!fill(data, size, 4))
+                return;
+              {
+                // The signature of the data descriptor is optional
+                const std::size_t start=(get_u32(0)==descriptor_sig)?4:0;
+                if(!fill(data, size, start+(zip64?20:12)))
+                  return;
+                end_entry(get_u32(start));
+              }
+              break;
+            case state_done:
+              // The central directory is not needed
+              offset+=size;
+              return;
+            }
+        }
+    }
+
+    void zip_extractor::finish()
+    {
+      if(state==state_done)
+        return;
+      if(state==state_header && buf.empty())
+        return;
+      throw std::runtime_error("The zip archive is truncated");
+    }
+
+    void zip_extractor::parse_header()
+    {
+      flags=get_u16(6);
+      method=get_u16(8);
+      if(flags&1)
+        throw std::runtime_error("Encrypted zip entries are not supported");
+      if(method!=method_stored && method!=method_deflated)
+        throw std::runtime_error("Unsupported zip compression method");
+      if((flags&flag_descriptor) && method==method_stored)
+        throw std::runtime_error("Cannot stream a stored zip entry of unknown size");
+      expected_crc=get_u32(14);
+      compressed_size=get_u32(18);
+      name_size=get_u16(26);
+      extra_size=get_u16(28);
+      zip64=false;
+      state=state_name;
+    }
+
+    void zip_extractor::parse_name()
+    {
+      const std::string name(buf, local_header_size, name_size);
+      read_zip64_sizes(local_header_size+name_size, buf.size());
+      buf.clear();
+      crc=crc32(0, Z_NULL, 0);
+      remaining=compressed_size;
+      make_dirs(name);
+      file_path=path::join(target_dir, get_target_path(name));
+      // The data of a directory, if any, is only checked
+      if(name.back()!='/')
+        {
+          file.reset(new boost::nowide::ofstream(file_path.c_str(), std::ios::out|std::ios::binary|std::ios::trunc));
+          if(!*file)
+            throw std::runtime_error("Cannot create "+file_path);
+        }
+      if(method==method_deflated)
+        {
+          if(!zs_initialized)
+            {
+              zs.zalloc=Z_NULL;
+              zs.zfree=Z_NULL;
+              zs.opaque=Z_NULL;
+              zs.next_in=Z_NULL;
+              zs.avail_in=0;
+              if(inflateInit2(&zs, -MAX_WBITS)!=Z_OK)
+                throw std::runtime_error("Cannot initialize zlib");
+              zs_initialized=true;
+            }
+          else
+            inflateReset(&zs);
+        }
+      state=state_data;
+      if(method==method_stored && remaining==0)
+        end_data();
+    }
+
+    void zip_extractor::read_zip64_sizes(std::size_t first, std::size_t last)
+    {
+      for(std::size_t pos=first; pos+4<=last; )
+        {
+          const auto id=get_u16(pos);
+          const std::size_t size=get_u16(pos+2);
+          pos+=4;
+          if(pos+size>last)
+            break;
+          if(id==zip64_extra_id)
+            {
+              zip64=true;
+              // The uncompressed size comes first, then the compressed one,
+              // each only if the field of the local header is full
+              std::size_t field=pos;
+              if(get_u32(22)==0xffffffff && field+8<=pos+size)
+                field+=8;
+              if(compressed_size==0xffffffff && field+8<=pos+size)
+                compressed_size=get_u64(field);
+            }
+          pos+=size;
+        }
+    }
+
+    std::string zip_extractor::get_target_path(const std::string& name) const
+    {
+      // Never write outside the target directory
+      if(name.empty() || name.front()=='/' || name.find('\\')!=std::string::npos || name.find(':')!=std::string::npos)
+        throw std::runtime_error("Invalid path in the zip archive: "+name);
+      std::string::size_type start=0;
+      while(start<=name.size())
+        {
+          auto end=name.find('/', start);
+          if(end==std::string::npos)
+            end=name.size();
+          if(name.compare(start, end-start, "..")==0)
+            throw std::runtime_error("Invalid path in the zip archive: "+name);
+          start=end+1;
+        }
+      #ifdef WIN32
+      std::string result(name);
+      std::replace(result.begin(), result.end(), '/', '\\');
+      return result;
+      #else
+      return name;
+      #endif
+    }
+
+    void zip_extractor::make_dirs(const std::string& name) const
+    {
+      const auto rel_path=get_target_path(name);
+      for(auto pos=name.find('/'); pos!=std::string::npos; pos=name.find('/', pos+1))
+        make_dir(path::join(target_dir, rel_path.substr(0, pos)));
+    }
+
+    std::size_t zip_extractor::read_stored(const char* data, std::size_t size)
+    {
+      const auto n=static_cast<std::size_t>(std::min<std::uint64_t>(remaining, size));
+      output(data, n);
+      remaining-=n;
+      offset+=n;
+      if(remaining==0)
+        end_data();
+      return n;
+    }
+
+    std::size_t zip_extractor::read_deflated(const char* data, std::size_t size)
+    {
+      // Without a data descriptor the size is known, and the deflate
+      // stream must end exactly there
+      std::size_t avail=size;
+      if(!(flags&flag_descriptor))
+        avail=static_cast<std::size_t>(std::min<std::uint64_t>(remaining, size));
+      zs.next_in=reinterpret_cast<Bytef*>(const_cast<char*>(data));
+      zs.avail_in=static_cast<uInt>(avail);
+      int res=Z_OK;
+      do
+        {
+          zs.next_out=reinterpret_cast<Bytef*>(out_buf.data());
+          zs.avail_out=static_cast<uInt>(out_buf.size());
+          res=inflate(&zs, Z_NO_FLUSH);
+          if(res!=Z_OK && res!=Z_STREAM_END && res!=Z_BUF_ERROR)
+            throw std::runtime_error("Corrupt deflate data in "+file_path);
+          output(out_buf.data(), out_buf.size()-zs.avail_out);
+        }
+      while(res!=Z_STREAM_END && zs.avail_out==0);
+      const auto n=avail-zs.avail_in;
+      offset+=n;
+      if(!(flags&flag_descriptor))
+        remaining-=n;
+      if(res==Z_STREAM_END)
+        end_data();
+      else if(!(flags&flag_descriptor) && remaining==0)
+        throw std::runtime_error("Corrupt deflate data in "+file_path);
+      return n;
+    }
+
+    void zip_extractor::output(const char* data, std::size_t size)
+    {
+      if(size==0)
+        return;
+      crc=crc32(crc, reinterpret_cast<const Bytef*>(data), static_cast<uInt>(size));
+      if(!file)
+        return;
+      file->write(data, size);
+      if(!*file)
+        throw std::runtime_error("Cannot write "+file_path);
+    }
+
+    void zip_extractor::end_data()
+    {
+      if(flags&flag_descriptor)
+        state=state_descriptor;
+      else
+        end_entry(expected_crc);
+    }
+
+    void zip_extractor::end_entry(std::uint32_t entry_crc)
+    {
+      buf.clear();
+      if(file)
+        {
+          file->close();
+          const bool ok=static_cast<bool>(*file);
+          file.reset();
+          if(!ok)
+            throw std::runtime_error("Cannot write "+file_path);
+        }
+      if(crc!=entry_crc)
+        throw std::runtime_error("Checksum mismatch in "+file_path);
+      state=state_header;
+      if(on_checkpoint)
+        on_checkpoint(offset);
+    }
+  }
+}
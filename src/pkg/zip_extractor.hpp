@@ -0,0 +1,112 @@
+/* Copyright (C) 2026  RHVoice contributors */
+
+/* This program is free software: you can redistribute it and/or modify */
+/* it under the terms of the GNU Lesser General Public License as published by */
+/* the Free Software Foundation, either version 2.1 of the License, or */
+/* (at your option) any later version. */
+
+/* This program is distributed in the hope that it will be useful, */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+/* GNU Lesser General Public License for more details. */
+
+/* You should have received a copy of the GNU Lesser General Public License */
+/* along with this program.  If not, see <https://www.gnu.org/licenses/>. */
+
+#ifndef RHVOICE_PKG_ZIP_EXTRACTOR_HPP
+#define RHVOICE_PKG_ZIP_EXTRACTOR_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <zlib.h>
+#include "boost/nowide/fstream.hpp"
+
+namespace RHVoice
+{
+  namespace pkg
+  {
+    // Extracts a zip archive while it is being downloaded, reading
+    // only the local headers, so the central directory at the end is
+    // never needed. The crc of each file is checked as soon as its
+    // data ends. Stored and deflated files are supported.
+    class zip_extractor final
+    {
+    public:
+      // Called after each complete entry with the offset in the
+      // archive where the next one starts. The download can be
+      // resumed from there by a new extractor.
+      using checkpoint_callback_t=std::function<void(std::uint64_t)>;
+
+      zip_extractor(const std::string& dir, std::uint64_t offset, checkpoint_callback_t cp_callback);
+      zip_extractor(const zip_extractor&)=delete;
+      zip_extractor& operator=(const zip_extractor&)=delete;
+      ~zip_extractor();
+
+      void write(const char* data, std::size_t size);
+      // Throws if the archive ended in the middle of an entry
+      void finish();
+
+      bool is_done() const
+      {
+        return (state==state_done);
+      }
+
+      std::uint64_t get_offset() const
+      {
+        return offset;
+      }
+
+    private:
+      enum state_t {state_header, state_name, state_data, state_descriptor, state_done};
+
+      static const std::uint32_t local_header_sig=0x04034b50;
+      static const std::uint32_t central_header_sig=0x02014b50;
+      static const std::uint32_t end_record_sig=0x06054b50;
+      static const std::uint32_t descriptor_sig=0x08074b50;
+      static const std::size_t local_header_size=30;
+      static const std::uint16_t flag_descriptor=8;
+      static const std::uint16_t method_stored=0;
+      static const std::uint16_t method_deflated=8;
+
+      bool fill(const char*& data, std::size_t& size, std::size_t needed);
+      std::uint16_t get_u16(std::size_t pos) const;
+      std::uint32_t get_u32(std::size_t pos) const;
+      std::uint64_t get_u64(std::size_t pos) const;
+      void parse_header();
+      void parse_name();
+      void read_zip64_sizes(std::size_t first, std::size_t last);
+      std::string get_target_path(const std::string& name) const;
+      void make_dirs(const std::string& name) const;
+      std::size_t read_stored(const char* data, std::size_t size);
+      std::size_t read_deflated(const char* data, std::size_t size);
+      void output(const char* data, std::size_t size);
+      void end_data();
+      void end_entry(std::uint32_t crc);
+
+      const std::string target_dir;
+      std::uint64_t offset;
+      checkpoint_callback_t on_checkpoint;
+      state_t state{state_header};
+      std::string buf;
+      // The current entry
+      std::uint16_t flags{0};
+      std::uint16_t method{0};
+      std::uint32_t expected_crc{0};
+      std::uint64_t compressed_size{0};
+      std::uint64_t remaining{0};
+      std::size_t name_size{0};
+      std::size_t extra_size{0};
+      bool zip64{false};
+      uLong crc{0};
+      std::unique_ptr<boost::nowide::ofstream> file;
+      std::string file_path;
+      z_stream zs;
+      bool zs_initialized{false};
+      std::vector<char> out_buf;
+    };
+  }
+}
+#endif
@@ -13,7 +13,8 @@
 /* You should have received a copy of the GNU General Public License */
 /* along with this program.  If not, see <https://www.gnu.org/licenses/>. */
 
-#include"speech_player.hpp"
+#include <algorithm>
+#include "speech_player.hpp"
 #include "io.hpp"
 
 namespace RHVoice
@@ -92,8 +93,8 @@ namespace RHVoice
               logger::log(2,"Reopening playback stream");
               playback_stream.open();
             }
-          logger::log(5,"Writing ",data.size()," samples to the playback stream");
-          playback_stream.write(&data[0],data.size());
+          logger::log(5,"Writing ",size," samples to the playback stream");
+          playback_stream.write(data,size);
         }
       catch(const audio::error& e)
         {
@@ -143,14 +144,168 @@ namespace RHVoice
         report_event(reached_index_mark(mark));
     }
 
+    speech_player::speech_player():
+      speech_ring(32768),
+      control_ring(256),
+      stopped(false),
+      producer_waiting(false),
+      consumer_waiting(false)
+    {
+    }
+
+    void speech_player::wake_producer()
+    {
+      if(!producer_waiting.load())
+        return;
+      std::lock_guard<std::mutex> lock(wait_mutex);
+      space_available.notify_one();
+    }
+
+    void speech_player::wake_consumer()
+    {
+      if(!consumer_waiting.load())
+        return;
+      std::lock_guard<std::mutex> lock(wait_mutex);
+      data_available.notify_one();
+    }
+
+    bool speech_player::wait_for_space(bool for_events)
+    {
+      std::unique_lock<std::mutex> lock(wait_mutex);
+      producer_waiting.store(true);
+      spsc_ring<short>& samples=speech_ring;
+      spsc_ring<control_event>& events=control_ring;
+      space_available.wait(lock,[&]{return (stopped.load()||!(for_events?events.full():samples.full()));});
+      producer_waiting.store(false);
+      return !stopped.load();
+    }
+
+    bool speech_player::wait_for_data()
+    {
+      std::unique_lock<std::mutex> lock(wait_mutex);
+      consumer_waiting.store(true);
+      spsc_ring<short>& samples=speech_ring;
+      spsc_ring<control_event>& events=control_ring;
+      data_available.wait(lock,[&]{return (stopped.load()||!samples.empty()||!events.empty());});
+      consumer_waiting.store(false);
+      return !stopped.load();
+    }
+
+    void speech_player::stop()
+    {
+      std::lock_guard<std::mutex> lock(wait_mutex);
+      stopped.store(true);
+      space_available.notify_all();
+      data_available.notify_all();
+    }
+
+    bool speech_player::play_speech(const short* samples,std::size_t count)
+    {
+      while(count>0)
+        {
+          short* first=0;
+          std::size_t n=std::min(count,speech_ring.get_write_span(first));
+          if(n==0)
+            {
+              // The playback thread discards the samples after a
+              // stop or pause request, so the wait is always short
+              if(!wait_for_space(false)||cancelled())
+                return false;
+              continue;
+            }
+          std::copy(samples,samples+n,first);
+          speech_ring.commit(n);
+          wake_consumer();
+          samples+=n;
+          count-=n;
+        }
+      return true;
+    }
+
+    void speech_player::post(control_type type,int sample_rate,const std::string& mark)
+    {
+      control_event* e=0;
+      while(control_ring.get_write_span(e)==0)
+        {
+          if(!wait_for_space(true))
+            return;
+        }
+      e->type=type;
+      e->position=speech_ring.get_write_position();
+      e->sample_rate=sample_rate;
+      e->mark.assign(mark);
+      control_ring.commit(1);
+      wake_consumer();
+    }
+
+    void speech_player::begin_speech()
+    {
+      post(control_start);
+    }
+
+    void speech_player::finish_speech()
+    {
+      post(control_end);
+    }
+
+    void speech_player::set_sample_rate(int sample_rate)
+    {
+      post(control_sample_rate,sample_rate);
+    }
+
+    void speech_player::add_mark(const std::string& name)
+    {
+      post(control_mark,0,name);
+    }
+
+    void speech_player::output(const control_event& e)
+    {
+      switch(e.type)
+        {
+        case control_start:
+          start_of_speech().output();
+          break;
+        case control_end:
+          end_of_speech().output();
+          break;
+        case control_sample_rate:
+          sample_rate_setting(e.sample_rate).output();
+          break;
+        case control_mark:
+          index_mark(e.mark).output();
+          break;
+        }
+    }
+
     void speech_player::run()
     {
       try
         {
-          synth_result_ptr ptr;
-          while(speech_queue.pop(ptr))
+          while(true)
             {
-              ptr->output();
+              control_event* e=0;
+              bool has_event=(control_ring.get_read_span(e)!=0);
+              std::size_t played=speech_ring.get_read_position();
+              if(has_event&&(e->position==played))
+                {
+                  output(*e);
+                  control_ring.release(1);
+                  wake_producer();
+                  continue;
+                }
+              short* first=0;
+              std::size_t n=std::min(speech_ring.get_read_span(first),max_chunk_size);
+              if(has_event)
+                n=std::min(n,e->position-played);
+              if(n!=0)
+                {
+                  speech_chunk(first,n).output();
+                  speech_ring.release(n);
+                  wake_producer();
+                  continue;
+                }
+              if(!wait_for_data())
+                break;
             }
         }
       catch(const std::exception& e)
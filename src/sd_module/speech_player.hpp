@@ -16,9 +16,13 @@
 #ifndef RHVOICE_SD_SPEECH_PLAYER_HPP
 #define RHVOICE_SD_SPEECH_PLAYER_HPP
 
-#include <vector>
+#include <string>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
 
 #include "core/threading.hpp"
+#include "spsc_ring.hpp"
 #include "base.hpp"
 #include "state.hpp"
 
@@ -75,8 +79,6 @@ namespace RHVoice
       void report_event(const event& e);
     };
 
-    typedef std::shared_ptr<synth_result> synth_result_ptr;
-
     class start_of_speech: public synth_result
     {
     public:
@@ -94,18 +96,21 @@ namespace RHVoice
 
     };
 
+    // Points into the audio ring, the samples are not copied
     class speech_chunk: public synth_result
     {
     public:
       explicit speech_chunk(const short* samples,std::size_t count):
-        data(samples,samples+count)
+        data(samples),
+        size(count)
       {
       }
 
       void output();
 
     private:
-      std::vector<short> data;
+      const short* data;
+      std::size_t size;
     };
 
     class sample_rate_setting: public synth_result
@@ -150,23 +155,70 @@ namespace RHVoice
       std::string mark;
     };
 
+    // The synthesis thread writes the samples into a preallocated
+    // ring, and everything else goes through a separate small ring of
+    // control events. Each event remembers how many samples had been
+    // written before it, so the playback thread can handle it at
+    // the right moment. The threads only take the mutex to sleep
+    // when one of them has to wait for the other.
     class speech_player: public base,public threading::thread
     {
     public:
-      void enqueue(const synth_result_ptr& ptr)
-      {
-        speech_queue.push(ptr);
-      }
+      speech_player();
 
-      void stop()
-      {
-        speech_queue.stop();
-      }
+      // All of these must be called from the synthesis thread
+      bool play_speech(const short* samples,std::size_t count);
+      void begin_speech();
+      void finish_speech();
+      void set_sample_rate(int sample_rate);
+      void add_mark(const std::string& name);
+
+      void stop();
 
     private:
+      enum control_type
+        {
+          control_start,
+          control_end,
+          control_sample_rate,
+          control_mark
+        };
+
+      struct control_event
+      {
+        control_type type;
+        std::size_t position;
+        int sample_rate;
+        std::string mark;
+
+        control_event():
+          type(control_start),
+          position(0),
+          sample_rate(0)
+        {
+        }
+      };
+
+      void post(control_type type,int sample_rate=0,const std::string& mark=std::string());
+      void output(const control_event& e);
+      bool wait_for_space(bool for_events);
+      bool wait_for_data();
+      void wake_producer();
+      void wake_consumer();
       void run();
 
-      threading::queue<synth_result_ptr> speech_queue;
+      // At 24 kHz this is about 20 ms, so that a stop request never
+      // has to wait for a long write to the playback stream
+      static const std::size_t max_chunk_size=512;
+
+      spsc_ring<short> speech_ring;
+      spsc_ring<control_event> control_ring;
+      std::atomic<bool> stopped;
+      std::atomic<bool> producer_waiting;
+      std::atomic<bool> consumer_waiting;
+      std::mutex wait_mutex;
+      std::condition_variable space_available;
+      std::condition_variable data_available;
     };
   }
 }
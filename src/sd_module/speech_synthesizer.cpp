@@ -91,9 +91,9 @@ namespace RHVoice
           tts_message msg;
           while(get_message(msg))
             {
-              player.enqueue(synth_result_ptr(new start_of_speech));
+              player.begin_speech();
               synthesize_message(msg);
-              player.enqueue(synth_result_ptr(new end_of_speech));
+              player.finish_speech();
         }
         }
       catch(const std::exception& e)
@@ -140,7 +140,7 @@ namespace RHVoice
 
     bool speech_synthesizer::process_mark(const std::string& name)
     {
-      player.enqueue(synth_result_ptr(new index_mark(name)));
+      player.add_mark(name);
       return (!cancelled_or_pausing());
     }
 
@@ -148,15 +148,14 @@ namespace RHVoice
     {
       if(cancelled())
         return false;
-      player.enqueue(synth_result_ptr(new speech_chunk(samples,count)));
-      return true;
+      return player.play_speech(samples,count);
     }
 
     bool speech_synthesizer::set_sample_rate(int sample_rate)
     {
       if(cancelled())
         return true;
-      player.enqueue(synth_result_ptr(new sample_rate_setting(sample_rate)));
+      player.set_sample_rate(sample_rate);
       return true;
     }
   }
@@ -0,0 +1,129 @@
+/* Copyright (C) 2026  RHVoice contributors */
+
+/* This program is free software: you can redistribute it and/or modify */
+/* it under the terms of the GNU General Public License as published by */
+/* the Free Software Foundation, either version 2 of the License, or */
+/* (at your option) any later version. */
+
+/* This program is distributed in the hope that it will be useful, */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+/* GNU General Public License for more details. */
+
+/* You should have received a copy of the GNU General Public License */
+/* along with this program.  If not, see <https://www.gnu.org/licenses/>. */
+
+#ifndef RHVOICE_SD_SPSC_RING_HPP
+#define RHVOICE_SD_SPSC_RING_HPP
+
+#include <cstddef>
+#include <vector>
+#include <atomic>
+#include <algorithm>
+
+namespace RHVoice
+{
+  namespace sd
+  {
+    // A fixed-size queue for exactly one producer thread and one
+    // consumer thread. All the storage is allocated up front, and
+    // the two sides only communicate through the read and write
+    // positions, which grow monotonically and are reduced modulo
+    // the capacity when indexing. The elements are exposed as
+    // contiguous spans, so that the producer can fill them in place
+    // and the consumer can pass them on without copying.
+    template<typename T>
+    class spsc_ring
+    {
+    public:
+      explicit spsc_ring(std::size_t min_capacity):
+        mask(round_up(min_capacity)-1),
+        data(mask+1),
+        write_pos(0),
+        read_pos(0)
+      {
+      }
+
+      std::size_t capacity() const
+      {
+        return data.size();
+      }
+
+      // Producer side. Returns the number of free slots which follow
+      // each other in memory starting from first.
+      std::size_t get_write_span(T*& first)
+      {
+        std::size_t w=write_pos.load(std::memory_order_relaxed);
+        std::size_t free=data.size()-(w-read_pos.load());
+        std::size_t offset=w&mask;
+        first=&data[offset];
+        return std::min(free,data.size()-offset);
+      }
+
+      void commit(std::size_t count)
+      {
+        write_pos.store(write_pos.load(std::memory_order_relaxed)+count);
+      }
+
+      // The total number of elements ever committed
+      std::size_t get_write_position() const
+      {
+        return write_pos.load(std::memory_order_relaxed);
+      }
+
+      bool full() const
+      {
+        return ((write_pos.load(std::memory_order_relaxed)-read_pos.load())==data.size());
+      }
+
+      // Consumer side
+      std::size_t get_read_span(T*& first)
+      {
+        std::size_t r=read_pos.load(std::memory_order_relaxed);
+        std::size_t available=write_pos.load()-r;
+        std::size_t offset=r&mask;
+        first=&data[offset];
+        return std::min(available,data.size()-offset);
+      }
+
+      void release(std::size_t count)
+      {
+        read_pos.store(read_pos.load(std::memory_order_relaxed)+count);
+      }
+
+      // The total number of elements ever released
+      std::size_t get_read_position() const
+      {
+        return read_pos.load(std::memory_order_relaxed);
+      }
+
+      bool empty() const
+      {
+        return (write_pos.load()==read_pos.load(std::memory_order_relaxed));
+      }
+
+    private:
+      spsc_ring(const spsc_ring&);
+      spsc_ring& operator=(const spsc_ring&);
+
+      static std::size_t round_up(std::size_t n)
+      {
+        std::size_t result=1;
+        while(result<n)
+          result<<=1;
+        return result;
+      }
+
+      const std::size_t mask;
+      std::vector<T> data;
+      // Keep the positions on separate cache lines, each of them is
+      // written by only one of the threads
+      char padding1[64];
+      std::atomic<std::size_t> write_pos;
+      char padding2[64];
+      std::atomic<std::size_t> read_pos;
+      char padding3[64];
+    };
+  }
+}
+#endif
@@ -17,8 +17,12 @@
 #include <iostream>
 #include <vector>
 #include <iterator>
+#include <memory>
+#include <unistd.h>
 #include <giomm.h>
+#include <gio/gunixfdlist.h>
 #include "common.hpp"
+#include "shared_buffer.hpp"
 #include "tclap/CmdLine.h"
 
 namespace
@@ -28,8 +32,10 @@ namespace
   public:
     double pitch,rate,volume;
     Glib::ustring speakers;
+    bool shared_memory;
 
-    params()
+    params():
+      shared_memory(false)
     {
     }
 
@@ -72,6 +78,7 @@ namespace
   Glib::RefPtr<Gio::DBus::Connection> connection;
   Glib::RefPtr<Gio::DBus::Proxy> proxy;
   bool wave_header_written=false;
+  std::unique_ptr<RHVoice::service::shared_speech_buffer> shared_buffer;
   params user_prefs;
 
   struct quit_main_loop
@@ -89,11 +96,13 @@ namespace
     TCLAP::ValueArg<double> rate_arg("r","rate","Speech rate",false,0,&speech_param_range,cmd);
     TCLAP::ValueArg<double> volume_arg("v","volume","Speech volume",false,0,&speech_param_range,cmd);
     TCLAP::ValueArg<std::string> speakers_arg("s","speakers","Speakers",true,"","spec",cmd);
+    TCLAP::SwitchArg shared_memory_arg("m","shared-memory","Receive the speech through shared memory",cmd,false);
     cmd.parse(argc,argv);
     pitch=pitch_arg.getValue();
     rate=rate_arg.getValue();
     volume=volume_arg.getValue();
     speakers=speakers_arg.getValue();
+    shared_memory=shared_memory_arg.getValue();
   }
 
   void call_method(const Glib::ustring& name)
@@ -127,6 +136,34 @@ namespace
     call_method("SpeakText",text);
   }
 
+  void open_shared_buffer()
+  {
+    GError* error=0;
+    GUnixFDList* fd_list=0;
+    GVariant* result=g_dbus_proxy_call_with_unix_fd_list_sync(proxy->gobj(),"OpenSharedBuffer",0,G_DBUS_CALL_FLAGS_NONE,-1,0,&fd_list,0,&error);
+    if(!result)
+      throw Glib::Error(error);
+    gint32 index=0;
+    gint32 event_index=0;
+    guint32 capacity=0;
+    g_variant_get(result,"(hhu)",&index,&event_index,&capacity);
+    g_variant_unref(result);
+    int fd=g_unix_fd_list_get(fd_list,index,&error);
+    if(fd<0)
+      {
+        g_object_unref(fd_list);
+        throw Glib::Error(error);
+      }
+    int event_fd=g_unix_fd_list_get(fd_list,event_index,&error);
+    g_object_unref(fd_list);
+    if(event_fd<0)
+      {
+        close(fd);
+        throw Glib::Error(error);
+      }
+    shared_buffer=RHVoice::service::shared_speech_buffer::attach(fd,event_fd);
+  }
+
   void set_properties()
   {
     call_method("SetPitch",user_prefs.pitch);
@@ -179,10 +216,30 @@ namespace
     std::cout.write(reinterpret_cast<const char*>(&samples[0]),sizeof(gint16)*samples.size());
   }
 
+  void read_audio(const Glib::VariantContainerBase& params)
+  {
+    if(!shared_buffer)
+      return;
+    if(!wave_header_written)
+      write_wave_header();
+    Glib::Variant<guint64> vposition;
+    params.get_child(vposition);
+    guint64 position=vposition.get();
+    const short* first=0;
+    std::size_t count=0;
+    while((count=shared_buffer->get_read_span(position,first))!=0)
+      {
+        std::cout.write(reinterpret_cast<const char*>(first),sizeof(gint16)*count);
+        shared_buffer->release(count);
+      }
+  }
+
   void on_signal(const Glib::ustring& sender,const Glib::ustring& signal_name,const Glib::VariantContainerBase& params)
   {
     if(signal_name=="SpeechAvailable")
       write_audio(params);
+    else if(signal_name=="SpeechWritten")
+      read_audio(params);
     else if(signal_name=="Finished")
       Glib::signal_idle().connect_once(quit_main_loop());
   }
@@ -193,6 +250,8 @@ namespace
       {
         proxy=Gio::DBus::Proxy::create_finish(result);
         proxy->signal_signal().connect(sigc::ptr_fun(&on_signal));
+        if(user_prefs.shared_memory)
+          open_shared_buffer();
         set_properties();
         send_text();
       }
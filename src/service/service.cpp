@@ -19,12 +19,15 @@
 #include <map>
 #include <queue>
 #include <algorithm>
+#include <stdexcept>
 #include <giomm.h>
+#include <gio/gunixfdlist.h>
 
 #include "core/engine.hpp"
 #include "core/document.hpp"
 #include "core/client.hpp"
 #include "common.hpp"
+#include "shared_buffer.hpp"
 
 namespace
 {
@@ -76,9 +79,18 @@ namespace
                                         "<method name='SetSpeakers'>"
                                         "<arg name='speakers' type='s' direction='in'/>"
                                         "</method>"
+                                        "<method name='Reload'/>"
+                                        "<method name='OpenSharedBuffer'>"
+                                        "<arg name='buffer' type='h' direction='out'/>"
+                                        "<arg name='wakeup' type='h' direction='out'/>"
+                                        "<arg name='capacity' type='u' direction='out'/>"
+                                        "</method>"
                                         "<signal name='SpeechAvailable'>"
                                         "<arg name='samples' type='an' direction='out'/>"
                                         "</signal>"
+                                        "<signal name='SpeechWritten'>"
+                                        "<arg name='position' type='t' direction='out'/>"
+                                        "</signal>"
                                         "<signal name='Finished'/>"
                                         "</interface>"
                                         "</node>");
@@ -91,6 +103,8 @@ namespace
   Glib::ThreadPool thread_pool;
   session_map sessions;
   std::shared_ptr<RHVoice::engine> global_engine_ref;
+  // About ten seconds at 24 kHz
+  const std::size_t shared_buffer_capacity=1<<18;
 
   struct quit_main_loop
   {
@@ -100,6 +114,35 @@ namespace
     }
   };
 
+  // Runs on the thread pool, so the main loop and the running tasks
+  // are not held up while the dictionaries are being rebuilt. The
+  // caller gets the reply when the reload has finished.
+  struct reload_engine
+  {
+    explicit reload_engine(const Glib::RefPtr<Gio::DBus::MethodInvocation>& invocation_):
+      invocation(invocation_)
+    {
+    }
+
+    void operator()() const
+    {
+      try
+        {
+          global_engine_ref->reload();
+        }
+      catch(const std::exception& e)
+        {
+          std::cerr << "Reload Error: '" << e.what() << "'" << std::endl;
+          Gio::DBus::Error error(Gio::DBus::Error::FAILED,e.what());
+          invocation->return_error(error);
+          return;
+        }
+      invocation->return_value(Glib::VariantContainerBase());
+    }
+
+    Glib::RefPtr<Gio::DBus::MethodInvocation> invocation;
+  };
+
   template <typename T>
   T extract(const Glib::VariantBase& base)
   {
@@ -167,6 +210,7 @@ namespace
     session(const Glib::RefPtr<Gio::DBus::Connection>& connection,const Glib::ustring& name);
 
     result_dispatcher<speech_fragment> speech_available;
+    Glib::Dispatcher speech_written;
     Glib::Dispatcher task_finished;
 
     bool is_speaking() const
@@ -237,6 +281,27 @@ namespace
       return speakers;
     }
 
+    // Once the client has the buffer, the speech goes through it
+    // instead of the SpeechAvailable signal
+    const RHVoice::service::shared_speech_buffer& open_shared_buffer();
+
+    RHVoice::service::shared_speech_buffer* get_shared_buffer()
+    {
+      return shared_buffer.get();
+    }
+
+    // Called by the synthesis thread when the client has broken the
+    // ring. No more speech is sent to such a client.
+    void fail_shared_buffer()
+    {
+      g_atomic_int_set(&shared_buffer_failed,true);
+    }
+
+    bool has_failed_shared_buffer() const
+    {
+      return g_atomic_int_get(&shared_buffer_failed);
+    }
+
       private:
     session(const session&);
     session& operator=(const session&);
@@ -264,6 +329,7 @@ namespace
     }
 
     void on_speech_available(const speech_fragment& samples);
+    void on_speech_written();
     void on_task_finished();
 
     void set_stopping(bool value=true)
@@ -278,6 +344,9 @@ namespace
     bool closing;
     double pitch,rate,volume;
     std::string speakers;
+    std::unique_ptr<RHVoice::service::shared_speech_buffer> shared_buffer;
+    volatile gint shared_buffer_failed;
+    guint64 notified_position;
   };
 
   class clear_session
@@ -355,8 +424,11 @@ namespace
     closing(false),
     pitch(0),
     rate(0),
-    volume(0)
+    volume(0),
+    shared_buffer_failed(false),
+    notified_position(0)
   {
+    speech_written.connect(sigc::mem_fun(*this,&session::on_speech_written));
     task_finished.connect(sigc::mem_fun(*this,&session::on_task_finished));
   }
 
@@ -375,7 +447,12 @@ namespace
   void session::stop()
   {
     if(is_speaking())
-      set_stopping();
+      {
+        set_stopping();
+        // The synthesis thread may be waiting for the client
+        if(shared_buffer)
+          shared_buffer->notify();
+      }
   }
 
   void session::close()
@@ -393,8 +470,35 @@ namespace
     emit_signal("SpeechAvailable",samples);
   }
 
+  const RHVoice::service::shared_speech_buffer& session::open_shared_buffer()
+  {
+    if(!shared_buffer)
+      {
+        if(is_speaking())
+          throw std::logic_error("Cannot switch to a shared buffer while speaking");
+        shared_buffer=RHVoice::service::shared_speech_buffer::create(shared_buffer_capacity);
+      }
+    return *shared_buffer;
+  }
+
+  // The dispatcher may be triggered many times before the main loop
+  // gets to it, so a single signal can announce several fragments
+  void session::on_speech_written()
+  {
+    if(!shared_buffer)
+      return;
+    guint64 position=shared_buffer->get_write_position();
+    if(position==notified_position)
+      return;
+    notified_position=position;
+    emit_signal("SpeechWritten",position);
+  }
+
   void session::on_task_finished()
   {
+    // The dispatchers don't keep the order between each other, so
+    // make sure the client has been told about all the speech
+    on_speech_written();
     if(is_closing())
       Glib::signal_idle().connect_once(clear_session(name));
     else
@@ -454,11 +558,39 @@ namespace
   {
     if(parent.is_stopping())
       return false;
-    else
+    RHVoice::service::shared_speech_buffer* buffer=parent.get_shared_buffer();
+    if(!buffer)
       {
         parent.speech_available(speech_fragment(samples,samples+count));
         return true;
       }
+    if(parent.has_failed_shared_buffer())
+      return false;
+    try
+      {
+        while(count>0)
+          {
+            std::size_t n=buffer->write(samples,count);
+            if(n==0)
+              {
+                // The client has not caught up yet
+                if(parent.is_stopping())
+                  return false;
+                buffer->wait();
+                continue;
+              }
+            samples+=n;
+            count-=n;
+            parent.speech_written();
+          }
+      }
+    catch(const std::exception& e)
+      {
+        std::cerr << "Shared Buffer Error: '" << e.what() << "'" << std::endl;
+        parent.fail_shared_buffer();
+        return false;
+      }
+    return true;
   }
 
   std::unique_ptr<RHVoice::document> text_task::create_document() const
@@ -532,6 +664,13 @@ namespace
         Gio::DBus::Error error(Gio::DBus::Error::INVALID_ARGS,"Previous request is still being processed");
         invocation->return_error(error);
       }
+    if((current_session->has_failed_shared_buffer())&&
+       (method_name=="SpeakText"))
+      {
+        Gio::DBus::Error error(Gio::DBus::Error::FAILED,"The shared buffer has been corrupted");
+        invocation->return_error(error);
+        return;
+      }
     Glib::VariantContainerBase result;
     if(method_name=="SpeakText")
       current_session->speak_text(extract_child<Glib::ustring>(params));
@@ -555,6 +694,41 @@ namespace
             invocation->return_error(error);
           }
       }
+    else if(method_name=="Reload")
+      {
+        thread_pool.push(reload_engine(invocation));
+        return;
+      }
+    else if(method_name=="OpenSharedBuffer")
+      {
+        // giomm has no portable wrapper for returning descriptors
+        GError* error=0;
+        GUnixFDList* fd_list=0;
+        try
+          {
+            const RHVoice::service::shared_speech_buffer& buffer=current_session->open_shared_buffer();
+            fd_list=g_unix_fd_list_new();
+            gint index=g_unix_fd_list_append(fd_list,buffer.get_fd(),&error);
+            if(index<0)
+              throw std::runtime_error(error->message);
+            gint event_index=g_unix_fd_list_append(fd_list,buffer.get_event_fd(),&error);
+            if(event_index<0)
+              throw std::runtime_error(error->message);
+            g_dbus_method_invocation_return_value_with_unix_fd_list(invocation->gobj(),
+                                                                   g_variant_new("(hhu)",index,event_index,static_cast<guint32>(buffer.capacity())),
+                                                                   fd_list);
+          }
+        catch(const std::exception& e)
+          {
+            Gio::DBus::Error dbus_error(Gio::DBus::Error::FAILED,e.what());
+            invocation->return_error(dbus_error);
+          }
+        if(error)
+          g_error_free(error);
+        if(fd_list)
+          g_object_unref(fd_list);
+        return;
+      }
     else
       {
         Gio::DBus::Error error(Gio::DBus::Error::UNKNOWN_METHOD,"Method does not exist.");
@@ -0,0 +1,207 @@
+/* Copyright (C) 2026  RHVoice contributors */
+
+/* This program is free software: you can redistribute it and/or modify */
+/* it under the terms of the GNU General Public License as published by */
+/* the Free Software Foundation, either version 2 of the License, or */
+/* (at your option) any later version. */
+
+/* This program is distributed in the hope that it will be useful, */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+/* GNU General Public License for more details. */
+
+/* You should have received a copy of the GNU General Public License */
+/* along with this program.  If not, see <https://www.gnu.org/licenses/>. */
+
+#include <cstdlib>
+#include <cerrno>
+#include <new>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <system_error>
+#include <stdexcept>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/eventfd.h>
+#include "shared_buffer.hpp"
+
+namespace RHVoice
+{
+  namespace service
+  {
+    namespace
+    {
+      int create_anonymous_file()
+      {
+#ifdef MFD_CLOEXEC
+        int fd=memfd_create("RHVoice-speech",MFD_CLOEXEC);
+        if(fd!=-1)
+          return fd;
+#endif
+        // Systems without memfd get an unlinked temporary file
+        const char* dir=std::getenv("XDG_RUNTIME_DIR");
+        std::string path((dir!=0)?dir:"/tmp");
+        path+="/RHVoice-speech-XXXXXX";
+        std::vector<char> tmpl(path.begin(),path.end());
+        tmpl.push_back('\0');
+        int tmp_fd=mkstemp(&tmpl[0]);
+        if(tmp_fd==-1)
+          throw std::system_error(errno,std::generic_category(),"Cannot create the shared speech buffer");
+        unlink(&tmpl[0]);
+        fcntl(tmp_fd,F_SETFD,FD_CLOEXEC);
+        return tmp_fd;
+      }
+    }
+
+    shared_speech_buffer::shared_speech_buffer(int fd_,int event_fd_,std::size_t size_):
+      fd(fd_),
+      event_fd(event_fd_),
+      size(size_),
+      header(0),
+      samples(0),
+      cap(0),
+      written(0)
+    {
+      void* addr=mmap(0,size,PROT_READ|PROT_WRITE,MAP_SHARED,fd,0);
+      if(addr==MAP_FAILED)
+        {
+          int error=errno;
+          close(fd);
+          close(event_fd);
+          throw std::system_error(error,std::generic_category(),"Cannot map the shared speech buffer");
+        }
+      header=static_cast<layout*>(addr);
+      samples=reinterpret_cast<short*>(header+1);
+    }
+
+    shared_speech_buffer::~shared_speech_buffer()
+    {
+      munmap(header,size);
+      close(fd);
+      close(event_fd);
+    }
+
+    std::unique_ptr<shared_speech_buffer> shared_speech_buffer::create(std::size_t min_capacity)
+    {
+      std::size_t capacity=1;
+      while(capacity<min_capacity)
+        capacity<<=1;
+      std::size_t size=sizeof(layout)+capacity*sizeof(short);
+      int fd=create_anonymous_file();
+      if(ftruncate(fd,size)!=0)
+        {
+          int error=errno;
+          close(fd);
+          throw std::system_error(error,std::generic_category(),"Cannot allocate the shared speech buffer");
+        }
+      int event_fd=eventfd(0,EFD_CLOEXEC);
+      if(event_fd==-1)
+        {
+          int error=errno;
+          close(fd);
+          throw std::system_error(error,std::generic_category(),"Cannot create the wakeup descriptor of the shared speech buffer");
+        }
+      std::unique_ptr<shared_speech_buffer> result(new shared_speech_buffer(fd,event_fd,size));
+      layout* h=new(result->header) layout;
+      h->magic=layout_magic;
+      h->capacity=capacity;
+      result->cap=capacity;
+      h->write_pos.store(0);
+      h->read_pos.store(0);
+      return result;
+    }
+
+    std::unique_ptr<shared_speech_buffer> shared_speech_buffer::attach(int fd,int event_fd)
+    {
+      struct stat info;
+      if(fstat(fd,&info)!=0)
+        {
+          int error=errno;
+          close(fd);
+          close(event_fd);
+          throw std::system_error(error,std::generic_category(),"Cannot access the shared speech buffer");
+        }
+      std::size_t size=info.st_size;
+      if(size<sizeof(layout))
+        {
+          close(fd);
+          close(event_fd);
+          throw std::runtime_error("The shared speech buffer is too small");
+        }
+      std::unique_ptr<shared_speech_buffer> result(new shared_speech_buffer(fd,event_fd,size));
+      const layout* h=result->header;
+      if((h->magic!=layout_magic)||(h->capacity==0)||((h->capacity&(h->capacity-1))!=0)||(sizeof(layout)+h->capacity*sizeof(short)>size))
+        throw std::runtime_error("Invalid shared speech buffer");
+      result->cap=h->capacity;
+      return result;
+    }
+
+    std::size_t shared_speech_buffer::write(const short* data,std::size_t count)
+    {
+      // The other side can write anything into the shared memory,
+      // so only our own copy of the write position is trusted
+      std::uint64_t w=written.load(std::memory_order_relaxed);
+      std::uint64_t r=header->read_pos.load(std::memory_order_acquire);
+      if((r>w)||(w-r>cap))
+        throw std::runtime_error("The client has corrupted the shared speech buffer");
+      std::size_t free=cap-static_cast<std::size_t>(w-r);
+      std::size_t total=std::min(count,free);
+      std::size_t offset=w&(cap-1);
+      std::size_t first_part=std::min(total,cap-offset);
+      std::copy(data,data+first_part,samples+offset);
+      std::copy(data+first_part,data+total,samples);
+      written.store(w+total,std::memory_order_relaxed);
+      header->write_pos.store(w+total,std::memory_order_release);
+      return total;
+    }
+
+    void shared_speech_buffer::wait() const
+    {
+      pollfd p;
+      p.fd=event_fd;
+      p.events=POLLIN;
+      p.revents=0;
+      while(poll(&p,1,-1)==-1)
+        {
+          if(errno!=EINTR)
+            throw std::system_error(errno,std::generic_category(),"Cannot wait for the client");
+        }
+      // Reset the counter, the caller will check the positions anyway
+      std::uint64_t value;
+      if(read(event_fd,&value,sizeof(value))==-1)
+        {
+          if(errno!=EAGAIN)
+            throw std::system_error(errno,std::generic_category(),"Cannot wait for the client");
+        }
+    }
+
+    void shared_speech_buffer::notify() const
+    {
+      const std::uint64_t value=1;
+      // The counter can only overflow if nobody ever waits, then a
+      // wakeup is pending anyway
+      ssize_t res=::write(event_fd,&value,sizeof(value));
+      (void)res;
+    }
+
+    std::size_t shared_speech_buffer::get_read_span(std::uint64_t end_pos,const short*& first) const
+    {
+      std::uint64_t r=header->read_pos.load(std::memory_order_relaxed);
+      std::uint64_t w=std::min<std::uint64_t>(end_pos,header->write_pos.load(std::memory_order_acquire));
+      std::size_t available=(w>r)?static_cast<std::size_t>(std::min<std::uint64_t>(w-r,cap)):0;
+      std::size_t offset=r&(cap-1);
+      first=samples+offset;
+      return std::min(available,cap-offset);
+    }
+
+    void shared_speech_buffer::release(std::size_t count)
+    {
+      header->read_pos.store(header->read_pos.load(std::memory_order_relaxed)+count,std::memory_order_release);
+      notify();
+    }
+  }
+}
@@ -0,0 +1,110 @@
+/* Copyright (C) 2026  RHVoice contributors */
+
+/* This program is free software: you can redistribute it and/or modify */
+/* it under the terms of the GNU General Public License as published by */
+/* the Free Software Foundation, either version 2 of the License, or */
+/* (at your option) any later version. */
+
+/* This program is distributed in the hope that it will be useful, */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+/* GNU General Public License for more details. */
+
+/* You should have received a copy of the GNU General Public License */
+/* along with this program.  If not, see <https://www.gnu.org/licenses/>. */
+
+#ifndef RHVOICE_SERVICE_SHARED_BUFFER_HPP
+#define RHVOICE_SERVICE_SHARED_BUFFER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <memory>
+
+namespace RHVoice
+{
+  namespace service
+  {
+    // A ring of 16-bit samples in an anonymous shared memory file.
+    // The service creates it and passes the file descriptor to the
+    // client once, then the synthesis thread of the session writes
+    // the speech straight into it and the client reads it from its
+    // own mapping. Only the positions of the two sides are shared,
+    // they grow monotonically and are reduced modulo the capacity
+    // when indexing. An eventfd passed together with the memory wakes
+    // the producer when the consumer has freed some space.
+    class shared_speech_buffer
+    {
+    public:
+      ~shared_speech_buffer();
+
+      // The capacity is rounded up to a power of two
+      static std::unique_ptr<shared_speech_buffer> create(std::size_t min_capacity);
+      // Takes ownership of the descriptors
+      static std::unique_ptr<shared_speech_buffer> attach(int fd,int event_fd);
+
+      int get_fd() const
+      {
+        return fd;
+      }
+
+      int get_event_fd() const
+      {
+        return event_fd;
+      }
+
+      std::size_t capacity() const
+      {
+        return cap;
+      }
+
+      // Producer side. Copies as many samples as there is room for,
+      // and returns their number. Throws if the consumer has put an
+      // impossible read position into the shared memory.
+      std::size_t write(const short* data,std::size_t count);
+
+      std::uint64_t get_write_position() const
+      {
+        return written.load();
+      }
+
+      // Blocks until the consumer releases some samples or someone
+      // calls notify
+      void wait() const;
+
+      // Consumer side. Returns the number of samples up to the given
+      // position which follow each other in memory starting from
+      // first.
+      std::size_t get_read_span(std::uint64_t end_pos,const short*& first) const;
+      // Also wakes the producer
+      void release(std::size_t count);
+
+      void notify() const;
+
+    private:
+      struct layout
+      {
+        std::uint32_t magic;
+        std::uint32_t capacity;
+        std::atomic<std::uint64_t> write_pos;
+        std::atomic<std::uint64_t> read_pos;
+      };
+
+      static const std::uint32_t layout_magic=0x52485342;
+
+      shared_speech_buffer(int fd_,int event_fd_,std::size_t size_);
+      shared_speech_buffer(const shared_speech_buffer&);
+      shared_speech_buffer& operator=(const shared_speech_buffer&);
+
+      int fd;
+      int event_fd;
+      std::size_t size;
+      layout* header;
+      short* samples;
+      // Private copies, the ones in the header are only for the other side
+      std::size_t cap;
+      std::atomic<std::uint64_t> written;
+    };
+  }
+}
+#endif
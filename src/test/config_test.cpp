@@ -0,0 +1,112 @@
+/* Copyright (C) 2026  RHVoice contributors */
+
+/* This program is free software: you can redistribute it and/or modify */
+/* it under the terms of the GNU General Public License as published by */
+/* the Free Software Foundation, either version 2 of the License, or */
+/* (at your option) any later version. */
+
+/* This program is distributed in the hope that it will be useful, */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+/* GNU General Public License for more details. */
+
+/* You should have received a copy of the GNU General Public License */
+/* along with this program.  If not, see <https://www.gnu.org/licenses/>. */
+
+// Checks the precedence of the values of a shared configuration: a
+// value assigned in the code wins over the file, and the changes made
+// through set and reset survive a reload of the file.
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+#include "core/config.hpp"
+
+using namespace RHVoice;
+
+namespace
+{
+  std::size_t failures=0;
+
+  void expect(bool cond, const std::string& what)
+  {
+    if(cond)
+      return;
+    std::cerr << "FAILED: " << what << std::endl;
+    ++failures;
+  }
+
+  void write_file(const std::string& path, const std::string& text)
+  {
+    std::ofstream f(path.c_str());
+    f << text;
+  }
+
+  unsigned int read_in_thread(const numeric_property<unsigned int>& p)
+  {
+    unsigned int v=0;
+    std::thread t([&p, &v] {v=p;});
+    t.join();
+    return v;
+  }
+}
+
+int main()
+{
+  char path_buf[]="/tmp/rhvoice-config-test-XXXXXX";
+  const int fd=mkstemp(path_buf);
+  if(fd<0)
+    {
+      std::cerr << "Cannot create a temporary file" << std::endl;
+      return 1;
+    }
+  close(fd);
+  const std::string path(path_buf);
+  write_file(path, "view_size=4\nquality=3\nlevel=5\n");
+  {
+    config cfg(true);
+    numeric_property<unsigned int> view_size("view_size", 2, 1, 10);
+    numeric_property<unsigned int> quality("quality", 1, 0, 10);
+    numeric_property<unsigned int> level("level", 0, 0, 10);
+    cfg.register_setting(view_size);
+    cfg.register_setting(quality);
+    cfg.register_setting(level);
+    cfg.load(path);
+    expect(view_size==4, "the file is read");
+    view_size=7;
+    expect(view_size==7, "a value assigned in the code wins over the file");
+    expect(read_in_thread(view_size)==7, "the assigned value is seen by other threads");
+    {
+      setting_values::scope s(cfg.get_values());
+      expect(view_size==7, "the assigned value wins over the snapshot of an utterance");
+    }
+    expect(quality==3, "a value read before a change");
+    cfg.set("quality", "6");
+    expect(quality==6, "set is seen by the thread which has read the old snapshot");
+    expect(read_in_thread(quality)==6, "set is seen by other threads");
+    cfg.reset("level");
+    expect(level==0, "reset restores the default");
+    write_file(path, "view_size=5\nquality=8\nlevel=9\n");
+    cfg.publish(cfg.read(path));
+    expect(quality==6, "a value set at run time survives a reload");
+    expect(level==0, "a reset at run time survives a reload");
+    expect(view_size==7, "an assigned value survives a reload");
+    view_size.reset();
+    expect(view_size==5, "the reloaded file is used when nothing overrides it");
+    cfg.reset();
+    cfg.publish(cfg.read(path));
+    expect(quality==8 && level==9, "a full reset drops the overrides");
+  }
+  std::remove(path.c_str());
+  if(failures!=0)
+    {
+      std::cerr << failures << " checks failed" << std::endl;
+      return 1;
+    }
+  return 0;
+}
@@ -0,0 +1,109 @@
+/* Copyright (C) 2026  RHVoice contributors */
+
+/* This program is free software: you can redistribute it and/or modify */
+/* it under the terms of the GNU General Public License as published by */
+/* the Free Software Foundation, either version 2 of the License, or */
+/* (at your option) any later version. */
+
+/* This program is distributed in the hope that it will be useful, */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+/* GNU General Public License for more details. */
+
+/* You should have received a copy of the GNU General Public License */
+/* along with this program.  If not, see <https://www.gnu.org/licenses/>. */
+
+// Checks that a text received in chunks by append_text and
+// finish_input is split into the same sentences and tokens, with the
+// same positions and lengths which the word events report, as the
+// same text parsed at once by create_from_plain_text. The chunks can
+// end in the middle of a token or of a multibyte sequence.
+
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "core/document.hpp"
+
+using namespace RHVoice;
+
+namespace
+{
+  std::string print(const document& doc)
+  {
+    std::ostringstream out;
+    for(document::const_iterator it(doc.begin());it!=doc.end();++it)
+      {
+        it->print(out);
+        out << "--" << std::endl;
+      }
+    return out.str();
+  }
+
+  std::string parse_at_once(const std::shared_ptr<engine>& eng,const std::string& text,content_type say_as)
+  {
+    std::unique_ptr<document> doc=document::create_from_plain_text(eng,text.begin(),text.end(),say_as);
+    return print(*doc);
+  }
+
+  std::string parse_in_chunks(const std::shared_ptr<engine>& eng,const std::string& text,content_type say_as,std::size_t chunk_size)
+  {
+    std::unique_ptr<document> doc=document::create_incremental(eng,say_as);
+    for(std::size_t pos=0;pos<text.size();pos+=chunk_size)
+      doc->append_text(text.data()+pos,std::min(chunk_size,text.size()-pos));
+    doc->finish_input();
+    return print(*doc);
+  }
+
+  std::string repeat(const std::string& s,std::size_t n)
+  {
+    std::string res;
+    for(std::size_t i=0;i<n;++i)
+      res+=s;
+    return res;
+  }
+}
+
+int main()
+{
+  engine::init_params params;
+  params.data_path.clear();
+  // Nothing is read from the configuration directory
+  params.config_path="/nonexistent";
+  std::shared_ptr<engine> eng(new engine(params));
+  std::vector<std::string> texts;
+  texts.push_back("Hello, world. This is a test!  Mr. Smith said: \"ok\".\n\nA new paragraph\tafter a tab. 3.14 is not the end.");
+  texts.push_back("\xd0\x9f\xd1\x80\xd0\xb8\xd0\xb2\xd0\xb5\xd1\x82, \xd0\xbc\xd0\xb8\xd1\x80. e\xcc\x81t\xc3\xa9 \xf0\x9f\x91\xa9\xe2\x80\x8d\xf0\x9f\x92\xbb\xf0\x9f\x91\x8d done.");
+  // Longer than any token and than the old limit of the pending input
+  texts.push_back("start "+repeat("a",5000)+" end "+repeat("\xd0\xb6",3000));
+  // More tokens than a sentence can have
+  texts.push_back(repeat("w ",150)+repeat("x",150)+" "+repeat("y ",30));
+  texts.push_back("   leading and trailing whitespace   ");
+  const content_type types[]={content_text,content_chars};
+  const std::size_t chunk_sizes[]={1,2,3,5,7,64,199,200,201,4096};
+  std::size_t failures=0;
+  for(std::size_t i=0;i<texts.size();++i)
+    {
+      for(content_type say_as: types)
+        {
+          const std::string expected=parse_at_once(eng,texts[i],say_as);
+          for(std::size_t chunk_size: chunk_sizes)
+            {
+              if(parse_in_chunks(eng,texts[i],say_as,chunk_size)==expected)
+                continue;
+              std::cerr << "Text " << i << " in mode " << say_as << " is parsed differently in chunks of " << chunk_size << " bytes" << std::endl;
+              ++failures;
+            }
+        }
+    }
+  if(failures!=0)
+    {
+      std::cerr << failures << " checks failed" << std::endl;
+      return 1;
+    }
+  return 0;
+}
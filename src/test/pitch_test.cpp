@@ -0,0 +1,203 @@
+/* Copyright (C) 2026  RHVoice contributors */
+
+/* This program is free software: you can redistribute it and/or modify */
+/* it under the terms of the GNU General Public License as published by */
+/* the Free Software Foundation, either version 2 of the License, or */
+/* (at your option) any later version. */
+
+/* This program is distributed in the hope that it will be useful, */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+/* GNU General Public License for more details. */
+
+/* You should have received a copy of the GNU General Public License */
+/* along with this program.  If not, see <https://www.gnu.org/licenses/>. */
+
+// Compares the pitch stylizer with the straightforward implementation
+// it replaced, which kept the distances in a std::set. Both must
+// remove the same points in the same order and so give exactly the
+// same contour.
+
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "core/pitch.hpp"
+
+using namespace RHVoice;
+
+namespace
+{
+  const double threshold=1.5*std::log(2.0)/12.0;
+
+  class reference_stylizer
+  {
+  public:
+    typedef std::vector<double> result_t;
+
+    result_t stylize(const std::vector<double>& values) const
+    {
+      points.clear();
+      dists.clear();
+      result_t res;
+      if(values.empty())
+        return res;
+      for(std::size_t i=0;i<values.size();++i)
+        {
+          point_t p;
+          p.value=values[i];
+          p.prev_index=(i>0)?(i-1):0;
+          p.next_index=((i+1)<values.size())?(i+1):0;
+          p.distance=0;
+          points.push_back(p);
+}
+      for(std::size_t i=1;(i+1)<points.size();++i)
+        {
+          set_distance(i);
+          dists.insert(dist_t(points[i].distance,i));
+}
+      while(!dists.empty()&&(dists.begin()->value<threshold))
+        remove_point();
+      std::size_t i=0;
+      do
+        {
+          const point_t& p=points[i];
+          res.push_back(p.value);
+          for(std::size_t j=i+1;j<p.next_index;++j)
+            res.push_back(get_expected_value(j,i,p.next_index));
+          i=p.next_index;
+}
+      while(i>0);
+      return res;
+}
+
+  private:
+    struct point_t
+    {
+      double value;
+      std::size_t prev_index;
+      std::size_t next_index;
+      double distance;
+    };
+
+    struct dist_t
+    {
+      double value;
+      std::size_t index;
+
+      dist_t(double v,std::size_t i):
+        value(v),
+        index(i)
+      {
+}
+
+      bool operator<(const dist_t& other) const
+      {
+        if(value<other.value)
+          return true;
+        if(value>other.value)
+          return false;
+        return (index<other.index);
+}
+    };
+
+    double get_expected_value(std::size_t i,std::size_t il,std::size_t ir) const
+    {
+      return pitch::interpolate(i,il,points[il].value,ir,points[ir].value);
+}
+
+    void set_distance(std::size_t i) const
+    {
+      point_t& p=points[i];
+      p.distance=std::abs(p.value-get_expected_value(i,p.prev_index,p.next_index));
+}
+
+    void update_distance(std::size_t i) const
+    {
+      dists.erase(dist_t(points[i].distance,i));
+      set_distance(i);
+      dists.insert(dist_t(points[i].distance,i));
+}
+
+    void remove_point() const
+    {
+      const std::size_t i=dists.begin()->index;
+      dists.erase(dists.begin());
+      const std::size_t il=points[i].prev_index;
+      const std::size_t ir=points[i].next_index;
+      points[il].next_index=ir;
+      points[ir].prev_index=il;
+      if(il>0)
+        update_distance(il);
+      if((ir+1)<points.size())
+        update_distance(ir);
+}
+
+    mutable std::vector<point_t> points;
+    mutable std::set<dist_t> dists;
+  };
+
+  std::vector<double> make_contour(std::mt19937& gen,std::size_t n)
+  {
+    std::uniform_real_distribution<double> start_dist(std::log(80.0),std::log(300.0));
+    std::normal_distribution<double> step_dist(0,0.02);
+    std::bernoulli_distribution plateau_dist(0.2);
+    std::vector<double> res;
+    double v=start_dist(gen);
+    for(std::size_t i=0;i<n;++i)
+      {
+        res.push_back(v);
+        // Flat and straight stretches give equal distances, which
+        // test the order of the ties
+        if(!plateau_dist(gen))
+          v+=step_dist(gen);
+}
+    return res;
+  }
+
+  bool check(const pitch::stylizer& s,const reference_stylizer& r,const std::vector<double>& values)
+  {
+    const pitch::stylizer::result_t res=s.stylize(values.begin(),values.end());
+    const reference_stylizer::result_t ref=r.stylize(values);
+    if(res==ref)
+      return true;
+    std::cerr << "Stylized contours of " << values.size() << " frames differ" << std::endl;
+    return false;
+  }
+}
+
+int main()
+{
+  pitch::stylizer s(threshold);
+  reference_stylizer r;
+  std::mt19937 gen(12345);
+  std::size_t failures=0;
+  for(std::size_t n=0;n<64;++n)
+    {
+      if(!check(s,r,make_contour(gen,n)))
+        ++failures;
+}
+  std::uniform_int_distribution<std::size_t> length_dist(64,2000);
+  for(std::size_t k=0;k<500;++k)
+    {
+      if(!check(s,r,make_contour(gen,length_dist(gen))))
+        ++failures;
+}
+  std::vector<double> flat(300,std::log(120.0));
+  if(!check(s,r,flat))
+    ++failures;
+  std::vector<double> ramp;
+  for(std::size_t i=0;i<300;++i)
+    ramp.push_back(std::log(100.0)+0.001*i);
+  if(!check(s,r,ramp))
+    ++failures;
+  if(failures!=0)
+    {
+      std::cerr << failures << " contours differ" << std::endl;
+      return 1;
+}
+  return 0;
+}
@@ -0,0 +1,503 @@
+/* Copyright (C) 2026  RHVoice contributors */
+
+/* This program is free software: you can redistribute it and/or modify */
+/* it under the terms of the GNU General Public License as published by */
+/* the Free Software Foundation, either version 2 of the License, or */
+/* (at your option) any later version. */
+
+/* This program is distributed in the hope that it will be useful, */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+/* GNU General Public License for more details. */
+
+/* You should have received a copy of the GNU General Public License */
+/* along with this program.  If not, see <https://www.gnu.org/licenses/>. */
+
+// Installs zip archives served by a small http server on the loopback
+// interface: a complete download, downloads interrupted in the middle
+// and resumed from the saved offset by a server which supports ranges
+// and by one which ignores them, an archive with a wrong crc and one
+// with a path leading out of the target directory.
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include "core/package_installer.hpp"
+
+using namespace RHVoice;
+namespace fs=std::filesystem;
+
+namespace
+{
+  struct zip_entry
+  {
+    std::string name;
+    std::string data;
+    bool deflate;
+    // Sizes and crc after the data rather than in the local header
+    bool descriptor;
+    bool bad_crc;
+  };
+
+  void put_u16(std::string& out, std::uint16_t v)
+  {
+    out.push_back(static_cast<char>(v&0xff));
+    out.push_back(static_cast<char>(v>>8));
+  }
+
+  void put_u32(std::string& out, std::uint32_t v)
+  {
+    put_u16(out, static_cast<std::uint16_t>(v&0xffff));
+    put_u16(out, static_cast<std::uint16_t>(v>>16));
+  }
+
+  std::string deflate_raw(const std::string& data)
+  {
+    z_stream zs{};
+    if(deflateInit2(&zs, Z_BEST_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY)!=Z_OK)
+      throw std::runtime_error("Cannot initialize zlib");
+    std::string out(deflateBound(&zs, data.size()), '\0');
+    zs.next_in=reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    zs.avail_in=static_cast<uInt>(data.size());
+    zs.next_out=reinterpret_cast<Bytef*>(&out[0]);
+    zs.avail_out=static_cast<uInt>(out.size());
+    const int res=deflate(&zs, Z_FINISH);
+    deflateEnd(&zs);
+    if(res!=Z_STREAM_END)
+      throw std::runtime_error("Cannot compress");
+    out.resize(zs.total_out);
+    return out;
+  }
+
+  std::string make_zip(const std::vector<zip_entry>& entries)
+  {
+    std::string zip, dir;
+    for(const auto& e: entries)
+      {
+        const std::uint32_t offset=static_cast<std::uint32_t>(zip.size());
+        std::uint32_t crc=crc32(0, reinterpret_cast<const Bytef*>(e.data.data()), static_cast<uInt>(e.data.size()));
+        if(e.bad_crc)
+          crc^=1;
+        const std::string stored=e.deflate?deflate_raw(e.data):e.data;
+        const std::uint16_t flags=e.descriptor?8:0;
+        const std::uint16_t method=e.deflate?8:0;
+        const std::uint32_t csize=static_cast<std::uint32_t>(stored.size());
+        const std::uint32_t usize=static_cast<std::uint32_t>(e.data.size());
+        put_u32(zip, 0x04034b50);
+        put_u16(zip, 20);
+        put_u16(zip, flags);
+        put_u16(zip, method);
+        put_u32(zip, 0);
+        put_u32(zip, e.descriptor?0:crc);
+        put_u32(zip, e.descriptor?0:csize);
+        put_u32(zip, e.descriptor?0:usize);
+        put_u16(zip, static_cast<std::uint16_t>(e.name.size()));
+        put_u16(zip, 0);
+        zip+=e.name;
+        zip+=stored;
+        if(e.descriptor)
+          {
+            put_u32(zip, 0x08074b50);
+            put_u32(zip, crc);
+            put_u32(zip, csize);
+            put_u32(zip, usize);
+          }
+        put_u32(dir, 0x02014b50);
+        put_u16(dir, 20);
+        put_u16(dir, 20);
+        put_u16(dir, flags);
+        put_u16(dir, method);
+        put_u32(dir, 0);
+        put_u32(dir, crc);
+        put_u32(dir, csize);
+        put_u32(dir, usize);
+        put_u16(dir, static_cast<std::uint16_t>(e.name.size()));
+        put_u16(dir, 0);
+        put_u16(dir, 0);
+        put_u16(dir, 0);
+        put_u16(dir, 0);
+        put_u32(dir, 0);
+        put_u32(dir, offset);
+        dir+=e.name;
+      }
+    const std::uint32_t dir_offset=static_cast<std::uint32_t>(zip.size());
+    zip+=dir;
+    put_u32(zip, 0x06054b50);
+    put_u16(zip, 0);
+    put_u16(zip, 0);
+    put_u16(zip, static_cast<std::uint16_t>(entries.size()));
+    put_u16(zip, static_cast<std::uint16_t>(entries.size()));
+    put_u32(zip, static_cast<std::uint32_t>(dir.size()));
+    put_u32(zip, dir_offset);
+    put_u16(zip, 0);
+    return zip;
+  }
+
+  std::string make_data(std::size_t size, unsigned int seed)
+  {
+    std::string s;
+    s.reserve(size);
+    std::uint32_t x=seed;
+    for(std::size_t i=0; i<size; ++i)
+      {
+        x=x*1664525u+1013904223u;
+        s.push_back(static_cast<char>(x>>24));
+      }
+    return s;
+  }
+
+  std::string make_text(std::size_t size)
+  {
+    std::string s;
+    for(std::size_t i=0; s.size()<size; ++i)
+      s+="line "+std::to_string(i)+" of a voice file\n";
+    s.resize(size);
+    return s;
+  }
+
+  // Serves one archive over http/1.0, one connection at a time
+  class http_server
+  {
+  public:
+    explicit http_server(const std::string& body_):
+      body(body_)
+    {
+      sock=socket(AF_INET, SOCK_STREAM, 0);
+      if(sock<0)
+        throw std::runtime_error("Cannot create socket");
+      sockaddr_in addr{};
+      addr.sin_family=AF_INET;
+      addr.sin_addr.s_addr=htonl(INADDR_LOOPBACK);
+      addr.sin_port=0;
+      socklen_t len=sizeof(addr);
+      if(bind(sock, reinterpret_cast<sockaddr*>(&addr), len)!=0 ||
+         listen(sock, 8)!=0 ||
+         getsockname(sock, reinterpret_cast<sockaddr*>(&addr), &len)!=0)
+        {
+          close(sock);
+          throw std::runtime_error("Cannot listen on the loopback interface");
+        }
+      port=ntohs(addr.sin_port);
+      thread=std::thread(&http_server::serve, this);
+    }
+
+    ~http_server()
+    {
+      shutdown(sock, SHUT_RDWR);
+      close(sock);
+      thread.join();
+    }
+
+    std::string get_url() const
+    {
+      return "http://127.0.0.1:"+std::to_string(port)+"/voice.zip";
+    }
+
+    void set_ranges(bool r)
+    {
+      ranges=r;
+    }
+
+    // Drops the connection after this many bytes of the body, 0
+    // means never
+    void set_cut(std::size_t n)
+    {
+      cut=n;
+    }
+
+    // The first byte asked for by the last request, 0 without a range
+    std::size_t get_last_range_start() const
+    {
+      return last_range_start;
+    }
+
+    // The size of the body the last response was meant to have
+    std::size_t get_body_size() const
+    {
+      return body_size;
+    }
+
+  private:
+    http_server(const http_server&);
+    http_server& operator=(const http_server&);
+
+    void serve()
+    {
+      while(true)
+        {
+          const int conn=accept(sock, nullptr, nullptr);
+          if(conn<0)
+            return;
+          respond(conn);
+          close(conn);
+        }
+    }
+
+    void respond(int conn)
+    {
+      std::string request;
+      char buf[1024];
+      while(request.find("\r\n\r\n")==std::string::npos)
+        {
+          const auto n=recv(conn, buf, sizeof(buf), 0);
+          if(n<=0)
+            return;
+          request.append(buf, n);
+        }
+      std::size_t start=0;
+      const auto pos=request.find("Range: bytes=");
+      if(pos!=std::string::npos)
+        start=std::strtoul(request.c_str()+pos+13, nullptr, 10);
+      last_range_start=start;
+      std::ostringstream head;
+      if(ranges && start>0)
+        {
+          head << "HTTP/1.0 206 Partial Content\r\n";
+          head << "Content-Range: bytes " << start << "-" << (body.size()-1) << "/" << body.size() << "\r\n";
+        }
+      else
+        {
+          head << "HTTP/1.0 200 OK\r\n";
+          start=0;
+        }
+      head << "Content-Type: application/zip\r\n";
+      head << "Content-Length: " << (body.size()-start) << "\r\n\r\n";
+      std::size_t end=body.size();
+      if(cut>0)
+        end=std::min(end, start+cut);
+      body_size=body.size()-start;
+      send_all(conn, head.str()+body.substr(start, end-start));
+    }
+
+    void send_all(int conn, const std::string& out)
+    {
+      for(std::size_t done=0; done<out.size(); )
+        {
+          const auto n=send(conn, out.data()+done, out.size()-done, MSG_NOSIGNAL);
+          if(n<=0)
+            return;
+          done+=n;
+        }
+    }
+
+    const std::string body;
+    int sock{-1};
+    unsigned short port{0};
+    std::thread thread;
+    std::atomic<bool> ranges{true};
+    std::atomic<std::size_t> cut{0};
+    std::atomic<std::size_t> last_range_start{0};
+    std::atomic<std::size_t> body_size{0};
+  };
+
+  class temp_dir
+  {
+  public:
+    temp_dir()
+    {
+      std::string t=(fs::temp_directory_path()/"rhvoice-pkg-test-XXXXXX").string();
+      if(mkdtemp(&t[0])==nullptr)
+        throw std::runtime_error("Cannot create a temporary directory");
+      p=t;
+    }
+
+    ~temp_dir()
+    {
+      std::error_code ec;
+      fs::remove_all(p, ec);
+    }
+
+    const fs::path& get() const
+    {
+      return p;
+    }
+
+  private:
+    temp_dir(const temp_dir&);
+    temp_dir& operator=(const temp_dir&);
+
+    fs::path p;
+  };
+
+  std::string read_file(const fs::path& p)
+  {
+    std::ifstream f(p, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+  }
+
+  std::size_t failures=0;
+
+  void expect(bool cond, const std::string& what)
+  {
+    if(cond)
+      return;
+    std::cerr << "FAILED: " << what << std::endl;
+    ++failures;
+  }
+
+  // Returns the error, or an empty string if the installation succeeded
+  std::string install(const std::string& url, const fs::path& target, std::size_t* installed=nullptr)
+  {
+    pkg::package_installer inst(target.parent_path().string());
+    inst.add(url, target.string());
+    if(installed!=nullptr)
+      inst.set_installed_callback([installed] (std::size_t, const std::string&) {++*installed;});
+    try
+      {
+        inst.run();
+        return std::string();
+      }
+    catch(const std::exception& e)
+      {
+        return e.what();
+      }
+  }
+
+  const std::vector<zip_entry> voice_entries{
+    {"voice/", "", false, false, false},
+    {"voice/voice.info", make_text(300), false, false, false},
+    {"voice/24000/voice.data", make_data(40000, 1), false, false, false},
+    {"voice/24000/tree.inf", make_text(60000), true, false, false},
+    {"voice/24000/dur.pdf", make_text(50000), true, true, false},
+    {"voice/24000/lf0.pdf", make_data(30000, 2), false, false, false}};
+
+  void check_files(const fs::path& target, const std::string& what)
+  {
+    for(const auto& e: voice_entries)
+      {
+        if(e.name.back()=='/')
+          continue;
+        expect(read_file(target/e.name)==e.data, what+": "+e.name);
+      }
+    expect(!fs::exists(target/".download"), what+": the state file is removed");
+  }
+
+  void test_full_install()
+  {
+    temp_dir tmp;
+    http_server server(make_zip(voice_entries));
+    const auto target=tmp.get()/"full";
+    std::size_t installed=0;
+    const auto error=install(server.get_url(), target, &installed);
+    expect(error.empty(), "full install: "+error);
+    expect(installed==1, "full install: the installed callback is called once");
+    check_files(target, "full install");
+  }
+
+  void test_resume(bool ranges)
+  {
+    const std::string what=ranges?"resume with ranges":"resume without ranges";
+    temp_dir tmp;
+    const auto zip=make_zip(voice_entries);
+    http_server server(zip);
+    server.set_ranges(ranges);
+    const auto target=tmp.get()/"resumed";
+    server.set_cut(zip.size()/2);
+    expect(!install(server.get_url(), target).empty(), what+": the interrupted download fails");
+    std::ifstream state(target/".download");
+    std::string url;
+    std::size_t offset=0;
+    expect(std::getline(state, url) && (state >> offset), what+": the state is saved");
+    expect(url==server.get_url(), what+": the url is saved");
+    expect(offset>0 && offset<zip.size()/2, what+": the offset is that of an entry");
+    server.set_cut(0);
+    const auto error=install(server.get_url(), target);
+    expect(error.empty(), what+": "+error);
+    expect(server.get_last_range_start()==offset, what+": the download continues from the saved offset");
+    expect(server.get_body_size()==(ranges?(zip.size()-offset):zip.size()), what+": the size of the response");
+    check_files(target, what);
+  }
+
+  void test_bad_crc()
+  {
+    temp_dir tmp;
+    std::vector<zip_entry> entries(voice_entries);
+    entries[3].bad_crc=true;
+    http_server server(make_zip(entries));
+    const auto error=install(server.get_url(), tmp.get()/"crc");
+    expect(error.find("Checksum mismatch")!=std::string::npos, "crc mismatch: "+error);
+  }
+
+  void test_unsafe_path()
+  {
+    temp_dir tmp;
+    std::vector<zip_entry> entries{
+      {"voice/voice.info", make_text(100), false, false, false},
+      {"voice/../../escaped", make_text(100), false, false, false}};
+    http_server server(make_zip(entries));
+    const auto error=install(server.get_url(), tmp.get()/"unsafe");
+    expect(error.find("Invalid path")!=std::string::npos, "unsafe path: "+error);
+    expect(!fs::exists(tmp.get()/"escaped"), "unsafe path: nothing is written outside the target");
+  }
+
+  void test_run_after_cancel()
+  {
+    temp_dir tmp;
+    http_server server(make_zip(voice_entries));
+    const auto target=tmp.get()/"cancel";
+    pkg::package_installer inst(tmp.get().string());
+    inst.set_progress_callback([] (std::size_t, double, double) {return false;});
+    inst.add(server.get_url(), target.string());
+    bool cancelled=false;
+    try
+      {
+        inst.run();
+      }
+    catch(const std::exception&)
+      {
+        cancelled=true;
+      }
+    expect(cancelled, "cancel: the first run is cancelled");
+    inst.set_progress_callback(pkg::package_installer::progress_callback_t());
+    inst.add(server.get_url(), target.string());
+    try
+      {
+        inst.run();
+      }
+    catch(const std::exception& e)
+      {
+        expect(false, std::string("cancel: the next run: ")+e.what());
+      }
+    check_files(target, "cancel");
+  }
+}
+
+int main()
+{
+  try
+    {
+      test_full_install();
+      test_resume(true);
+      test_resume(false);
+      test_bad_crc();
+      test_unsafe_path();
+      test_run_after_cancel();
+    }
+  catch(const std::exception& e)
+    {
+      std::cerr << e.what() << std::endl;
+      return 1;
+    }
+  if(failures!=0)
+    {
+      std::cerr << failures << " checks failed" << std::endl;
+      return 1;
+    }
+  return 0;
+}
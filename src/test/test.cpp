@@ -19,6 +19,10 @@
 #include <fstream>
 #include <iterator>
 #include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdio>
 
 #ifdef WITH_CLI11
 	#include <CLI/CLI.hpp>
@@ -28,6 +32,7 @@
 
 #include "core/engine.hpp"
 #include "core/document.hpp"
+#include "core/batch_synthesizer.hpp"
 #include "core/client.hpp"
 #include "audio.hpp"
 
@@ -41,6 +46,7 @@ namespace
     explicit audio_player(const std::string& path);
     bool play_speech(const short* samples,std::size_t count);
     void finish();
+    void close();
     bool set_sample_rate(int sample_rate);
     bool set_buffer_size(unsigned int buffer_size);
 
@@ -108,6 +114,46 @@ namespace
     if(stream.is_open())
       stream.drain();
   }
+
+  void audio_player::close()
+  {
+    if(stream.is_open())
+      stream.close();
+  }
+
+  // Each message of a batch goes to its own file, which is closed as
+  // soon as the message has been written
+  class batch_item_player: public audio_player
+  {
+  public:
+    explicit batch_item_player(const std::string& path):
+      audio_player(path)
+    {
+    }
+
+    event_mask get_supported_events() const
+    {
+      return event_done;
+    }
+
+    void done()
+    {
+      finish();
+      close();
+    }
+  };
+
+  // out.wav -> out-0001.wav
+  std::string get_batch_item_path(const std::string& path,std::size_t number)
+  {
+    char suffix[16];
+    std::snprintf(suffix,sizeof(suffix),"-%04u",static_cast<unsigned int>(number));
+    std::string::size_type dot_pos=path.rfind('.');
+    std::string::size_type sep_pos=path.find_last_of("/\\");
+    if((dot_pos==std::string::npos)||((sep_pos!=std::string::npos)&&(dot_pos<sep_pos)))
+      return (path+suffix);
+    return (path.substr(0,dot_pos)+suffix+path.substr(dot_pos));
+  }
 }
 
 #ifdef WITH_CLI11
@@ -147,6 +193,12 @@ int main(int argc,const char* argv[])
       auto quality_arg = cmd.add_option("-q,--quality",quality_argStor,"quality");
       unsigned int view_argStor = 0;
       auto view_arg =  cmd.add_option("-w,--view", view_argStor,"stream view size");
+      bool incremental_switchStor = false;
+      auto incremental_switch = cmd.add_flag("-n,--incremental",incremental_switchStor,"Start speaking before the whole input has been read");
+      unsigned int jobs_argStor = 1;
+      auto jobs_arg = cmd.add_option("-j,--jobs",jobs_argStor,"number of synthesis threads, 0 means one per core");
+      bool batch_switchStor = false;
+      auto batch_switch = cmd.add_flag("-b,--batch",batch_switchStor,"Treat each input line as a separate message and write it to a numbered output file");
       cmd.allow_windows_style_options();
 #else
       TCLAP::ValueArg<std::string> inpath_arg("i","input","input file",false,"-","path",cmd);
@@ -159,6 +211,9 @@ int main(int argc,const char* argv[])
       TCLAP::ValueArg<unsigned int> volume_arg("v","volume","speech volume",false,100,"percent",cmd);
       TCLAP::ValueArg<std::string> quality_arg("q","quality","quality",false,"","quality",cmd);
       TCLAP::ValueArg<unsigned int> view_arg("w","view","stream view size",false,0,"positive",cmd);
+      TCLAP::SwitchArg incremental_switch("n","incremental","Start speaking before the whole input has been read",cmd,false);
+      TCLAP::ValueArg<unsigned int> jobs_arg("j","jobs","number of synthesis threads, 0 means one per core",false,1,"number",cmd);
+      TCLAP::SwitchArg batch_switch("b","batch","Treat each input line as a separate message and write it to a numbered output file",cmd,false);
 #endif
 
 #ifdef WITH_CLI11
@@ -178,9 +233,6 @@ int main(int argc,const char* argv[])
           if(!f_in.is_open())
             throw std::runtime_error("Cannot open the input file");
         }
-      audio_player player(GET_CLI_PARAM_VALUE(outpath_arg));
-      player.set_sample_rate(GET_CLI_PARAM_VALUE(sample_rate));
-      player.set_buffer_size(20);
       std::shared_ptr<engine> eng(new engine);
       auto q=GET_CLI_PARAM_VALUE(quality_arg);
       if(!q.empty())
@@ -192,18 +244,93 @@ int main(int argc,const char* argv[])
       voice_profile profile;
       if(!GET_CLI_PARAM_VALUE(voice_arg).empty())
         profile=eng->create_voice_profile(GET_CLI_PARAM_VALUE(voice_arg));
-      std::istreambuf_iterator<char> text_start(f_in.is_open()?f_in:std::cin);
-      std::istreambuf_iterator<char> text_end;
+      auto setup_document=[&](document& d,audio_player& p)
+      {
+        p.set_sample_rate(GET_CLI_PARAM_VALUE(sample_rate));
+        p.set_buffer_size(20);
+        d.speech_settings.relative.rate=GET_CLI_PARAM_VALUE(rate_arg)/100.0;
+        d.speech_settings.relative.pitch=GET_CLI_PARAM_VALUE(pitch_arg)/100.0;
+        d.speech_settings.relative.volume=GET_CLI_PARAM_VALUE(volume_arg)/100.0;
+        d.set_owner(p);
+      };
+      unsigned int jobs=GET_CLI_PARAM_VALUE(jobs_arg);
+      if(GET_CLI_PARAM_VALUE(batch_switch))
+        {
+          if(GET_CLI_PARAM_VALUE(outpath_arg).empty())
+            throw std::runtime_error("The batch mode requires an output file");
+          std::istream& batch_in=f_in.is_open()?f_in:std::cin;
+          std::vector<std::unique_ptr<batch_item_player>> players;
+          std::vector<std::unique_ptr<document>> docs;
+          batch_synthesizer synth(jobs);
+          std::string line;
+          while(std::getline(batch_in,line))
+            {
+              if(line.find_first_not_of(" \t\r")==std::string::npos)
+                continue;
+              players.emplace_back(new batch_item_player(get_batch_item_path(GET_CLI_PARAM_VALUE(outpath_arg),players.size()+1)));
+              if(GET_CLI_PARAM_VALUE(ssml_switch))
+                docs.push_back(document::create_from_ssml(eng,line.begin(),line.end(),profile));
+              else
+                docs.push_back(document::create_from_plain_text(eng,line.begin(),line.end(),content_text,profile));
+              setup_document(*docs.back(),*players.back());
+              synth.add(*docs.back());
+            }
+          synth.run();
+          return 0;
+        }
+      audio_player player(GET_CLI_PARAM_VALUE(outpath_arg));
+      std::istream& f_in_ref=f_in.is_open()?f_in:std::cin;
       std::unique_ptr<document> doc;
-      if(GET_CLI_PARAM_VALUE(ssml_switch))
-        doc=document::create_from_ssml(eng,text_start,text_end,profile);
+      bool incremental=GET_CLI_PARAM_VALUE(incremental_switch)&&!GET_CLI_PARAM_VALUE(ssml_switch);
+      if(incremental)
+        doc=document::create_incremental(eng,content_text,profile);
+      else
+        {
+          std::istreambuf_iterator<char> text_start(f_in_ref);
+          std::istreambuf_iterator<char> text_end;
+          if(GET_CLI_PARAM_VALUE(ssml_switch))
+            doc=document::create_from_ssml(eng,text_start,text_end,profile);
+          else
+            doc=document::create_from_plain_text(eng,text_start,text_end,content_text,profile);
+        }
+      setup_document(*doc,player);
+      if(incremental)
+        {
+          std::thread reader([&doc,&f_in_ref]()
+          {
+            try
+              {
+                std::string line;
+                while(std::getline(f_in_ref,line))
+                  {
+                    line.push_back('\n');
+                    doc->append_text(line.data(),line.size());
+                  }
+              }
+            catch(const std::exception& e)
+              {
+                std::cerr << e.what() << std::endl;
+              }
+            try
+              {
+                doc->finish_input();
+              }
+            catch(const std::exception& e)
+              {
+                std::cerr << e.what() << std::endl;
+              }
+          });
+          doc->synthesize();
+          reader.join();
+        }
+      else if(jobs!=1)
+        {
+          batch_synthesizer synth(jobs);
+          synth.add(*doc);
+          synth.run();
+        }
       else
-        doc=document::create_from_plain_text(eng,text_start,text_end,content_text,profile);
-      doc->speech_settings.relative.rate=GET_CLI_PARAM_VALUE(rate_arg)/100.0;
-      doc->speech_settings.relative.pitch=GET_CLI_PARAM_VALUE(pitch_arg)/100.0;
-      doc->speech_settings.relative.volume=GET_CLI_PARAM_VALUE(volume_arg)/100.0;
-      doc->set_owner(player);
-      doc->synthesize();
+        doc->synthesize();
       player.finish();
       return 0;
     }
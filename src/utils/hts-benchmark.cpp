@@ -0,0 +1,316 @@
+/* Copyright (C) 2026  RHVoice contributors */
+
+/* This program is free software: you can redistribute it and/or modify */
+/* it under the terms of the GNU General Public License as published by */
+/* the Free Software Foundation, either version 2 of the License, or */
+/* (at your option) any later version. */
+
+/* This program is distributed in the hope that it will be useful, */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+/* GNU General Public License for more details. */
+
+/* You should have received a copy of the GNU General Public License */
+/* along with this program.  If not, see <https://www.gnu.org/licenses/>. */
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <thread>
+
+#ifdef WITH_CLI11
+	#include <CLI/CLI.hpp>
+#else
+	#include "tclap/CmdLine.h"
+#endif
+#include "core/path.hpp"
+#include "core/params.hpp"
+#include "core/cancellation.hpp"
+#include "core/worker_pool.hpp"
+#include "HTS_engine.h"
+
+using namespace RHVoice;
+
+namespace
+{
+  struct gv_mode
+  {
+    std::string name;
+    unsigned int iterations;
+    double tolerance;
+    bool parallel;
+  };
+
+  // The generated parameters of one utterance: stream, frame, dimension
+  typedef std::vector<std::vector<std::vector<double> > > parameters;
+
+  class hts_voice
+  {
+  public:
+    explicit hts_voice(const std::string& voice_path):
+      file_size(0)
+    {
+      HTS_Engine_initialize(&engine);
+      std::ifstream f(voice_path.c_str(),std::ios::binary|std::ios::ate);
+      if(f.is_open())
+        file_size=f.tellg();
+      char* c_voice_path=const_cast<char*>(voice_path.c_str());
+      if(!HTS_Engine_load(&engine,&c_voice_path,1))
+        {
+          HTS_Engine_clear(&engine);
+          throw std::runtime_error("Cannot load "+voice_path);
+        }
+    }
+
+    ~hts_voice()
+    {
+      HTS_Engine_clear(&engine);
+    }
+
+    // Returns the time spent on the parameter generation in seconds
+    double generate(const std::string& lab_path,const gv_mode& mode,parameters& result)
+    {
+      if(!HTS_Engine_generate_state_sequence_from_fn(&engine,lab_path.c_str()))
+        throw std::runtime_error("Cannot process "+lab_path);
+      HTS_Engine_set_gv_iteration(&engine,mode.iterations,mode.tolerance);
+      RHVoice_worker_pool_t pool={0};
+      if(mode.parallel)
+        pool=worker_pool::get_shared().get_c_pool();
+      HTS_Engine_set_worker_pool(&engine,pool);
+      std::chrono::steady_clock::time_point start=std::chrono::steady_clock::now();
+      if(!HTS_Engine_generate_parameter_sequence(&engine))
+        throw std::runtime_error("Parameter generation failed for "+lab_path);
+      std::chrono::duration<double> elapsed=std::chrono::steady_clock::now()-start;
+      result.assign(engine.pss.nstream,std::vector<std::vector<double> >());
+      for(std::size_t i=0;i<engine.pss.nstream;++i)
+        {
+          const HTS_PStream& pst=engine.pss.pstream[i];
+          for(std::size_t t=0;t<pst.length;++t)
+            result[i].push_back(std::vector<double>(pst.par[t],pst.par[t]+pst.vector_length));
+        }
+      HTS_Engine_refresh(&engine);
+      return elapsed.count();
+    }
+
+    // Cancels the parameter generation from another thread after
+    // the given delay. Returns the time from the cancellation to the
+    // return of the engine in seconds, or a negative number if the
+    // generation finished first. Only this stage is measured: the
+    // benchmark drives the HTS engine directly from the labels, so the
+    // text analysis, the vocoder and the delivery of the samples to
+    // the client, which are checked for the cancellation as well, are
+    // not part of the figure.
+    double measure_stop_latency(const std::string& lab_path,const gv_mode& mode,double delay)
+    {
+      if(!HTS_Engine_generate_state_sequence_from_fn(&engine,lab_path.c_str()))
+        throw std::runtime_error("Cannot process "+lab_path);
+      HTS_Engine_set_gv_iteration(&engine,mode.iterations,mode.tolerance);
+      cancellation_token token;
+      HTS_Engine_set_cancellation_token(&engine,token.get_c_token());
+      std::chrono::steady_clock::time_point cancel_time;
+      std::thread canceller([&token,&cancel_time,delay]{
+          std::this_thread::sleep_for(std::chrono::duration<double>(delay));
+          cancel_time=std::chrono::steady_clock::now();
+          token.cancel();});
+      bool finished=HTS_Engine_generate_parameter_sequence(&engine);
+      std::chrono::steady_clock::time_point end_time=std::chrono::steady_clock::now();
+      canceller.join();
+      RHVoice_cancellation_token_t no_token={0};
+      HTS_Engine_set_cancellation_token(&engine,no_token);
+      HTS_Engine_refresh(&engine);
+      if(finished||(end_time<cancel_time))
+        return -1;
+      return std::chrono::duration<double>(end_time-cancel_time).count();
+    }
+
+    std::size_t get_file_size() const
+    {
+      return file_size;
+    }
+
+  private:
+    hts_voice(const hts_voice&);
+    hts_voice& operator=(const hts_voice&);
+
+    HTS_Engine engine;
+    std::size_t file_size;
+  };
+
+  // Mel-cepstral distortion of the first stream, without the energy term
+  double mcd(const parameters& ref,const parameters& test,std::size_t& frames)
+  {
+    const double k=10.0/std::log(10.0)*std::sqrt(2.0);
+    double sum=0;
+    for(std::size_t t=0;t<ref[0].size();++t)
+      {
+        double d=0;
+        for(std::size_t i=1;i<ref[0][t].size();++i)
+          d+=(ref[0][t][i]-test[0][t][i])*(ref[0][t][i]-test[0][t][i]);
+        sum+=k*std::sqrt(d);
+      }
+    frames+=ref[0].size();
+    return sum;
+  }
+
+  // Squared log F0 differences in cents, over the voiced frames
+  double f0_squared_error(const parameters& ref,const parameters& test,std::size_t& frames)
+  {
+    if(ref.size()<2)
+      return 0;
+    const double k=1200.0/std::log(2.0);
+    // A different voicing decision would shift the frames
+    const std::size_t count=std::min(ref[1].size(),test[1].size());
+    double sum=0;
+    for(std::size_t t=0;t<count;++t)
+      {
+        double d=k*(ref[1][t][0]-test[1][t][0]);
+        sum+=d*d;
+      }
+    frames+=count;
+    return sum;
+  }
+}
+
+#ifdef WITH_CLI11
+	typedef CLI::App AppT;
+	#define GET_CLI_PARAM_VALUE(NAME) (NAME ## Stor)
+#else
+	typedef TCLAP::CmdLine AppT;
+	#define GET_CLI_PARAM_VALUE(NAME) (NAME).getValue()
+#endif
+
+int main(int argc,const char* argv[])
+{
+  try
+    {
+      AppT cmd("Measure the speed and accuracy of the parameter generation modes of an HTS voice");
+
+#ifdef WITH_CLI11
+      std::string model_argStor;
+      cmd.add_option("model",model_argStor,"the directory containing voice.data")->required();
+      std::vector<std::string> labels_argStor;
+      cmd.add_option("labels",labels_argStor,"full-context label files")->required();
+      unsigned int repeat_argStor {5};
+      cmd.add_option("-r,--repeat",repeat_argStor,"how many times to process each file");
+      std::string compare_argStor;
+      cmd.add_option("-c,--compare",compare_argStor,"a voice file, such as a packed copy of the voice, to compare with the original one");
+      bool stop_latency_argStor {false};
+      cmd.add_flag("-s,--stop-latency",stop_latency_argStor,"also measure how long the parameter generation takes to stop after a cancellation");
+#else
+      TCLAP::UnlabeledValueArg<std::string> model_arg("model","the directory containing voice.data",true,"","path",cmd);
+      TCLAP::UnlabeledMultiArg<std::string> labels_arg("labels","full-context label files",true,"path",cmd);
+      TCLAP::ValueArg<unsigned int> repeat_arg("r","repeat","how many times to process each file",false,5,"number",cmd);
+      TCLAP::ValueArg<std::string> compare_arg("c","compare","a voice file, such as a packed copy of the voice, to compare with the original one",false,"","path",cmd);
+      TCLAP::SwitchArg stop_latency_arg("s","stop-latency","also measure how long the parameter generation takes to stop after a cancellation",cmd);
+#endif
+
+#ifdef WITH_CLI11
+     try{
+#endif
+      cmd.parse(argc,argv);
+#ifdef WITH_CLI11
+      }catch (const CLI::ParseError &e) {
+        return cmd.exit(e);
+      }
+#endif
+
+      // The modes the engine uses for each quality, with their default
+      // settings, plus plain variance scaling for comparison. The first
+      // one is the reference.
+      stream_params defaults;
+      std::vector<gv_mode> modes;
+      modes.push_back({"max",defaults.gv_iterations_max,0,false});
+      modes.push_back({"std",defaults.gv_iterations_std,defaults.gv_tolerance_std,false});
+      modes.push_back({"min",defaults.gv_iterations_min,defaults.gv_tolerance_min,false});
+      modes.push_back({"scaling only",0,0,false});
+      // Must give exactly the same parameters as the reference
+      modes.push_back({"max, parallel",defaults.gv_iterations_max,0,true});
+      const std::vector<std::string>& lab_paths=GET_CLI_PARAM_VALUE(labels_arg);
+      const unsigned int repeat=std::max(1u,static_cast<unsigned int>(GET_CLI_PARAM_VALUE(repeat_arg)));
+      hts_voice voice(path::join(GET_CLI_PARAM_VALUE(model_arg),"voice.data"));
+      std::vector<parameters> ref(lab_paths.size());
+      std::vector<double> ref_times(lab_paths.size(),0);
+      parameters test;
+      double ref_time=0;
+      std::cout << std::left << std::setw(14) << "mode" << std::right << std::setw(11) << "iterations" << std::setw(11) << "tolerance" << std::setw(12) << "ms/utt" << std::setw(10) << "speed-up" << std::setw(10) << "MCD, dB" << std::setw(14) << "F0 RMSE, ct" << std::endl;
+      for(std::size_t m=0;m<modes.size();++m)
+        {
+          double time=0,mcd_sum=0,f0_sum=0;
+          std::size_t mcd_frames=0,f0_frames=0;
+          for(std::size_t i=0;i<lab_paths.size();++i)
+            {
+              double file_time=0;
+              for(unsigned int r=0;r<repeat;++r)
+                file_time+=voice.generate(lab_paths[i],modes[m],(m==0)?ref[i]:test);
+              time+=file_time;
+              if(m==0)
+                {
+                  ref_times[i]=file_time/repeat;
+                  continue;
+                }
+              mcd_sum+=mcd(ref[i],test,mcd_frames);
+              f0_sum+=f0_squared_error(ref[i],test,f0_frames);
+            }
+          time/=(repeat*lab_paths.size());
+          if(m==0)
+            ref_time=time;
+          std::cout << std::left << std::setw(14) << modes[m].name << std::right << std::setw(11) << modes[m].iterations << std::setw(11) << modes[m].tolerance << std::fixed << std::setprecision(3) << std::setw(12) << (time*1000) << std::setw(10) << std::setprecision(2) << ((time>0)?(ref_time/time):0) << std::setw(10) << std::setprecision(4) << ((mcd_frames>0)?(mcd_sum/mcd_frames):0) << std::setw(14) << std::setprecision(2) << ((f0_frames>0)?std::sqrt(f0_sum/f0_frames):0) << std::defaultfloat << std::endl;
+        }
+      const std::string& other_path=GET_CLI_PARAM_VALUE(compare_arg);
+      if(!other_path.empty())
+        {
+          // The same labels and the reference mode, only the models differ
+          hts_voice other_voice(other_path);
+          double time=0,mcd_sum=0,f0_sum=0;
+          std::size_t mcd_frames=0,f0_frames=0;
+          for(std::size_t i=0;i<lab_paths.size();++i)
+            {
+              for(unsigned int r=0;r<repeat;++r)
+                time+=other_voice.generate(lab_paths[i],modes[0],test);
+              mcd_sum+=mcd(ref[i],test,mcd_frames);
+              f0_sum+=f0_squared_error(ref[i],test,f0_frames);
+            }
+          time/=(repeat*lab_paths.size());
+          std::cout << std::endl << std::left << std::setw(14) << "voice" << std::right << std::setw(12) << "size, KB" << std::setw(12) << "ms/utt" << std::setw(10) << "MCD, dB" << std::setw(14) << "F0 RMSE, ct" << std::endl;
+          std::cout << std::left << std::setw(14) << "original" << std::right << std::setw(12) << (voice.get_file_size()/1024) << std::fixed << std::setprecision(3) << std::setw(12) << (ref_time*1000) << std::setw(10) << std::setprecision(4) << 0.0 << std::setw(14) << std::setprecision(2) << 0.0 << std::defaultfloat << std::endl;
+          std::cout << std::left << std::setw(14) << "compared" << std::right << std::setw(12) << (other_voice.get_file_size()/1024) << std::fixed << std::setprecision(3) << std::setw(12) << (time*1000) << std::setw(10) << std::setprecision(4) << ((mcd_frames>0)?(mcd_sum/mcd_frames):0) << std::setw(14) << std::setprecision(2) << ((f0_frames>0)?std::sqrt(f0_sum/f0_frames):0) << std::defaultfloat << std::endl;
+        }
+      if(GET_CLI_PARAM_VALUE(stop_latency_arg))
+        {
+          // Cancel at several points of the generation in the
+          // reference mode, which runs the longest
+          const double fractions[]={0.1,0.3,0.5,0.7,0.9};
+          double sum=0,max_latency=0;
+          std::size_t count=0;
+          for(std::size_t i=0;i<lab_paths.size();++i)
+            {
+              for(std::size_t j=0;j<sizeof(fractions)/sizeof(fractions[0]);++j)
+                {
+                  for(unsigned int r=0;r<repeat;++r)
+                    {
+                      double latency=voice.measure_stop_latency(lab_paths[i],modes[0],fractions[j]*ref_times[i]);
+                      if(latency<0)
+                        continue;
+                      sum+=latency;
+                      max_latency=std::max(max_latency,latency);
+                      ++count;
+                    }
+                }
+            }
+          std::cout << std::endl << std::left << std::setw(14) << "mlpg stop" << std::right << std::setw(12) << "cancels" << std::setw(12) << "mean, ms" << std::setw(12) << "max, ms" << std::endl;
+          std::cout << std::left << std::setw(14) << modes[0].name << std::right << std::setw(12) << count << std::fixed << std::setprecision(3) << std::setw(12) << ((count>0)?(sum/count*1000):0) << std::setw(12) << (max_latency*1000) << std::defaultfloat << std::endl;
+        }
+      return 0;
+    }
+  catch(const std::exception& e)
+    {
+      std::cerr << e.what() << std::endl;
+      return -1;
+    }
+}
@@ -132,6 +132,7 @@ namespace
           throw std::runtime_error("Label mismatch: expected "+name+", found "+phone);
       }
     rephrase(utt);
+    utt.get_language().precompute_positional_features(utt);
   }
 }
 
@@ -0,0 +1,438 @@
+/* Copyright (C) 2026  RHVoice contributors */
+
+/* This program is free software: you can redistribute it and/or modify */
+/* it under the terms of the GNU General Public License as published by */
+/* the Free Software Foundation, either version 2 of the License, or */
+/* (at your option) any later version. */
+
+/* This program is distributed in the hope that it will be useful, */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+/* GNU General Public License for more details. */
+
+/* You should have received a copy of the GNU General Public License */
+/* along with this program.  If not, see <https://www.gnu.org/licenses/>. */
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iterator>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+
+#ifdef WITH_CLI11
+	#include <CLI/CLI.hpp>
+#else
+	#include "tclap/CmdLine.h"
+#endif
+#include "core/path.hpp"
+
+using namespace RHVoice;
+
+namespace
+{
+  // Converts the float PDFs of the chosen streams of an HTS voice
+  // into one of the packed formats understood by HTS_Model_load_pdf.
+  // Everything else in the file is copied as is.
+
+  const std::size_t codebook_size=256;
+
+  std::uint16_t float_to_half(float f)
+  {
+    std::uint32_t x;
+    std::memcpy(&x,&f,sizeof(x));
+    std::uint16_t sign=(x>>16)&0x8000;
+    x&=0x7fffffff;
+    if(x>=0x47800000)
+      return sign|((x>0x7f800000)?0x7e00:0x7c00);
+    if(x<0x38800000)
+      {
+        std::memcpy(&f,&x,sizeof(f));
+        return sign|static_cast<std::uint16_t>(std::lrint(f*16777216.0f));
+      }
+    x-=0x38000000;
+    return sign|static_cast<std::uint16_t>((x+0x0fff+((x>>13)&1))>>13);
+  }
+
+  class reader
+  {
+  public:
+    explicit reader(const std::string& data_):
+      data(data_),
+      pos(0)
+    {
+    }
+
+    template<typename T>
+    T get()
+    {
+      if(pos+sizeof(T)>data.size())
+        throw std::runtime_error("Unexpected end of a PDF block");
+      unsigned char bytes[sizeof(T)];
+      for(std::size_t i=0;i<sizeof(T);++i)
+        bytes[i]=data[pos+i];
+      pos+=sizeof(T);
+      std::uint32_t u=0;
+      for(std::size_t i=0;i<sizeof(T);++i)
+        u|=static_cast<std::uint32_t>(bytes[i])<<(8*i);
+      T result;
+      std::memcpy(&result,&u,sizeof(result));
+      return result;
+    }
+
+    bool done() const
+    {
+      return (pos==data.size());
+    }
+
+  private:
+    const std::string& data;
+    std::size_t pos;
+  };
+
+  class writer
+  {
+  public:
+    template<typename T>
+    void put(T value)
+    {
+      std::uint32_t u=0;
+      std::memcpy(&u,&value,sizeof(value));
+      for(std::size_t i=0;i<sizeof(T);++i)
+        data.push_back(static_cast<char>((u>>(8*i))&0xff));
+    }
+
+    const std::string& get_data() const
+    {
+      return data;
+    }
+
+  private:
+    std::string data;
+  };
+
+  struct stream_info
+  {
+    std::size_t vector_length{0};
+    std::size_t num_windows{0};
+    bool is_msd{false};
+  };
+
+  struct pdf_block
+  {
+    std::vector<std::uint32_t> npdf;
+    // One row of means, variances and the optional MSD weight per PDF
+    std::vector<std::vector<float> > rows;
+  };
+
+  pdf_block read_pdfs(const std::string& data,const stream_info& info,std::size_t num_states)
+  {
+    std::size_t len=2*info.vector_length*info.num_windows+(info.is_msd?1:0);
+    // There is one tree per state, unless the voice has a single tree
+    for(std::size_t ntree=num_states;ntree>0;--ntree)
+      {
+        if(data.size()<4*ntree)
+          continue;
+        reader r(data);
+        pdf_block result;
+        std::size_t total=0;
+        for(std::size_t i=0;i<ntree;++i)
+          {
+            result.npdf.push_back(r.get<std::uint32_t>());
+            total+=result.npdf.back();
+          }
+        if(data.size()!=4*ntree+4*len*total)
+          continue;
+        result.rows.assign(total,std::vector<float>(len));
+        for(std::size_t i=0;i<total;++i)
+          for(std::size_t j=0;j<len;++j)
+            result.rows[i][j]=r.get<float>();
+        return result;
+      }
+    throw std::runtime_error("The size of a PDF block does not match the stream");
+  }
+
+  // One-dimensional Lloyd-Max quantizer for values in [0,1]
+  std::vector<float> train_codebook(std::vector<float> values)
+  {
+    std::vector<float> levels(codebook_size);
+    for(std::size_t i=0;i<codebook_size;++i)
+      levels[i]=(i+0.5f)/codebook_size;
+    std::sort(values.begin(),values.end());
+    for(unsigned int iter=0;iter<30;++iter)
+      {
+        std::vector<double> sums(codebook_size,0);
+        std::vector<std::size_t> counts(codebook_size,0);
+        std::size_t k=0;
+        for(std::size_t i=0;i<values.size();++i)
+          {
+            while((k+1<codebook_size)&&(values[i]>0.5f*(levels[k]+levels[k+1])))
+              ++k;
+            sums[k]+=values[i];
+            ++counts[k];
+          }
+        for(std::size_t i=0;i<codebook_size;++i)
+          if(counts[i]!=0)
+            levels[i]=sums[i]/counts[i];
+        std::sort(levels.begin(),levels.end());
+      }
+    return levels;
+  }
+
+  unsigned char encode(const std::vector<float>& levels,float x)
+  {
+    std::vector<float>::const_iterator it=std::lower_bound(levels.begin(),levels.end(),x);
+    if(it==levels.end())
+      return codebook_size-1;
+    if((it!=levels.begin())&&((x-*(it-1))<(*it-x)))
+      --it;
+    return static_cast<unsigned char>(it-levels.begin());
+  }
+
+  std::string pack_pdfs(const std::string& data,const stream_info& info,std::size_t num_states,bool coded_variances)
+  {
+    pdf_block block=read_pdfs(data,info,num_states);
+    std::size_t len=info.vector_length*info.num_windows;
+    // Shift and scale every dimension, so that the half precision
+    // values stay well inside the normal range
+    std::vector<float> offset(2*len,0),scale(2*len,1);
+    for(std::size_t j=0;j<2*len;++j)
+      {
+        bool log_domain=coded_variances&&(j>=len);
+        float lo=0,hi=0;
+        for(std::size_t i=0;i<block.rows.size();++i)
+          {
+            float v=log_domain?std::log(std::max(block.rows[i][j],1e-30f)):block.rows[i][j];
+            if((i==0)||(v<lo))
+              lo=v;
+            if((i==0)||(v>hi))
+              hi=v;
+          }
+        if(log_domain)
+          {
+            offset[j]=lo;
+            if(hi>lo)
+              scale[j]=hi-lo;
+          }
+        else
+          {
+            offset[j]=(j<len)?(0.5f*(lo+hi)):0;
+            float range=std::max(std::fabs(hi-offset[j]),std::fabs(lo-offset[j]));
+            if(range>0)
+              scale[j]=range/32768.0f;
+          }
+      }
+    std::vector<float> levels;
+    if(coded_variances)
+      {
+        std::vector<float> values;
+        values.reserve(block.rows.size()*len);
+        for(std::size_t i=0;i<block.rows.size();++i)
+          for(std::size_t j=len;j<2*len;++j)
+            values.push_back((std::log(std::max(block.rows[i][j],1e-30f))-offset[j])/scale[j]);
+        levels=train_codebook(values);
+      }
+    writer w;
+    for(std::size_t i=0;i<block.npdf.size();++i)
+      w.put(block.npdf[i]);
+    for(std::size_t j=0;j<2*len;++j)
+      w.put(offset[j]);
+    for(std::size_t j=0;j<2*len;++j)
+      w.put(scale[j]);
+    for(std::size_t i=0;i<levels.size();++i)
+      w.put(levels[i]);
+    for(std::size_t i=0;i<block.rows.size();++i)
+      {
+        const std::vector<float>& row=block.rows[i];
+        if(info.is_msd)
+          w.put(row[2*len]);
+        for(std::size_t j=0;j<len;++j)
+          w.put(float_to_half((row[j]-offset[j])/scale[j]));
+        for(std::size_t j=len;j<2*len;++j)
+          {
+            if(coded_variances)
+              w.put(encode(levels,(std::log(std::max(row[j],1e-30f))-offset[j])/scale[j]));
+            else
+              w.put(float_to_half((row[j]-offset[j])/scale[j]));
+          }
+      }
+    return w.get_data();
+  }
+
+  // Returns the text inside the brackets of keys like STREAM_PDF[MCP]
+  std::string get_stream_name(const std::string& key,const std::string& prefix)
+  {
+    if((key.compare(0,prefix.size(),prefix)!=0)||(key[key.size()-1]!=']'))
+      return std::string();
+    return key.substr(prefix.size(),key.size()-prefix.size()-1);
+  }
+
+  void pack_voice(const std::string& in_path,const std::string& out_path,const std::string& format,const std::set<std::string>& selected_streams)
+  {
+    std::ifstream in(in_path.c_str(),std::ios::binary);
+    if(!in.is_open())
+      throw std::runtime_error("Cannot open "+in_path);
+    std::string contents((std::istreambuf_iterator<char>(in)),std::istreambuf_iterator<char>());
+    const std::string data_tag("[DATA]\n");
+    std::size_t data_pos=contents.find(data_tag);
+    if(data_pos==std::string::npos)
+      throw std::runtime_error("No data section in "+in_path);
+    const std::string data(contents.substr(data_pos+data_tag.size()));
+    std::istringstream header(contents.substr(0,data_pos));
+    std::vector<std::string> lines;
+    std::string line;
+    while(std::getline(header,line))
+      lines.push_back(line);
+    std::size_t num_states=0;
+    std::vector<std::string> stream_names;
+    std::map<std::string,stream_info> streams;
+    for(std::size_t i=0;i<lines.size();++i)
+      {
+        std::size_t colon=lines[i].find(':');
+        if(colon==std::string::npos)
+          continue;
+        std::string key(lines[i].substr(0,colon));
+        std::string value(lines[i].substr(colon+1));
+        std::string name;
+        if(key=="NUM_STATES")
+          num_states=std::atoi(value.c_str());
+        else if(key=="STREAM_TYPE")
+          {
+            std::istringstream s(value);
+            while(std::getline(s,name,','))
+              stream_names.push_back(name);
+          }
+        else if(!(name=get_stream_name(key,"VECTOR_LENGTH[")).empty())
+          streams[name].vector_length=std::atoi(value.c_str());
+        else if(!(name=get_stream_name(key,"NUM_WINDOWS[")).empty())
+          streams[name].num_windows=std::atoi(value.c_str());
+        else if(!(name=get_stream_name(key,"IS_MSD[")).empty())
+          streams[name].is_msd=(value=="1");
+        else if(!(name=get_stream_name(key,"PDF_FORMAT[")).empty())
+          throw std::runtime_error("The PDFs of stream "+name+" are already packed");
+      }
+    std::set<std::string> packed_streams;
+    for(std::size_t i=0;i<stream_names.size();++i)
+      if(selected_streams.empty()||selected_streams.count(stream_names[i]))
+        packed_streams.insert(stream_names[i]);
+    // Rebuild the data section block by block, updating the positions
+    std::string new_data;
+    std::vector<std::string> new_lines;
+    bool in_positions=false;
+    for(std::size_t i=0;i<lines.size();++i)
+      {
+        if(lines[i]=="[POSITION]")
+          {
+            for(std::set<std::string>::const_iterator it=packed_streams.begin();it!=packed_streams.end();++it)
+              new_lines.push_back("PDF_FORMAT["+*it+"]:"+format);
+            in_positions=true;
+            new_lines.push_back(lines[i]);
+            continue;
+          }
+        std::size_t colon=lines[i].find(':');
+        if(!in_positions||(colon==std::string::npos))
+          {
+            new_lines.push_back(lines[i]);
+            continue;
+          }
+        std::string key(lines[i].substr(0,colon));
+        std::string name(get_stream_name(key,"STREAM_PDF["));
+        std::ostringstream new_line;
+        new_line << key << ":";
+        std::istringstream ranges(lines[i].substr(colon+1));
+        std::string range;
+        for(bool first=true;std::getline(ranges,range,',');first=false)
+          {
+            std::size_t dash=range.find('-');
+            if(dash==std::string::npos)
+              throw std::runtime_error("Invalid position: "+lines[i]);
+            std::size_t start=std::atol(range.substr(0,dash).c_str());
+            std::size_t end=std::atol(range.substr(dash+1).c_str());
+            if((end<start)||(end>=data.size()))
+              throw std::runtime_error("Invalid position: "+lines[i]);
+            std::string block(data.substr(start,end-start+1));
+            if(packed_streams.count(name))
+              block=pack_pdfs(block,streams[name],num_states,format=="FP16_U8");
+            if(!first)
+              new_line << ",";
+            new_line << new_data.size() << "-" << (new_data.size()+block.size()-1);
+            new_data+=block;
+          }
+        new_lines.push_back(new_line.str());
+      }
+    std::ofstream out(out_path.c_str(),std::ios::binary);
+    if(!out.is_open())
+      throw std::runtime_error("Cannot create "+out_path);
+    for(std::size_t i=0;i<new_lines.size();++i)
+      out << new_lines[i] << "\n";
+    out << data_tag;
+    out.write(new_data.data(),new_data.size());
+    if(!out)
+      throw std::runtime_error("Cannot write "+out_path);
+    std::cout << "Packed " << packed_streams.size() << " streams: " << contents.size() << " -> " << (out.tellp()) << " bytes" << std::endl;
+  }
+}
+
+#ifdef WITH_CLI11
+	typedef CLI::App AppT;
+	#define GET_CLI_PARAM_VALUE(NAME) (NAME ## Stor)
+#else
+	typedef TCLAP::CmdLine AppT;
+	#define GET_CLI_PARAM_VALUE(NAME) (NAME).getValue()
+#endif
+
+int main(int argc,const char* argv[])
+{
+  try
+    {
+      AppT cmd("Store the PDFs of an HTS voice with reduced precision");
+
+#ifdef WITH_CLI11
+      std::string model_argStor;
+      cmd.add_option("model",model_argStor,"the directory containing voice.data")->required();
+      std::string output_argStor;
+      cmd.add_option("output",output_argStor,"the packed voice file")->required();
+      std::string format_argStor {"FP16"};
+      cmd.add_option("-f,--format",format_argStor,"FP16 or FP16_U8 (8-bit log variances)")->check(CLI::IsMember({"FP16","FP16_U8"}));
+      std::vector<std::string> streams_argStor;
+      cmd.add_option("-s,--stream",streams_argStor,"a stream to pack, all streams by default");
+#else
+      TCLAP::UnlabeledValueArg<std::string> model_arg("model","the directory containing voice.data",true,"","path",cmd);
+      TCLAP::UnlabeledValueArg<std::string> output_arg("output","the packed voice file",true,"","path",cmd);
+      std::vector<std::string> formats;
+      formats.push_back("FP16");
+      formats.push_back("FP16_U8");
+      TCLAP::ValuesConstraint<std::string> format_constraint(formats);
+      TCLAP::ValueArg<std::string> format_arg("f","format","FP16 or FP16_U8 (8-bit log variances)",false,"FP16",&format_constraint,cmd);
+      TCLAP::MultiArg<std::string> streams_arg("s","stream","a stream to pack, all streams by default",false,"name",cmd);
+#endif
+
+#ifdef WITH_CLI11
+     try{
+#endif
+      cmd.parse(argc,argv);
+#ifdef WITH_CLI11
+      }catch (const CLI::ParseError &e) {
+        return cmd.exit(e);
+      }
+#endif
+
+      const std::vector<std::string>& stream_names=GET_CLI_PARAM_VALUE(streams_arg);
+      std::set<std::string> streams(stream_names.begin(),stream_names.end());
+      pack_voice(path::join(GET_CLI_PARAM_VALUE(model_arg),"voice.data"),GET_CLI_PARAM_VALUE(output_arg),GET_CLI_PARAM_VALUE(format_arg),streams);
+      return 0;
+    }
+  catch(const std::exception& e)
+    {
+      std::cerr << e.what() << std::endl;
+      return -1;
+    }
+}